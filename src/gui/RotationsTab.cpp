@@ -1,12 +1,29 @@
 #include "RotationsTab.h"
 #include "rotations/RotationEngine.h"
+#include "spells/cooldowns.h"
+#include "spells/loscache.h"
+#include "spells/lostrace.h"
+#include "spells/losscheduler.h"
+#include "spells/motiontracker.h"
+#include "rotations/RotationCompiler.h"
+#include "rotations/ConditionCost.h"
+#include "rotations/RotationWorker.h"
+#include "rotations/ProfileLoader.h"
+#include "rotations/ProfileWatcher.h"
+#include "rotations/DecisionTrace.h"
 #include "logs/log.h"
 #include <imgui.h>
 #include "gui.h"
+#include <chrono>
 #include <vector>
 #include <string>
 #include <windows.h>
 
+// Defined in hook.cpp
+extern Spells::CooldownManager* cooldownManagerInstance;
+extern ::Rotation::RotationWorker* rotationWorkerInstance;
+extern ::Rotation::ProfileWatcher* profileWatcherInstance;
+
 namespace GUI {
 
 RotationsTab::RotationsTab(::Rotation::RotationEngine& engine, std::atomic_bool& unload_flag)
@@ -22,7 +39,7 @@ RotationsTab::RotationsTab(::Rotation::RotationEngine& engine, std::atomic_bool&
     singleTargetModeCheckbox = rotationEngine.IsSingleTargetModeEnabled();
 
     // Attempt to set the dropdown to the last selected rotation
-    const auto& availableNames = rotationEngine.GetAvailableRotationNames();
+    const auto availableNames = ::Rotation::ProfileLoader::GetInstance().GetProfileNames();
     std::string lastSelectedName = rotationEngine.GetCurrentRotationName();
 
     if (!lastSelectedName.empty() && !availableNames.empty()) {
@@ -124,12 +141,68 @@ std::string RotationsTab::GetKeyName(int vkCode) const {
     return "Key " + std::to_string(vkCode);
 }
 
+void RotationsTab::RenderDecisionTrace() {
+    if (!ImGui::CollapsingHeader("Decision Trace")) return;
+
+    ::Rotation::DecisionTrace& trace = ::Rotation::DecisionTrace::GetInstance();
+#if ROTATION_TRACE
+    bool traceEnabled = trace.IsEnabled();
+    if (ImGui::Checkbox("Record Ticks", &traceEnabled)) {
+        trace.SetEnabled(traceEnabled);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Record every rotation evaluation: steps tried, condition results, chosen spell and timings.\nKeeps the last %zu ticks.", ::Rotation::DecisionTrace::CAPACITY);
+    }
+#else
+    ImGui::TextDisabled("Tracing was compiled out (ROTATION_TRACE=0).");
+#endif
+    std::shared_ptr<const ::Rotation::RotationProgram> program = rotationWorkerInstance ? rotationWorkerInstance->GetProgram() : nullptr;
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Dump to File")) {
+        trace.DumpToFile(trace.GetDumpPath(), program.get());
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Clear##Trace")) {
+        trace.Clear();
+    }
+    ImGui::SliderInt("Ticks Shown", &traceTicksShown, 1, 32);
+    ImGui::Text("Recorded: %llu", trace.GetRecordedCount());
+
+    trace.CopyRecent(traceTicks, static_cast<size_t>(traceTicksShown));
+    for (const auto& tick : traceTicks) {
+        char label[160];
+        snprintf(label, sizeof(label), "#%llu %s -> %s (step %d, spell %u) %.1f us%s##tick%llu",
+                 tick.sequence, tick.profileName, tick.chosenStep >= 0 ? "cast" : "nothing", tick.chosenStep, tick.spellId,
+                 static_cast<double>(tick.totalNs) / 1000.0, tick.truncated ? " [truncated]" : "", tick.sequence);
+        if (!ImGui::TreeNode(label)) continue;
+        for (uint16_t s = 0; s < tick.stepCount; ++s) {
+            const ::Rotation::TraceStep& step = tick.steps[s];
+            ImVec4 color = step.passed ? ImVec4(0.4f, 1.0f, 0.4f, 1.0f) : ImVec4(1.0f, 0.5f, 0.5f, 1.0f);
+            if (tick.stepTiming) {
+                ImGui::TextColored(color, "Step %u: spell %u on 0x%llX %s (%.0f ns)", step.stepIndex, step.spellId, step.targetGuid,
+                                   step.passed ? "PASS" : "FAIL", trace.TicksToNs(step.ticks));
+            } else {
+                ImGui::TextColored(color, "Step %u: spell %u on 0x%llX %s", step.stepIndex, step.spellId, step.targetGuid,
+                                   step.passed ? "PASS" : "FAIL");
+            }
+            if (program && ::Rotation::DecisionTrace::DecodeStep(*program, tick, s, traceConditions)) {
+                for (const auto& condition : traceConditions) {
+                    ImGui::Text("    %s%s: %s", ::Rotation::OpCodeName(static_cast<::Rotation::OpCode>(condition.op)),
+                                condition.memoized ? " (memo)" : "", condition.passed ? "pass" : "fail");
+                }
+            }
+        }
+        ImGui::TreePop();
+    }
+}
+
 void RotationsTab::Render() {
     // Use full width for this pane now
     ImGui::BeginChild("RotationTopPane", ImVec2(0, 0), true); 
 
     ImGui::Text("Rotation Selection:");
-    const auto& rotationNames = rotationEngine.GetAvailableRotationNames();
+    // Profiles come from ProfileLoader (parallel load + sidecar cache, kept current by ProfileWatcher)
+    const auto rotationNames = ::Rotation::ProfileLoader::GetInstance().GetProfileNames();
     std::vector<const char*> rotationNameCstrs;
     for (const std::string& name : rotationNames) {
         rotationNameCstrs.push_back(name.c_str());
@@ -156,7 +229,16 @@ void RotationsTab::Render() {
     }
     ImGui::SameLine();
     if (ImGui::Button("Reload All Rotations")) {
+        ::Rotation::ProfileLoader& loader = ::Rotation::ProfileLoader::GetInstance();
+        // The engine keeps its own parsed copy for selection/Start; both passes show up in the load report
+        auto engineLoadStart = std::chrono::steady_clock::now();
         rotationEngine.ReloadRotationsFromDisk();
+        loader.RecordEngineLoad(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - engineLoadStart).count());
+        loader.ReloadDirectory();
+        // Recompile the running profile from the fresh copy
+        auto running = rotationWorkerInstance ? rotationWorkerInstance->GetProgram() : nullptr;
+        auto reloaded = running ? loader.FindProfile(running->profileName) : nullptr;
+        if (reloaded) rotationWorkerInstance->InstallProfile(*reloaded);
     }
     ImGui::SameLine();
     ImGui::Text(rotationEngine.IsRunning() ? "Status: Running" : "Status: Stopped");
@@ -270,6 +352,227 @@ void RotationsTab::Render() {
         ImGui::EndTooltip();
     }
 
+    // Cooldown table statistics
+    if (cooldownManagerInstance) {
+        ImGui::Separator();
+        ImGui::Text("Cooldown Cache:");
+        Spells::CooldownManager::CacheStats cdStats = cooldownManagerInstance->GetCacheStats();
+        uint64_t cdQueries = cdStats.hits + cdStats.misses;
+        float cdHitRate = cdQueries > 0 ? (100.0f * static_cast<float>(cdStats.hits) / static_cast<float>(cdQueries)) : 0.0f;
+        ImGui::Text("Tracked Spells: %zu | Hits: %llu | Misses: %llu (%.1f%% hit)",
+                    cdStats.trackedSpells, cdStats.hits, cdStats.misses, cdHitRate);
+        ImGui::Text("Evaluations: %llu run / %llu skipped | Pending Spells: %zu",
+                    cdStats.evaluationsRun, cdStats.evaluationsSkipped, cdStats.pendingSpells);
+        ImGui::Text("Client Calls: %llu over %llu frames", cdStats.clientCalls, cdStats.frame);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##CooldownStats")) {
+            cooldownManagerInstance->ResetCacheStats();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Rotation cooldown queries are answered from a table refreshed once per frame.\nMisses are spells not yet tracked; they are tracked from then on.");
+        }
+
+        uint64_t castsOk = 0, castsFailed = 0;
+        cooldownManagerInstance->GetCastCounters(castsOk, castsFailed);
+        ImGui::Text("Learned GCD: %d ms | Haste Factor: %.3f | Casts: %llu ok / %llu failed",
+                    cooldownManagerInstance->GetGcdMs(), cooldownManagerInstance->GetHasteFactor(), castsOk, castsFailed);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("GCD and cast durations are learned from cast results and the player's casting state.");
+        }
+
+        Spells::LosCache& losCache = Spells::LosCache::GetInstance();
+        Spells::LosCache::Stats losStats = losCache.GetStats();
+        uint64_t losQueries = losStats.hits + losStats.misses;
+        float losHitRate = losQueries > 0 ? (100.0f * static_cast<float>(losStats.hits) / static_cast<float>(losQueries)) : 0.0f;
+        ImGui::Text("LOS Cache: %zu entries | Hits: %llu | Misses: %llu (%.1f%% hit) | Expired: %llu | Moved: %llu | World Traces: %llu",
+                    losStats.entries, losStats.hits, losStats.misses, losHitRate, losStats.expired, losStats.moved, losStats.worldTraces);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##LosStats")) {
+            losCache.ResetStats();
+        }
+        bool losCacheEnabled = losCache.IsEnabled();
+        if (ImGui::Checkbox("Cache Line of Sight", &losCacheEnabled)) {
+            losCache.SetEnabled(losCacheEnabled);
+            if (!losCacheEnabled) losCache.Clear();
+        }
+        ImGui::SameLine();
+        int losTtl = losCache.GetTtlMs();
+        ImGui::SetNextItemWidth(150.0f);
+        if (ImGui::SliderInt("TTL (ms)##LosCache", &losTtl, 0, Spells::LosCache::MAX_TTL_MS)) {
+            losCache.SetTtlMs(losTtl);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("A line of sight result is reused for this long while neither unit moves more than half a yard.\nEach uncached check costs up to 14 world traces.");
+        }
+
+        Spells::LosTraceStrategy& losStrategy = Spells::LosTraceStrategy::GetInstance();
+        Spells::LosTraceStrategy::Stats traceStats = losStrategy.GetStats();
+        auto tracesPerCheck = [](const Spells::LosTraceStrategy::PolicyStats& policyStats) {
+            return policyStats.checks > 0 ? static_cast<double>(policyStats.traces) / static_cast<double>(policyStats.checks) : 0.0;
+        };
+        ImGui::Text("LOS Traces/Check: Full %.2f (%llu checks, %llu early) | Fast %.2f (%llu checks, %llu early)",
+                    tracesPerCheck(traceStats.full), traceStats.full.checks, traceStats.full.earlyExits,
+                    tracesPerCheck(traceStats.fast), traceStats.fast.checks, traceStats.fast.earlyExits);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##LosTraceStats")) {
+            losStrategy.ResetStats();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::Text("Trace order (slot: agreement with verdict)");
+            for (int k = 0; k < Spells::LosTraceStrategy::TRACE_COUNT; ++k) {
+                int slot = traceStats.order[k];
+                const Spells::LosTraceStrategy::Trace& trace = Spells::LosTraceStrategy::GetTrace(slot);
+                ImGui::Text("%2d. +%.1fyd %3.0f%% of ray, flags 0x%X: %.1f%%", k + 1, trace.heightOffset, trace.fraction * 100.0f,
+                            trace.flags, traceStats.agreement[slot] * 100.0f);
+            }
+            ImGui::EndTooltip();
+        }
+        bool losEarlyExit = losStrategy.IsEarlyExitEnabled();
+        if (ImGui::Checkbox("LOS Early Exit", &losEarlyExit)) {
+            losStrategy.SetEarlyExitEnabled(losEarlyExit);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Stop tracing as soon as the remaining traces cannot change the verdict.");
+        }
+        ImGui::SameLine();
+        bool losAdaptive = losStrategy.IsAdaptiveOrderEnabled();
+        if (ImGui::Checkbox("Adaptive Trace Order", &losAdaptive)) {
+            losStrategy.SetAdaptiveOrderEnabled(losAdaptive);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Fire the traces that most often agree with the verdict first (eye height until there is history).");
+        }
+        ImGui::SameLine();
+        int fastBudget = losStrategy.GetFastBudget();
+        ImGui::SetNextItemWidth(120.0f);
+        if (ImGui::SliderInt("Fast Budget##LosTrace", &fastBudget, 1, Spells::LosTraceStrategy::TRACE_COUNT)) {
+            losStrategy.SetFastBudget(fastBudget);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Traces a fast check (candidate filtering) may fire. The target that is cast on always gets the full check.");
+        }
+
+        Spells::LosScheduler& losScheduler = Spells::LosScheduler::GetInstance();
+        Spells::LosScheduler::Stats schedStats = losScheduler.GetStats();
+        ImGui::Text("LOS Queue: %zu pending | Run: %llu (%llu merged, %llu dropped) | Stale: %llu | Unknown: %llu",
+                    schedStats.pending, schedStats.executed, schedStats.merged, schedStats.dropped,
+                    schedStats.staleAnswers, schedStats.unknown);
+        ImGui::Text("LOS Frame: %.0f us last / %.0f us max | Latency: %.1f ms avg",
+                    schedStats.lastFrameUs, schedStats.maxFrameUs, schedStats.avgLatencyMs);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##LosQueueStats")) {
+            losScheduler.ResetStats();
+        }
+        bool losDeferred = losScheduler.IsEnabled();
+        if (ImGui::Checkbox("Spread LOS Over Frames", &losDeferred)) {
+            losScheduler.SetEnabled(losDeferred);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Candidate line of sight checks are queued and run in EndScene within the budget below,\nusing the last known answer meanwhile. Off: every check traces immediately.");
+        }
+        ImGui::SameLine();
+        int losBudget = losScheduler.GetFrameBudgetUs();
+        ImGui::SetNextItemWidth(150.0f);
+        if (ImGui::SliderInt("Budget (us)##LosQueue", &losBudget, Spells::LosScheduler::MIN_FRAME_BUDGET_US, Spells::LosScheduler::MAX_FRAME_BUDGET_US)) {
+            losScheduler.SetFrameBudgetUs(losBudget);
+        }
+
+        Spells::MotionTracker& motionTracker = Spells::MotionTracker::GetInstance();
+        Spells::MotionTracker::Stats motionStats = motionTracker.GetStats();
+        ImGui::Text("Motion: %zu units tracked | Samples: %llu | Predictions: %llu (%llu moving)",
+                    motionStats.tracked, motionStats.samples, motionStats.predictions, motionStats.moving);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##MotionStats")) {
+            motionTracker.ResetStats();
+        }
+        bool predictMotion = motionTracker.IsEnabled();
+        if (ImGui::Checkbox("Predict Unit Motion", &predictMotion)) {
+            motionTracker.SetEnabled(predictMotion);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Range, cone and line of sight checks use where moving units are now (or at cast time),\nextrapolated from their velocity over the last object updates, instead of the last cached position.");
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Rotation VM:");
+        ::Rotation::RotationVM::Stats vmStats = ::Rotation::RotationVM::GetStats();
+        uint64_t memoQueries = vmStats.memoHits + vmStats.memoMisses;
+        float memoHitRate = memoQueries > 0 ? (100.0f * static_cast<float>(vmStats.memoHits) / static_cast<float>(memoQueries)) : 0.0f;
+        double avgUs = vmStats.decisions > 0 ? (static_cast<double>(vmStats.totalNs) / 1000.0 / static_cast<double>(vmStats.decisions)) : 0.0;
+        ImGui::Text("Decisions: %llu (%.2f us avg) | Instructions: %llu", vmStats.decisions, avgUs, vmStats.instructions);
+        ImGui::Text("Condition Memo: %llu hits / %llu misses (%.1f%% hit)", vmStats.memoHits, vmStats.memoMisses, memoHitRate);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##VMStats")) {
+            ::Rotation::RotationVM::ResetStats();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Checks shared by several steps are computed once per evaluation pass and reused.");
+        }
+        ImGui::Text("Condition Cost Samples: %llu", ::Rotation::ConditionCostModel::GetInstance().GetSampleCount());
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Sampled condition timings and failure rates.\nConditions are ordered cheapest and most likely to fail first when a profile is compiled.");
+        }
+
+        if (rotationWorkerInstance) {
+            ::Rotation::RotationWorker::Stats workerStats = rotationWorkerInstance->GetStats();
+            double workerAvgUs = workerStats.decisions > 0 ? (static_cast<double>(workerStats.decisionNs) / 1000.0 / static_cast<double>(workerStats.decisions)) : 0.0;
+            ImGui::Text("Worker: %s | Snapshots: %llu | Decisions: %llu (%.2f us avg) | Taken: %llu | Idle: %llu",
+                        rotationWorkerInstance->GetProgram() ? "Active" : "Idle",
+                        workerStats.snapshotsPublished, workerStats.decisions, workerAvgUs,
+                        workerStats.decisionsTaken, workerStats.idleWakeups);
+            bool lookahead = rotationWorkerInstance->IsLookaheadEnabled();
+            if (ImGui::Checkbox("Lookahead Pre-Queue", &lookahead)) {
+                rotationWorkerInstance->SetLookaheadEnabled(lookahead);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("During the GCD or a cast, decide the next spell on the predicted state at its end\nand cast it on the first frame the spell is usable.");
+            }
+            ImGui::SameLine();
+            bool multiTarget = rotationWorkerInstance->IsMultiTargetEnabled();
+            if (ImGui::Checkbox("Multi-Target", &multiTarget)) {
+                rotationWorkerInstance->SetMultiTargetEnabled(multiTarget);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Evaluate enemy steps against every hostile unit nearby (e.g. spread DoTs)\ninstead of only the current target. The spell is cast on the unit it passed on.");
+            }
+            ImGui::Text("Speculative: %llu | Confirmed: %llu | Re-decided: %llu | Condition re-sorts: %llu",
+                        workerStats.speculative, workerStats.speculationConfirmed, workerStats.speculationRedecided,
+                        workerStats.conditionReorders);
+            int decisionHz = rotationWorkerInstance->GetDecisionRate();
+            if (ImGui::SliderInt("Decision Rate (Hz)", &decisionHz, ::Rotation::RotationWorker::MIN_DECISION_HZ, ::Rotation::RotationWorker::MAX_DECISION_HZ)) {
+                rotationWorkerInstance->SetDecisionRate(decisionHz);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Rotation decisions run on a worker thread at this rate, independent of FPS.\nThe render thread only builds the snapshot, validates the decision and casts.");
+            }
+        }
+
+        ::Rotation::ProfileLoadReport loadReport = ::Rotation::ProfileLoader::GetInstance().GetLastReport();
+        ImGui::Text("Profiles: %zu (%zu cached, %zu parsed, %zu failed) in %.1f ms on %u thread(s) + engine %.1f ms | Ready %.1f ms after injection",
+                    loadReport.files, loadReport.cacheHits, loadReport.parsed, loadReport.failed,
+                    loadReport.totalMs, loadReport.threads, loadReport.engineLoadMs, loadReport.timeToReadyMs);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Profiles are loaded in parallel at injection.\nUnchanged profiles are restored from the binary cache in rotations/.cache instead of parsing JSON.\nThe rotation engine still parses its own copy (engine time).");
+        }
+
+        if (profileWatcherInstance) {
+            bool hotReload = profileWatcherInstance->IsEnabled();
+            if (ImGui::Checkbox("Hot Reload Profiles", &hotReload)) {
+                profileWatcherInstance->SetEnabled(hotReload);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Watch the rotations folder and reload profiles saved in RotationCreator.\nOnly changed files are re-parsed; the running rotation switches to the new version without pausing.");
+            }
+            ::Rotation::ProfileWatcher::Stats watchStats = profileWatcherInstance->GetStats();
+            ImGui::SameLine();
+            ImGui::Text("Reloads: %llu (%llu failed, %llu swapped) | Last: %.2f ms",
+                        watchStats.reloads, watchStats.failures, watchStats.programSwaps, watchStats.lastReloadMs);
+        }
+
+        RenderDecisionTrace();
+    }
+
     ImGui::EndChild(); // End of RotationTopPane
 
     // These buttons were below the debug pane, keep them outside the child?
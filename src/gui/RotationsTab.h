@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../rotations/RotationEngine.h"
+#include "../rotations/DecisionTrace.h"
 #include <string>
+#include <vector>
 #include <atomic> // For std::atomic_bool
 
 namespace GUI {
@@ -28,11 +30,13 @@ public:
     std::string GetKeyName(int vkCode) const;
 
 private:
+    void RenderDecisionTrace(); // Decision trace panel (last N rotation ticks)
+
     ::Rotation::RotationEngine& rotationEngine;
     std::atomic_bool& unloadSignal; // Reference to the unload signal flag from main UI
 
     // GUI state
-    int selectedRotationIndex = -1; // Index in the GetAvailableRotationNames vector
+    int selectedRotationIndex = -1; // Index in ProfileLoader::GetProfileNames()
     bool targetingEnabledCheckbox = true; // Mirror engine state
     
     // Name-based targeting state
@@ -48,6 +52,11 @@ private:
     bool onlyCastIfPlayerInCombatCheckbox = false; // Added for player in combat check
     bool autoReEnableCheckbox = true; // NEW: For auto re-enable toggle
     bool singleTargetModeCheckbox = false; // Checkbox for the new mode
+
+    // Decision trace panel; buffers reused between frames
+    int traceTicksShown = 8;
+    std::vector<::Rotation::TraceTick> traceTicks;
+    std::vector<::Rotation::TraceCondition> traceConditions;
 };
 
 } 
\ No newline at end of file
@@ -7,9 +7,18 @@
 #include "gui/gui.h"
 #include "objectManager/ObjectManager.h"
 #include "spells/cooldowns.h"
+#include "spells/spellinfo.h"
 #include "spells/castspell.h"
 #include "spells/targeting.h" // Added for Spells::IntersectFlagsToString
+#include "spells/loscache.h"
+#include "spells/losscheduler.h"
+#include "spells/motiontracker.h"
 #include "rotations/RotationEngine.h"
+#include "rotations/RotationWorker.h"
+#include "rotations/SnapshotBuilder.h"
+#include "rotations/ProfileLoader.h"
+#include "rotations/ProfileWatcher.h"
+#include "rotations/DecisionTrace.h"
 #include "gui/RotationsTab.h"
 #include "fishing/FishingBot.h"    // For FishingBot
 #include "game_state/GameStateManager.h" // ++ ADDED INCLUDE ++
@@ -43,6 +52,8 @@
 ObjectManager* objectManagerInstance = nullptr;
 Spells::CooldownManager* cooldownManagerInstance = nullptr;
 Rotation::RotationEngine* rotationEngineInstance = nullptr;
+Rotation::RotationWorker* rotationWorkerInstance = nullptr;
+Rotation::ProfileWatcher* profileWatcherInstance = nullptr;
 GUI::RotationsTab* g_rotationsTab = nullptr;
 std::atomic<bool> g_shutdownRequested{false}; // Ensure this is declared for RotationsTab
 std::atomic<bool> g_isShuttingDown{false};
@@ -165,6 +176,71 @@ LRESULT APIENTRY WndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
 }
 // --- End WndProc ---
 
+// --- Line of sight for worker decisions ---
+// The worker's snapshot has no line of sight, and multi-target decisions can pick a unit other than the
+// current target. Answered by LosScheduler from LosCache or the last known result (Full policy: this unit is
+// cast on); a pair without an answer is traced by the next frame's RunFrame.
+// @return false if there is no answer yet
+static bool QueryDecisionLos(ObjectManager* objMgr, const Rotation::RotationDecision& decision, bool& outHasLos) {
+    outHasLos = true;
+    if (!decision.requiresTarget || decision.targetGuid == 0 || decision.hasGroundPosition) return true;
+    auto player = objMgr->GetLocalPlayer();
+    auto target = std::dynamic_pointer_cast<WowUnit>(objMgr->GetObjectByGUID(decision.targetGuid));
+    if (!player || !target || player->GetGUID64() == decision.targetGuid) return true;
+    Vector3 start = player->GetPosition();
+    Vector3 end = target->GetPosition();
+    if (start.IsZero() || end.IsZero()) return true;
+    return Spells::LosScheduler::GetInstance().Query(player->GetGUID64(), decision.targetGuid, start, end,
+                                                     Spells::LosPolicy::Full, outHasLos);
+}
+
+// --- Rotation worker program ---
+// The worker runs the engine's selected profile (compiled from ProfileLoader's copy) while the engine is running,
+// and nothing while it is stopped. Checked every frame, so the GUI/hotkey start and stop, profile selection,
+// auto-start after a loading screen and the engine stopping itself are all covered in one place.
+static void SyncWorkerProgram() {
+    if (!rotationWorkerInstance) return;
+    static std::string s_attempted;                           // Profile we last tried to install ("" = cleared)
+    static std::chrono::steady_clock::time_point s_attemptedAt;
+    constexpr std::chrono::seconds RETRY_MISSING_PROFILE = std::chrono::seconds(1);
+
+    bool engineRunning = rotationEngineInstance && rotationEngineInstance->IsRunning();
+    std::string wanted = engineRunning ? rotationEngineInstance->GetCurrentRotationName() : std::string();
+    auto program = rotationWorkerInstance->GetProgram();
+    std::string installed = program ? program->profileName : std::string();
+    if (wanted == installed) {
+        s_attempted = wanted;
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (wanted == s_attempted && now - s_attemptedAt < RETRY_MISSING_PROFILE) return; // Not loaded (yet)
+    s_attempted = wanted;
+    s_attemptedAt = now;
+
+    if (wanted.empty()) {
+        rotationWorkerInstance->SetProgram(nullptr);
+        Core::Log::Message("[HookedEndScene] Rotation stopped. Worker program cleared.");
+        return;
+    }
+    auto profile = Rotation::ProfileLoader::GetInstance().FindProfile(wanted);
+    if (!profile) {
+        rotationWorkerInstance->SetProgram(nullptr);
+        Core::Log::Message("[HookedEndScene] Profile '" + wanted + "' is not loaded. Worker stays idle.");
+        return;
+    }
+    // Client spell data over the JSON step fields. Without Spell.dbc it comes from the client DB, which can only
+    // be read here on the main thread; later loads of the file (watcher, Reload All) reuse the resolved spells.
+    Rotation::RotationProfile resolved = *profile;
+    size_t updatedSteps = Spells::SpellInfoCache::GetInstance().ApplyToProfile(resolved);
+    auto installedProgram = rotationWorkerInstance->InstallProfile(resolved);
+    // The engine skips its evaluation from here on; a spell it queued before the handoff is not cast
+    if (rotationEngineInstance && rotationEngineInstance->HasQueuedSpell()) rotationEngineInstance->ConsumeQueuedSpell();
+    Core::Log::Message("[HookedEndScene] Worker running '" + wanted + "' (" + std::to_string(installedProgram->steps.size()) +
+                       " steps, " + std::to_string(installedProgram->referencedSpells.size()) + " tracked spells, " +
+                       std::to_string(updatedSteps) + " steps from client spell data).");
+}
+
 // --- HookedEndScene (No Force Reset Implementation) ---
 HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
     if (!imguiInitialized) {
@@ -255,6 +331,7 @@ HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
     
     // --- Core Systems Update Logic ---
     ObjectManager* objMgr = ObjectManager::GetInstance();
+    std::shared_ptr<Rotation::WorldSnapshot> frameSnapshot; // Built below when the rotation worker has a program
     if (objMgr) {
         bool isOmActuallyInitialized = objMgr->IsInitialized(); // Check actual OM init status
 
@@ -291,6 +368,9 @@ HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
                 Core::Log::Message("[HookedEndScene_Transition] Stopping RotationEngine due to JustLeftWorld.");
                 rotationEngineInstance->Stop(); // Stop rotation engine too
             }
+            Spells::LosCache::GetInstance().Clear(); // Cached LOS results belong to the old map
+            Spells::LosScheduler::GetInstance().Clear();
+            Spells::MotionTracker::GetInstance().Clear(); // Positions before and after the loading screen aren't a path
             // objMgr->ResetState(); // Optionally reset OM state here too
         }
 
@@ -357,6 +437,30 @@ HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
         if (isOmActuallyInitialized && g_isObjectManagerActive) {
             objMgr->Update();
             objMgr->RefreshLocalPlayerCache();
+            objMgr->ClassifyUnits(); // Once per enumeration; reaction calls stay on the main thread
+
+            // Refresh the per-frame cooldown table once, so every rotation query this frame is served from it
+            if (cooldownManagerInstance) {
+                cooldownManagerInstance->Update();
+            }
+
+            // Hand the rotation worker a fresh snapshot; it decides on its own thread
+            SyncWorkerProgram();
+            if (rotationWorkerInstance && cooldownManagerInstance && rotationWorkerInstance->IsRunning()) {
+                auto program = rotationWorkerInstance->GetProgram();
+                if (program) {
+                    frameSnapshot = std::make_shared<Rotation::WorldSnapshot>();
+                    if (Rotation::BuildWorldSnapshot(*objMgr, *cooldownManagerInstance, program->referencedSpells, *frameSnapshot,
+                                                     Rotation::SNAPSHOT_NEARBY_RANGE, rotationWorkerInstance->IsMultiTargetEnabled())) {
+                        rotationWorkerInstance->PublishSnapshot(frameSnapshot);
+                    } else {
+                        frameSnapshot.reset();
+                    }
+                }
+            }
+
+            // Line of sight checks queued by targeting, within the frame budget
+            Spells::LosScheduler::GetInstance().RunFrame();
 
             if (fishingBotInstance) { /* fishing bot update if any */ }
         } else {
@@ -423,7 +527,9 @@ HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
     }
     
     // --- Spell Casting from RotationEngine Queue ---
-    if (rotationEngineInstance && rotationEngineInstance->HasQueuedSpell()) {
+    // While the worker runs a compiled program it makes the decisions and the engine skips its evaluation
+    // (RotationWorker::OwnsDecisions), so there is only a queue to cast from when no program is installed
+    if (rotationEngineInstance && !Rotation::RotationWorker::OwnsDecisions() && rotationEngineInstance->HasQueuedSpell()) {
         uint32_t spellIdToCast = rotationEngineInstance->GetQueuedSpellId();
         uint64_t targetGuidForCast = rotationEngineInstance->GetQueuedSpellTargetGuid();
         std::string spellNameToCast = rotationEngineInstance->GetQueuedSpellName();
@@ -438,14 +544,13 @@ HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
         Core::Log::Message(castLogBuffer);
 
         // IMPORTANT: This assumes Spells::CastSpell is correctly linked and available.
-        Spells::CastSpell(spellIdToCast, targetGuidForCast, requiresTargetForCast); // Calling Spells::CastSpell
-                                                                                 // It doesn't directly return bool, but logs internally.
+        bool castSucceeded = Spells::CastSpell(spellIdToCast, targetGuidForCast, requiresTargetForCast);
 
-        Core::Log::Message("[HookedEndScene] Called Spells::CastSpell for: " + spellNameToCast + " (intended)"); // Adjusted log slightly
+        Core::Log::Message("[HookedEndScene] Called Spells::CastSpell for: " + spellNameToCast + (castSucceeded ? " (succeeded)" : " (failed)"));
         
-        // NEW: Record the cast with our CooldownManager to handle GCD and internal tracking
+        // Record the cast result with our CooldownManager - only successful casts start a GCD window
         if (cooldownManagerInstance) {
-            cooldownManagerInstance->RecordSpellCast(spellIdToCast);
+            cooldownManagerInstance->RecordSpellCast(spellIdToCast, castSucceeded);
             // Optional: More verbose logging if needed for debugging this specific call
             // char recordLogBuffer[256];
             // snprintf(recordLogBuffer, sizeof(recordLogBuffer),
@@ -462,6 +567,53 @@ HRESULT APIENTRY HookedEndScene(LPDIRECT3DDEVICE9 pDevice) {
     }
     // --- End Spell Casting from RotationEngine Queue ---
 
+    // --- Spell Casting from RotationWorker decisions (validate, then cast) ---
+    // Speculative decisions (made during the GCD on the predicted post-GCD state) wait in the
+    // worker's pre-queue and come out on the first frame at or after their ready time.
+    Rotation::RotationDecision workerDecision;
+    uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    bool rotationRunning = rotationEngineInstance && rotationEngineInstance->IsRunning();
+    if (rotationWorkerInstance && rotationRunning && g_isObjectManagerActive && !g_isShuttingDown.load() && cooldownManagerInstance && objMgr &&
+        rotationWorkerInstance->PollDecision(nowMs, workerDecision)) {
+        // The decision may be a few frames old - re-check what can change in between
+        constexpr uint64_t MAX_DECISION_AGE_MS = 250;
+        uint64_t decidedFor = (std::max)(workerDecision.snapshotTimeMs, workerDecision.readyAtMs);
+        bool fresh = nowMs - decidedFor <= MAX_DECISION_AGE_MS;
+        bool ready = !cooldownManagerInstance->IsSpellOnCooldown(static_cast<int>(workerDecision.spellId));
+
+        if (fresh && !ready && workerDecision.speculative) {
+            // GCD/cast end was predicted a little early - keep it queued for the next frame
+            rotationWorkerInstance->HoldDecision(workerDecision);
+        } else if (fresh && ready) {
+            bool stillValid = !workerDecision.requiresTarget || workerDecision.targetGuid == 0 ||
+                              objMgr->GetObjectByGUID(workerDecision.targetGuid) != nullptr;
+            auto program = rotationWorkerInstance->GetProgram();
+            if (workerDecision.speculative && frameSnapshot && program) {
+                // Verify against this frame's state; if the world diverged, re-decide here (a few microseconds)
+                stillValid = stillValid && Rotation::RotationWorker::Verify(*program, *frameSnapshot, workerDecision);
+                rotationWorkerInstance->RecordSpeculation(stillValid);
+                if (!stillValid) {
+                    stillValid = Rotation::RotationWorker::Decide(*program, *frameSnapshot,
+                                                                  rotationWorkerInstance->IsMultiTargetEnabled(), workerDecision);
+                }
+            }
+
+            bool hasLos = true;
+            if (stillValid && !QueryDecisionLos(objMgr, workerDecision, hasLos)) {
+                // Target not checked yet - wait for the next frame's RunFrame (dropped once no longer fresh)
+                rotationWorkerInstance->HoldDecision(workerDecision);
+            } else if (stillValid && hasLos) {
+                // GROUND_CLUSTER steps are placed at the cluster center instead of on a unit
+                bool castSucceeded = workerDecision.hasGroundPosition
+                    ? Spells::CastSpellAtPosition(static_cast<int>(workerDecision.spellId), workerDecision.groundPosition)
+                    : Spells::CastSpell(workerDecision.spellId, workerDecision.targetGuid, workerDecision.requiresTarget);
+                cooldownManagerInstance->RecordSpellCast(static_cast<int>(workerDecision.spellId), castSucceeded);
+            }
+        }
+    }
+    // --- End Spell Casting from RotationWorker ---
+
     // Simplified ImGui rendering call
     if (imguiInitialized) {
         if (!g_imguiInFrame) {
@@ -508,6 +660,7 @@ HRESULT APIENTRY HookedReset(LPDIRECT3DDEVICE9 pDevice, D3DPRESENT_PARAMETERS* p
 void InitializeHook(HMODULE hModule) {
     // char buffer[256]; // Ensure this is declared if using sprintf_s below, like in backup
     Core::Log::Message("[InitializeHook] Starting hook initialization...");
+    Rotation::ProfileLoader::GetInstance().MarkInjected();
     g_shutdownRequested.store(false);
     g_isShuttingDown.store(false);
 
@@ -519,6 +672,7 @@ void InitializeHook(HMODULE hModule) {
     std::filesystem::path rotationsDir = baseDir / "rotations";
     Core::Log::Message("[InitializeHook] DLL Path: " + dllPath.string());
     Core::Log::Message("[InitializeHook] Rotations Directory determined as: " + rotationsDir.string());
+    Rotation::DecisionTrace::GetInstance().SetDumpDirectory((baseDir / "logs").string());
 
     // ObjectManager, CooldownManager, RotationEngine initialization (as per recent correct version)
     objectManagerInstance = ObjectManager::GetInstance();
@@ -549,6 +703,12 @@ void InitializeHook(HMODULE hModule) {
     if (!cooldownManagerInstance) {
         cooldownManagerInstance = new Spells::CooldownManager();
         Core::Log::Message("[InitializeHook] CooldownManager initialized.");
+
+        // Spell metadata: prefer extracted DBC files next to the DLL, otherwise the client spell DB is used
+        std::filesystem::path dbcDir = baseDir / "dbc";
+        if (Spells::SpellInfoCache::GetInstance().LoadDbcDirectory(dbcDir.string())) {
+            Core::Log::Message("[InitializeHook] Spell metadata will be read from " + dbcDir.string());
+        }
     }
 
     // Initialize FishingBot
@@ -563,7 +723,12 @@ void InitializeHook(HMODULE hModule) {
         if (objectManagerInstance && cooldownManagerInstance) {
             rotationEngineInstance = new Rotation::RotationEngine(*objectManagerInstance, *cooldownManagerInstance, hModule);
             Core::Log::Message("[InitializeHook] RotationEngine base initialized.");
-            rotationEngineInstance->LoadRotations(rotationsDir.string()); 
+            // The engine parses its own copy of every profile (RotationParser, serial): its selection and Start
+            // look profiles up there and it has no way to take ProfileLoader's. Timed into the load report.
+            auto engineLoadStart = std::chrono::steady_clock::now();
+            rotationEngineInstance->LoadRotations(rotationsDir.string());
+            Rotation::ProfileLoader::GetInstance().RecordEngineLoad(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - engineLoadStart).count());
             if (std::filesystem::exists(rotationsDir)) {
                 Core::Log::Message("[InitializeHook] Rotations directory exists. LoadRotations called.");
             } else {
@@ -574,6 +739,20 @@ void InitializeHook(HMODULE hModule) {
         }
     }
 
+    // Parallel profile load; unchanged profiles come from the binary cache. Logs time-to-ready.
+    Rotation::ProfileLoader::GetInstance().LoadDirectory(rotationsDir.string());
+
+    if (!rotationWorkerInstance) {
+        rotationWorkerInstance = new Rotation::RotationWorker();
+        rotationWorkerInstance->SetCooldownManager(cooldownManagerInstance); // Tracks the installed program's spells
+        rotationWorkerInstance->Start(); // Idles until a compiled program is set
+    }
+
+    if (!profileWatcherInstance && rotationWorkerInstance) {
+        profileWatcherInstance = new Rotation::ProfileWatcher(*rotationWorkerInstance);
+        profileWatcherInstance->Start(rotationsDir.string()); // Hot reload of edited profiles
+    }
+
     if (!g_rotationsTab && rotationEngineInstance) {
         g_rotationsTab = new GUI::RotationsTab(*rotationEngineInstance, g_shutdownRequested); 
         Core::Log::Message("[InitializeHook] RotationsTab initialized.");
@@ -806,6 +985,8 @@ void CleanupHook(bool isForceTermination) {
     try {
         OutputDebugStringA("CleanupHook: Cleaning up Rotation System...\n");
         delete g_rotationsTab; g_rotationsTab = nullptr; 
+        delete profileWatcherInstance; profileWatcherInstance = nullptr; // Joins the watcher thread (uses the worker)
+        delete rotationWorkerInstance; rotationWorkerInstance = nullptr; // Joins the worker thread
         delete rotationEngineInstance; rotationEngineInstance = nullptr; 
         delete cooldownManagerInstance; cooldownManagerInstance = nullptr; 
         delete fishingBotInstance; fishingBotInstance = nullptr; // Delete FishingBot instance
@@ -15,6 +15,7 @@
 #include <cmath>  // For std::sqrt, std::atan2, std::fabs
 #include <vector>
 #include "../game_state/GameStateManager.h" // <<< ADDED for game state checks
+#include "../spells/motiontracker.h"
 
 // Define PI if not using C++20 <numbers>
 #ifndef M_PI
@@ -128,7 +129,8 @@ ObjectManager::ObjectManager()
       m_isActive(false),           // atomic, NEW
       m_cachedLocalPlayer(nullptr),
       m_localPlayerGuid({}), // Initialize WGUID
-      m_lastUpdateTime(std::chrono::steady_clock::now()) // RESTORE Initialize timestamp
+      m_lastUpdateTime(std::chrono::steady_clock::now()), // RESTORE Initialize timestamp
+      m_unitTable(std::make_shared<UnitTable>())
 {
     // Core::Log::Message("[ObjectManager] Instance created.");
 }
@@ -158,6 +160,7 @@ void ObjectManager::ResetState() {
     m_objectCache.clear();      // Clear the main object map
     m_localPlayerGuid = WGUID(); // Reset local player GUID
     m_cachedLocalPlayer = nullptr; // Reset cached local player pointer
+    m_unitTable = std::make_shared<UnitTable>();
     m_objectManagerPtr = nullptr; // Force re-acquisition on next TryFinishInitialization
     m_isFullyInitialized.store(false, std::memory_order_release);
     m_isActive.store(false, std::memory_order_release); // Also mark as inactive
@@ -449,6 +452,10 @@ void ObjectManager::ProcessFoundObject(WGUID guid, void* objectPtr) {
             if (obj) { 
                  // Update dynamic data FIRST, before locking
                  obj->UpdateDynamicData(); // Read name, pos, etc. (virtual call)
+                 if (obj->IsUnit()) {
+                     // Movement flags are only read for the local player
+                     Spells::MotionTracker::GetInstance().Record(*static_cast<WowUnit*>(obj.get()), guid == m_localPlayerGuid);
+                 }
 
                  // Now lock ONLY to insert into the cache
                  std::lock_guard<std::mutex> lock(m_cacheMutex);
@@ -483,6 +490,7 @@ void ObjectManager::Update()
             // Core::Log::Message("[ObjectManager::Update] Now Not in world. Setting OM inactive and clearing cache.");
             m_objectCache.clear();      // Clear the main object map
             m_cachedLocalPlayer = nullptr; // Reset cached local player pointer
+            m_unitTable = std::make_shared<UnitTable>();
             // Consider if m_localPlayerGuid should also be reset or if it's okay to persist
         }
         m_isActive.store(false, std::memory_order_release);
@@ -559,6 +567,7 @@ void ObjectManager::Update()
 
     // --- Update timestamp AFTER successful execution (or attempt) --- 
     m_lastUpdateTime = now;
+    m_unitTableDirty.store(true, std::memory_order_release); // Classified once the local player is refreshed
 
     // NOTE: RefreshLocalPlayerCache should be called separately *after* Update()
 }
@@ -721,6 +730,132 @@ std::shared_ptr<WowObject> ObjectManager::GetObjectByGUID_locked(WGUID guid) {
     return (it != m_objectCache.end()) ? it->second : nullptr;
 }
 
+// --- Unit Classification ---
+
+size_t UnitTable::Count(uint16_t require, uint16_t exclude) const {
+    const uint16_t test = require | exclude;
+    size_t count = 0;
+    for (size_t i = 0; i < masks.size(); ++i) {
+        count += (masks[i] & test) == require;
+    }
+    return count;
+}
+
+size_t UnitTable::Select(uint16_t require, uint16_t exclude, std::vector<uint32_t>& outIndices) const {
+    const uint16_t test = require | exclude;
+    const size_t n = masks.size();
+    outIndices.resize(n);
+    // Branchless compaction: every index is written, only matches advance the cursor
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        outIndices[count] = static_cast<uint32_t>(i);
+        count += (masks[i] & test) == require;
+    }
+    outIndices.resize(count);
+    return count;
+}
+
+size_t UnitTable::SelectUnits(uint16_t require, uint16_t exclude, std::vector<std::shared_ptr<WowObject>>& outUnits) const {
+    std::vector<uint32_t> indices;
+    Select(require, exclude, indices);
+    outUnits.clear();
+    outUnits.reserve(indices.size());
+    for (uint32_t index : indices) {
+        outUnits.push_back(units[index]);
+    }
+    return outUnits.size();
+}
+
+uint16_t UnitTable::MaskOf(uint64_t guid) const {
+    // A few hundred contiguous GUIDs: a linear scan beats building an index per update
+    for (size_t i = 0; i < guids.size(); ++i) {
+        if (guids[i] == guid) return masks[i];
+    }
+    return 0;
+}
+
+void ObjectManager::ClassifyUnits() {
+    if (!m_unitTableDirty.exchange(false, std::memory_order_acq_rel)) {
+        return; // No enumeration since the last table
+    }
+
+    auto table = std::make_shared<UnitTable>();
+    std::shared_ptr<WowPlayer> player;
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMutex);
+        player = m_cachedLocalPlayer;
+        table->units.reserve(m_objectCache.size());
+        for (const auto& pair : m_objectCache) {
+            if (pair.second && pair.second->IsUnit()) {
+                table->units.push_back(std::static_pointer_cast<WowUnit>(pair.second));
+            }
+        }
+    }
+
+    // Group: the player and the party slots (raid members beyond the party are not read)
+    uint64_t playerGuid = player ? player->GetGUID64() : 0;
+    uint64_t groupGuids[GameOffsets::PARTY_MEMBER_COUNT + 1] = { playerGuid };
+    try {
+        for (int i = 0; i < GameOffsets::PARTY_MEMBER_COUNT; ++i) {
+            groupGuids[i + 1] = Memory::Read<uint64_t>(GameOffsets::PARTY_MEMBER_GUIDS_ADDR + i * sizeof(uint64_t));
+        }
+    } catch (const MemoryAccessError&) {
+        // Not in a group (or unreadable): the player alone
+    }
+    auto inGroup = [&groupGuids](uint64_t guid) {
+        if (guid == 0) return false;
+        for (uint64_t member : groupGuids) {
+            if (member == guid) return true;
+        }
+        return false;
+    };
+
+    // Held for the whole pass: SetUnitClassifier(nullptr) in the owner's destructor then waits for it,
+    // so a classifier is never called after its owner is gone
+    std::unique_lock<std::mutex> classifierLock(m_classifierMutex);
+    const UnitClassifier& classifier = m_unitClassifier;
+    table->hasRelations = classifier && player;
+
+    const size_t count = table->units.size();
+    table->guids.resize(count);
+    table->masks.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        WowUnit& unit = *table->units[i];
+        uint64_t guid = unit.GetGUID64();
+        uint16_t mask = 0;
+        if (unit.IsDead()) mask |= UNIT_CLASS_DEAD;
+        if (unit.IsInCombat()) mask |= UNIT_CLASS_IN_COMBAT;
+        if (unit.IsTappedByOther()) mask |= UNIT_CLASS_TAPPED;
+        if (unit.IsPlayer()) mask |= UNIT_CLASS_PLAYER;
+        if (unit.IsPet()) mask |= UNIT_CLASS_PET;
+        if (guid == playerGuid) mask |= UNIT_CLASS_SELF;
+        if (inGroup(guid) || inGroup(unit.GetOwnerGUID().ToUint64())) mask |= UNIT_CLASS_IN_GROUP;
+        if (table->hasRelations) {
+            try {
+                mask |= classifier(*player, unit) & UNIT_CLASS_RELATION_MASK;
+            } catch (const std::exception& e) {
+                Core::Log::Message(std::string("[ObjectManager::ClassifyUnits] Classifier exception: ") + e.what());
+            }
+        }
+        table->guids[i] = guid;
+        table->masks[i] = mask;
+    }
+    classifierLock.unlock();
+
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    m_unitTable = std::move(table);
+}
+
+void ObjectManager::SetUnitClassifier(UnitClassifier classifier) {
+    std::lock_guard<std::mutex> lock(m_classifierMutex);
+    m_unitClassifier = std::move(classifier);
+}
+
+std::shared_ptr<const UnitTable> ObjectManager::GetUnitTable() const {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    return m_unitTable;
+}
+
 // GetObjectsByType - Remains thread-safe due to lock
 std::vector<std::shared_ptr<WowObject>> ObjectManager::GetObjectsByType(WowObjectType type) {
     if (!m_isActive.load(std::memory_order_acquire)) {
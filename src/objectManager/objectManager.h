@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <chrono>
 #include <atomic>
+#include <functional>
 
 #include "../types/types.h"     // Use types defined in our project
 #include "../types/wowobject.h" // Use objects defined in our project
@@ -29,8 +30,52 @@ namespace GameOffsets {
     constexpr uintptr_t GET_LOCAL_PLAYER_GUID_ADDR = 0x0; // Set to 0, we will attempt direct read first
     constexpr uintptr_t WORLD_LOADED_FLAG_ADDR = 0x00BEBA40; // Seems to be 1 when world is loaded/loading textures
     constexpr uintptr_t PLAYER_IS_LOOTING_OFFSET = 0x18E8; // Offset from player base for looting status (Byte: 1 if looting, 0 if not)
+    constexpr uintptr_t PARTY_MEMBER_GUIDS_ADDR = 0x00BD1940; // 4 x uint64 GUIDs of the other party members (0 = empty slot)
+    constexpr int PARTY_MEMBER_COUNT = 4;
 }
 
+// Per-unit classification bits, computed once per ObjectManager update (see UnitTable)
+enum UnitClass : uint16_t {
+    UNIT_CLASS_HOSTILE     = 1 << 0,  // Reaction hostile or unfriendly
+    UNIT_CLASS_FRIENDLY    = 1 << 1,
+    UNIT_CLASS_ATTACKABLE  = 1 << 2,  // Valid harmful target (alive, not blacklisted, neutral or worse)
+    UNIT_CLASS_DEAD        = 1 << 3,
+    UNIT_CLASS_IN_COMBAT   = 1 << 4,
+    UNIT_CLASS_TAPPED      = 1 << 5,  // Tapped by someone outside our group
+    UNIT_CLASS_BLACKLISTED = 1 << 6,
+    UNIT_CLASS_PLAYER      = 1 << 7,
+    UNIT_CLASS_PET         = 1 << 8,  // Summoned or charmed by another unit
+    UNIT_CLASS_IN_GROUP    = 1 << 9,  // Local player, party members and their pets
+    UNIT_CLASS_SELF        = 1 << 10,
+
+    // Bits only the registered classifier can tell (reaction, BG mode, name blacklist)
+    UNIT_CLASS_RELATION_MASK = UNIT_CLASS_HOSTILE | UNIT_CLASS_FRIENDLY | UNIT_CLASS_ATTACKABLE | UNIT_CLASS_BLACKLISTED
+};
+
+/**
+ * Units and players of one ObjectManager update with their classification masks, in parallel arrays.
+ * Built once per update and never modified after it is published, so readers share it without locking.
+ * Candidate scans test masks instead of re-running the reaction, blacklist and state checks per unit.
+ */
+struct UnitTable {
+    std::vector<std::shared_ptr<WowUnit>> units;
+    std::vector<uint64_t> guids;
+    std::vector<uint16_t> masks;
+    bool hasRelations = false; // Relation bits were filled (a classifier was registered and the player known)
+
+    // Units whose mask has every bit of require and none of exclude
+    size_t Count(uint16_t require, uint16_t exclude = 0) const;
+    /**
+     * Indices of the units whose mask has every bit of require and none of exclude
+     * @return Number of matches
+     */
+    size_t Select(uint16_t require, uint16_t exclude, std::vector<uint32_t>& outIndices) const;
+    // Same selection as unit pointers (input for TargetScorer / HealTriage)
+    size_t SelectUnits(uint16_t require, uint16_t exclude, std::vector<std::shared_ptr<WowObject>>& outUnits) const;
+    // Mask of a unit, 0 if it isn't in the table
+    uint16_t MaskOf(uint64_t guid) const;
+};
+
 // Callback for EnumVisibleObjects
 typedef int(__cdecl* EnumVisibleObjectsCallback)(uint32_t guid_low, uint32_t guid_high, int callback_arg);
 
@@ -59,6 +104,12 @@ private:
     mutable std::mutex m_cacheMutex;
     std::shared_ptr<WowPlayer> m_cachedLocalPlayer;
     WGUID m_localPlayerGuid; // Added missing member
+
+    // Unit classification, rebuilt by ClassifyUnits after each enumeration (guarded by m_cacheMutex)
+    std::shared_ptr<const UnitTable> m_unitTable;
+    std::atomic<bool> m_unitTableDirty{ false };
+    std::function<uint16_t(WowPlayer& player, WowUnit& unit)> m_unitClassifier;
+    mutable std::mutex m_classifierMutex;
     
     // Callback for enumeration
     static int __cdecl EnumObjectsCallback(uint32_t guid_low, uint32_t guid_high, int callback_arg);
@@ -138,6 +189,25 @@ public:
     
     // Refresh cached player pointer (needs to be called after Update)
     void RefreshLocalPlayerCache();
+
+    // --- Unit Classification ---
+    using UnitClassifier = std::function<uint16_t(WowPlayer& player, WowUnit& unit)>;
+
+    /**
+     * Rebuild the unit table if Update enumerated since the last call (call after RefreshLocalPlayerCache).
+     * Runs the classifier on the calling thread, once per unit.
+     */
+    void ClassifyUnits();
+
+    /**
+     * Classifier for the relation bits (UNIT_CLASS_RELATION_MASK); other bits it returns are ignored
+     * @param classifier Called with the local player for every unit, or nullptr to unregister
+     *        (waits for a ClassifyUnits pass in progress). Must not call SetUnitClassifier itself.
+     */
+    void SetUnitClassifier(UnitClassifier classifier);
+
+    // Table of the last update (never null; empty while out of world)
+    std::shared_ptr<const UnitTable> GetUnitTable() const;
     
     // --- Game State Checks ---
     bool IsPlayerInWorld() const; // New method
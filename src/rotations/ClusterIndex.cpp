@@ -0,0 +1,192 @@
+#include "ClusterIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Rotation {
+
+ClusterIndex& ClusterIndex::ForThread() {
+    thread_local ClusterIndex index;
+    return index;
+}
+
+uint64_t ClusterIndex::CellKey(int32_t cx, int32_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+int32_t ClusterIndex::CellCoord(float value) {
+    return static_cast<int32_t>(std::floor(value / CELL_SIZE));
+}
+
+void ClusterIndex::Sync(const WorldSnapshot& world) {
+    // The VM syncs before every cluster check; only the first one per snapshot does the work
+    if (m_syncedWorld == &world && m_syncedTimeMs == world.timestampMs && m_syncedUnits == world.nearbyUnits.size()) return;
+    m_syncedWorld = &world;
+    m_syncedTimeMs = world.timestampMs;
+    m_syncedUnits = world.nearbyUnits.size();
+    m_memo.clear();
+    ++m_pass;
+
+    auto visit = [this](const UnitSnapshot& unit) {
+        if (!unit.isHostile || unit.isDead || unit.guid == 0) return;
+        uint64_t cell = CellKey(CellCoord(unit.position.x), CellCoord(unit.position.y));
+        auto it = m_members.find(unit.guid);
+        if (it == m_members.end()) {
+            m_members[unit.guid] = { cell, m_pass };
+            Add(unit.guid, unit.position, cell);
+            return;
+        }
+        if (it->second.seenPass == m_pass) return; // Target also listed in nearbyUnits
+        it->second.seenPass = m_pass;
+        if (it->second.cell == cell) {
+            for (auto& point : m_buckets[cell]) {
+                if (point.guid == unit.guid) {
+                    point.position = unit.position;
+                    break;
+                }
+            }
+            return;
+        }
+        RemoveFromCell(unit.guid, it->second.cell);
+        it->second.cell = cell;
+        Add(unit.guid, unit.position, cell);
+    };
+    if (world.hasTarget) visit(world.target);
+    for (const auto& unit : world.nearbyUnits) visit(unit);
+
+    // Died, turned friendly or left the snapshot
+    for (auto it = m_members.begin(); it != m_members.end();) {
+        if (it->second.seenPass != m_pass) {
+            RemoveFromCell(it->first, it->second.cell);
+            it = m_members.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ClusterIndex::Add(uint64_t guid, const Vector3& position, uint64_t cell) {
+    m_buckets[cell].push_back({ guid, position });
+}
+
+void ClusterIndex::RemoveFromCell(uint64_t guid, uint64_t cell) {
+    auto bucket = m_buckets.find(cell);
+    if (bucket == m_buckets.end()) return;
+    auto& points = bucket->second;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (points[i].guid == guid) {
+            points[i] = points.back();
+            points.pop_back();
+            break;
+        }
+    }
+    if (points.empty()) m_buckets.erase(bucket);
+}
+
+int ClusterIndex::CountWithin(const Vector3& center, float radius) const {
+    float radiusSq = radius * radius;
+    int count = 0;
+    for (int32_t cx = CellCoord(center.x - radius); cx <= CellCoord(center.x + radius); ++cx) {
+        for (int32_t cy = CellCoord(center.y - radius); cy <= CellCoord(center.y + radius); ++cy) {
+            auto bucket = m_buckets.find(CellKey(cx, cy));
+            if (bucket == m_buckets.end()) continue;
+            for (const auto& point : bucket->second) {
+                if (point.position.DistanceSq(center) <= radiusSq) ++count;
+            }
+        }
+    }
+    return count;
+}
+
+int ClusterIndex::UpperBound(const Vector3& center, float radius) const {
+    int bound = 0;
+    for (int32_t cx = CellCoord(center.x - radius); cx <= CellCoord(center.x + radius); ++cx) {
+        for (int32_t cy = CellCoord(center.y - radius); cy <= CellCoord(center.y + radius); ++cy) {
+            auto bucket = m_buckets.find(CellKey(cx, cy));
+            if (bucket != m_buckets.end()) bound += static_cast<int>(bucket->second.size());
+        }
+    }
+    return bound;
+}
+
+const ClusterIndex::Memo* ClusterIndex::FindMemo(bool ground, float radius, float maxRange) const {
+    for (const auto& memo : m_memo) {
+        if (memo.ground == ground && memo.radius == radius && memo.maxRange == maxRange) return &memo;
+    }
+    return nullptr;
+}
+
+bool ClusterIndex::BestTarget(float radius, const Vector3& from, float maxRange, AoeCluster& out) {
+    return Best(false, radius, from, maxRange, out);
+}
+
+bool ClusterIndex::BestCenter(float radius, const Vector3& from, float maxRange, AoeCluster& out) {
+    return Best(true, radius, from, maxRange, out);
+}
+
+bool ClusterIndex::Best(bool ground, float radius, const Vector3& from, float maxRange, AoeCluster& out) {
+    if (const Memo* memo = FindMemo(ground, radius, maxRange)) {
+        out = memo->result;
+        return memo->found;
+    }
+
+    float maxRangeSq = maxRange > 0.0f ? maxRange * maxRange : 0.0f;
+    float radiusSq = radius * radius;
+    AoeCluster best;
+    float bestDistanceSq = 0.0f;
+    bool found = false;
+    auto consider = [&](const Vector3& center, uint64_t guid) {
+        float distanceSq = center.DistanceSq(from);
+        if (maxRangeSq > 0.0f && distanceSq > maxRangeSq) return;
+        if (found && UpperBound(center, radius) < best.count) return;
+        int count = CountWithin(center, radius);
+        // More units, then closer to the player
+        if (!found || count > best.count || (count == best.count && distanceSq < bestDistanceSq)) {
+            best.targetGuid = guid;
+            best.center = center;
+            best.count = count;
+            bestDistanceSq = distanceSq;
+            found = true;
+        }
+    };
+
+    for (const auto& bucket : m_buckets) {
+        for (const auto& point : bucket.second) {
+            consider(point.position, point.guid);
+            if (!ground) continue;
+
+            // Centroid of the unit's neighbourhood, often covering units a unit-centered circle misses
+            Vector3 sum;
+            int neighbours = 0;
+            for (int32_t cx = CellCoord(point.position.x - radius); cx <= CellCoord(point.position.x + radius); ++cx) {
+                for (int32_t cy = CellCoord(point.position.y - radius); cy <= CellCoord(point.position.y + radius); ++cy) {
+                    auto neighbourBucket = m_buckets.find(CellKey(cx, cy));
+                    if (neighbourBucket == m_buckets.end()) continue;
+                    for (const auto& other : neighbourBucket->second) {
+                        if (other.position.DistanceSq(point.position) > radiusSq) continue;
+                        sum.x += other.position.x;
+                        sum.y += other.position.y;
+                        sum.z += other.position.z;
+                        ++neighbours;
+                    }
+                }
+            }
+            if (neighbours > 1) {
+                float inv = 1.0f / static_cast<float>(neighbours);
+                consider(Vector3(sum.x * inv, sum.y * inv, sum.z * inv), point.guid);
+            }
+        }
+    }
+
+    m_memo.push_back({ ground, radius, maxRange, found, best });
+    out = best;
+    return found;
+}
+
+void ClusterIndex::Clear() {
+    m_buckets.clear();
+    m_members.clear();
+    m_memo.clear();
+    m_syncedWorld = nullptr;
+}
+
+} // namespace Rotation
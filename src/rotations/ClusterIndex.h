@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "WorldSnapshot.h"
+
+namespace Rotation {
+
+// Best AoE placement for one radius
+struct AoeCluster {
+    uint64_t targetGuid = 0; // Unit to cast on (ENEMY_CLUSTER), or the unit the center was grown from (GROUND_CLUSTER)
+    Vector3 center;          // Where the AoE lands
+    int count = 0;           // Living hostiles within the radius of center
+};
+
+/**
+ * Living hostile units of the snapshots bucketed on a 2D grid of CELL_SIZE yard cells.
+ * Sync() moves a unit between buckets only when it crosses a cell border, adds new units and drops
+ * the ones that left, so a tick costs one pass over the units. Radius counts only visit the cells
+ * the circle overlaps, and the number of units in those cells bounds the count, so candidates that
+ * cannot beat the best so far are skipped without measuring distances.
+ *
+ * Answers "which enemy has the most enemies within R" (cleave/chain targets) and "where should a
+ * ground AoE of radius R be centered". Results are memoized per radius until the next snapshot.
+ *
+ * Not thread-safe; ForThread() gives each thread its own index (the VM and RotationWorker share
+ * the worker thread's).
+ */
+class ClusterIndex {
+public:
+    static constexpr float CELL_SIZE = 5.0f;
+
+    static ClusterIndex& ForThread();
+
+    /**
+     * Bring the grid up to date with a snapshot (no-op for the snapshot already synced)
+     */
+    void Sync(const WorldSnapshot& world);
+
+    /**
+     * Unit with the most living hostiles within radius of it (itself included)
+     * @param radius AoE radius in yards
+     * @param from Position maxRange is measured from (the player)
+     * @param maxRange Only units this close to from, 0 = any
+     * @param out Best cluster
+     * @return false if there is no hostile unit in range
+     */
+    bool BestTarget(float radius, const Vector3& from, float maxRange, AoeCluster& out);
+
+    /**
+     * Ground position covering the most living hostiles within radius. Candidates are every unit
+     * position and the centroid of each unit's neighbourhood.
+     * @return false if there is no hostile unit in range
+     */
+    bool BestCenter(float radius, const Vector3& from, float maxRange, AoeCluster& out);
+
+    // Living hostiles within radius of center
+    int CountWithin(const Vector3& center, float radius) const;
+
+    size_t Size() const { return m_members.size(); }
+    void Clear();
+
+private:
+    struct Point {
+        uint64_t guid;
+        Vector3 position;
+    };
+
+    struct Member {
+        uint64_t cell;
+        uint32_t seenPass;
+    };
+
+    struct Memo {
+        bool ground;
+        float radius;
+        float maxRange;
+        bool found;
+        AoeCluster result;
+    };
+
+    static uint64_t CellKey(int32_t cx, int32_t cy);
+    static int32_t CellCoord(float value);
+
+    void Add(uint64_t guid, const Vector3& position, uint64_t cell);
+    void RemoveFromCell(uint64_t guid, uint64_t cell);
+    int UpperBound(const Vector3& center, float radius) const;
+    const Memo* FindMemo(bool ground, float radius, float maxRange) const;
+    bool Best(bool ground, float radius, const Vector3& from, float maxRange, AoeCluster& out);
+
+    std::unordered_map<uint64_t, std::vector<Point>> m_buckets; // Cell -> units in it
+    std::unordered_map<uint64_t, Member> m_members;             // Unit -> its cell
+    std::vector<Memo> m_memo;
+    uint32_t m_pass = 0;
+    const WorldSnapshot* m_syncedWorld = nullptr;
+    uint64_t m_syncedTimeMs = 0;
+    size_t m_syncedUnits = 0;
+};
+
+} // namespace Rotation
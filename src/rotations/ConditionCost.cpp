@@ -0,0 +1,125 @@
+#include "ConditionCost.h"
+#include <algorithm>
+
+namespace Rotation {
+
+ConditionCostModel& ConditionCostModel::GetInstance() {
+    static ConditionCostModel instance;
+    return instance;
+}
+
+float ConditionCostModel::StaticCost(OpCode op) {
+    switch (op) {
+    case OpCode::CONST:
+    case OpCode::HAS_TARGET:
+    case OpCode::NOT_MOVING:
+    case OpCode::COMBO_AT_LEAST:
+    case OpCode::THREAT_BELOW:
+        return 1.0f;
+    case OpCode::HEALTH_BELOW:
+    case OpCode::IS_CASTING:
+    case OpCode::POWER_AT_LEAST:
+        return 2.0f;
+    case OpCode::POWER_PCT_ABOVE:
+        return 3.0f;
+    case OpCode::SPELL_READY:
+    case OpCode::CHARGES_AT_LEAST:
+        return 5.0f;  // Binary search over the spell table
+    case OpCode::HAS_AURA:
+        return 8.0f;  // Binary search over the unit's auras
+    case OpCode::FACING_TARGET:
+        return 20.0f; // atan2
+    case OpCode::HAS_AURA_ANY:
+    case OpCode::HAS_AURA_ALL:
+        return 25.0f;
+    case OpCode::UNITS_NEAR_GT:
+        return 60.0f; // Scan of nearby units
+    case OpCode::UNITS_IN_CONE_GT:
+        return 150.0f; // Scan + atan2 per unit
+    case OpCode::CLUSTER_AT_LEAST:
+        return 200.0f; // Grid sync + neighbourhood counts (memoized per snapshot)
+    default:
+        return 10.0f;
+    }
+}
+
+uint64_t ConditionCostModel::ConditionKey(const uint32_t* code, uint32_t pc) {
+    // FNV-1a over the instruction words
+    uint64_t hash = 1469598103934665603ULL;
+    uint32_t length = InstructionLength(code, pc);
+    for (uint32_t i = 0; i < length; ++i) {
+        uint32_t word = (i == 0) ? WithMemoSlot(code[pc], 0) : code[pc + i];
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (word >> (b * 8)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+void ConditionCostModel::Record(const std::vector<Sample>& samples) {
+    if (samples.empty()) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& sample : samples) {
+        size_t opIndex = static_cast<size_t>(sample.op);
+        if (opIndex >= static_cast<size_t>(OpCode::OPCODE_COUNT)) continue;
+
+        OpTiming& timing = m_timings[opIndex];
+        float ns = static_cast<float>(sample.ns);
+        timing.emaNs = (timing.samples == 0) ? ns : timing.emaNs + TIMING_ALPHA * (ns - timing.emaNs);
+        if (timing.samples < UINT32_MAX) ++timing.samples;
+
+        Outcome& outcome = m_outcomes[sample.key];
+        // Halve old counts now and then so the rate follows changes in the fight
+        if (outcome.evaluations >= 4096) {
+            outcome.evaluations /= 2;
+            outcome.failures /= 2;
+        }
+        ++outcome.evaluations;
+        if (!sample.passed) ++outcome.failures;
+        ++m_sampleCount;
+    }
+}
+
+float ConditionCostModel::EstimatedCostLocked(OpCode op) const {
+    size_t opIndex = static_cast<size_t>(op);
+    if (opIndex >= static_cast<size_t>(OpCode::OPCODE_COUNT)) return StaticCost(op);
+    const OpTiming& timing = m_timings[opIndex];
+    if (timing.samples < MIN_TIMING_SAMPLES) return StaticCost(op);
+    return (std::max)(0.1f, timing.emaNs);
+}
+
+float ConditionCostModel::FailureRateLocked(uint64_t key) const {
+    auto it = m_outcomes.find(key);
+    if (it == m_outcomes.end()) return 0.5f;
+    return (static_cast<float>(it->second.failures) + 1.0f) / (static_cast<float>(it->second.evaluations) + 2.0f);
+}
+
+float ConditionCostModel::Rank(uint64_t key, OpCode op) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return EstimatedCostLocked(op) / FailureRateLocked(key);
+}
+
+float ConditionCostModel::EstimatedCost(OpCode op) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return EstimatedCostLocked(op);
+}
+
+float ConditionCostModel::FailureRate(uint64_t key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FailureRateLocked(key);
+}
+
+uint64_t ConditionCostModel::GetSampleCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sampleCount;
+}
+
+void ConditionCostModel::Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& timing : m_timings) timing = OpTiming();
+    m_outcomes.clear();
+    m_sampleCount = 0;
+}
+
+} // namespace Rotation
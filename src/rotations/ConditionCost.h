@@ -0,0 +1,95 @@
+#pragma once
+
+#include <unordered_map>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "RotationCompiler.h"
+
+namespace Rotation {
+
+/**
+ * Cost model used by RotationCompiler to order the conditions of a step.
+ * Each condition starts with a static cost per opcode and a neutral failure rate. Sampled
+ * evaluations from the VM refine both: per-opcode time (EMA) and per-check pass/fail counts.
+ * Conditions are ANDed and pure, so any order gives the same result; sorting by
+ * cost / P(fail) ascending lets short-circuiting skip the expensive checks most of the time.
+ *
+ * Thread-safe; the VM records samples from whichever thread evaluates.
+ */
+class ConditionCostModel {
+public:
+    static ConditionCostModel& GetInstance();
+
+    // One measured condition evaluation
+    struct Sample {
+        uint64_t key;   // ConditionKey() of the instruction
+        OpCode op;
+        uint32_t ns;
+        bool passed;
+    };
+
+    /**
+     * Static relative cost of an opcode (roughly nanoseconds on a typical snapshot)
+     */
+    static float StaticCost(OpCode op);
+
+    /**
+     * Stable identity of a condition instruction: hash of its words with the memo slot cleared.
+     * Identical checks in different steps (or different compiles) share statistics.
+     * @param code Program code
+     * @param pc Index of the instruction header
+     */
+    static uint64_t ConditionKey(const uint32_t* code, uint32_t pc);
+
+    /**
+     * Record a batch of samples from one evaluation pass
+     */
+    void Record(const std::vector<Sample>& samples);
+
+    /**
+     * Expected cost per unit of "work skipped": cost / P(fail). Lower runs first.
+     * @param key ConditionKey of the instruction
+     * @param op Opcode of the instruction
+     */
+    float Rank(uint64_t key, OpCode op) const;
+
+    /**
+     * @return Estimated cost of an opcode: measured EMA once enough samples exist, else the static cost
+     */
+    float EstimatedCost(OpCode op) const;
+
+    /**
+     * @return Observed failure probability of a check (Laplace-smoothed, 0.5 when unseen)
+     */
+    float FailureRate(uint64_t key) const;
+
+    uint64_t GetSampleCount() const;
+    void Reset();
+
+private:
+    ConditionCostModel() = default;
+
+    // Samples needed before the measured time of an opcode replaces its static cost
+    static constexpr uint32_t MIN_TIMING_SAMPLES = 32;
+    static constexpr float TIMING_ALPHA = 0.05f;
+
+    float EstimatedCostLocked(OpCode op) const;
+    float FailureRateLocked(uint64_t key) const;
+
+    struct OpTiming {
+        float emaNs = 0.0f;
+        uint32_t samples = 0;
+    };
+    struct Outcome {
+        uint32_t evaluations = 0;
+        uint32_t failures = 0;
+    };
+
+    mutable std::mutex m_mutex;
+    OpTiming m_timings[static_cast<size_t>(OpCode::OPCODE_COUNT)];
+    std::unordered_map<uint64_t, Outcome> m_outcomes;
+    uint64_t m_sampleCount = 0;
+};
+
+} // namespace Rotation
@@ -0,0 +1,219 @@
+#include "DecisionTrace.h"
+#include "RotationCompiler.h"
+#include "WorldSnapshot.h"
+#include "../logs/log.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Rotation {
+
+namespace {
+
+// Copies only the used part of a tick (the step array is mostly empty)
+void CopyTick(TraceTick& dst, const TraceTick& src) {
+    dst.programId = src.programId;
+    dst.sequence = src.sequence;
+    dst.snapshotTimeMs = src.snapshotTimeMs;
+    dst.totalNs = src.totalNs;
+    dst.targetGuid = src.targetGuid;
+    dst.spellId = src.spellId;
+    dst.chosenStep = src.chosenStep;
+    dst.stepCount = src.stepCount;
+    dst.multiTarget = src.multiTarget;
+    dst.truncated = src.truncated;
+    dst.stepTiming = src.stepTiming;
+    std::memcpy(dst.profileName, src.profileName, sizeof(dst.profileName));
+    std::copy(src.steps, src.steps + src.stepCount, dst.steps);
+}
+
+} // namespace
+
+DecisionTrace& DecisionTrace::GetInstance() {
+    static DecisionTrace instance;
+    return instance;
+}
+
+uint64_t DecisionTrace::Timestamp() {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return __builtin_ia32_rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void DecisionTrace::SetEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (enabled && m_ring.empty()) {
+        try {
+            m_ring.resize(CAPACITY);
+        } catch (const std::exception& e) {
+            Core::Log::Message(std::string("[DecisionTrace] Could not allocate trace buffer: ") + e.what());
+            return;
+        }
+    }
+    if (enabled && !m_enabled.load()) {
+        m_calibTicks = Timestamp();
+        m_calibTime = std::chrono::steady_clock::now();
+    }
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+double DecisionTrace::TicksToNs(uint64_t ticks) const {
+    // Ratio measured over everything since tracing was enabled
+    uint64_t calibTicks;
+    std::chrono::steady_clock::time_point calibTime;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        calibTicks = m_calibTicks;
+        calibTime = m_calibTime;
+    }
+    uint64_t elapsedTicks = Timestamp() - calibTicks;
+    double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - calibTime).count();
+    if (elapsedTicks == 0 || elapsedNs <= 0.0) return static_cast<double>(ticks);
+    return static_cast<double>(ticks) * elapsedNs / static_cast<double>(elapsedTicks);
+}
+
+TraceTick* DecisionTrace::BeginTick(const RotationProgram& program, const WorldSnapshot& world) {
+    if (!m_enabled.load(std::memory_order_relaxed)) return nullptr;
+    // Allocated once per thread on its first traced tick
+    thread_local std::unique_ptr<TraceTick> scratch;
+    thread_local uint32_t tickCount = 0;
+    if (!scratch) scratch.reset(new TraceTick());
+    TraceTick* tick = scratch.get();
+    tick->Reset();
+    tick->stepTiming = (++tickCount % STEP_TIMING_INTERVAL) == 0;
+    tick->programId = program.id;
+    tick->snapshotTimeMs = world.timestampMs;
+    size_t length = (std::min)(program.profileName.size(), sizeof(tick->profileName) - 1);
+    std::memcpy(tick->profileName, program.profileName.data(), length);
+    tick->profileName[length] = '\0';
+    return tick;
+}
+
+void DecisionTrace::CommitTick(TraceTick* tick) {
+    if (!tick) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ring.empty()) return;
+    tick->sequence = m_recorded.fetch_add(1, std::memory_order_relaxed) + 1;
+    CopyTick(m_ring[m_next], *tick);
+    m_next = (m_next + 1) % m_ring.size();
+    m_count = (std::min)(m_count + 1, m_ring.size());
+}
+
+void DecisionTrace::CopyRecent(std::vector<TraceTick>& out, size_t maxTicks) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = (std::min)(maxTicks, m_count);
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = (m_next + m_ring.size() - 1 - i) % m_ring.size();
+        CopyTick(out[i], m_ring[index]);
+    }
+}
+
+bool DecisionTrace::DecodeStep(const RotationProgram& program, const TraceTick& tick, size_t stepPos,
+                               std::vector<TraceCondition>& out) {
+    out.clear();
+    if (tick.programId != program.id || stepPos >= tick.stepCount) return false;
+
+    // Replay the tick's steps up to stepPos so shared checks computed earlier show as memoized.
+    // Target checks are memoized per unit, player checks once per pass.
+    std::set<std::pair<uint32_t, uint64_t>> computed;
+    const uint32_t* code = program.code.data();
+    for (size_t s = 0; s <= stepPos; ++s) {
+        const TraceStep& traced = tick.steps[s];
+        auto it = std::find_if(program.steps.begin(), program.steps.end(),
+                               [&](const CompiledStep& step) { return step.stepIndex == traced.stepIndex; });
+        if (it == program.steps.end()) return false;
+
+        // The last executed instruction is a RETURN; everything before it ran in code order
+        uint32_t pc = it->codeOffset;
+        uint32_t linear = traced.instructions > 0 ? traced.instructions - 1u : 0u;
+        for (uint32_t i = 0; i < linear && pc < it->codeEnd; ++i) {
+            uint32_t header = code[pc];
+            OpCode op = HeaderOp(header);
+            if (op != OpCode::RETURN && op != OpCode::JUMP_IF_FALSE && op != OpCode::CONST) {
+                bool memoized = false;
+                if (HeaderMemoSlot(header) != 0) {
+                    uint64_t unit = HeaderUnit(header) == OperandUnit::TARGET ? traced.targetGuid : 0;
+                    memoized = !computed.insert({ HeaderMemoSlot(header), unit }).second;
+                }
+                if (s == stepPos) {
+                    TraceCondition condition;
+                    condition.pc = pc;
+                    condition.op = static_cast<uint8_t>(op);
+                    condition.passed = true;
+                    condition.memoized = memoized;
+                    out.push_back(condition);
+                }
+            }
+            pc += InstructionLength(code, pc);
+        }
+    }
+    // Short-circuit: a failed step stopped at its last condition
+    if (!tick.steps[stepPos].passed && !out.empty()) out.back().passed = false;
+    return true;
+}
+
+bool DecisionTrace::DumpToFile(const std::string& path, const RotationProgram* program) const {
+    std::vector<TraceTick> ticks;
+    CopyRecent(ticks, CAPACITY);
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        Core::Log::Message("[DecisionTrace] Cannot open " + path + " for writing.");
+        return false;
+    }
+
+    file << "# tick\tsnapshot_ms\tprofile\tchosen_step\tspell\ttarget\ttotal_ns\tmulti_target\ttruncated\n";
+    file << "#   step\tspell\ttarget\tpassed\tns (- = not timed this tick)\n";
+    file << "#     pc\top\tpassed\tmemoized (only for ticks of the current program)\n";
+    std::vector<TraceCondition> conditions;
+    for (auto it = ticks.rbegin(); it != ticks.rend(); ++it) {
+        const TraceTick& tick = *it;
+        file << tick.sequence << '\t' << tick.snapshotTimeMs << '\t' << tick.profileName << '\t' << tick.chosenStep << '\t'
+             << tick.spellId << "\t0x" << std::hex << tick.targetGuid << std::dec << '\t'
+             << tick.totalNs << '\t' << (tick.multiTarget ? 1 : 0) << '\t'
+             << (tick.truncated ? 1 : 0) << '\n';
+        for (uint16_t s = 0; s < tick.stepCount; ++s) {
+            const TraceStep& step = tick.steps[s];
+            file << "  " << step.stepIndex << '\t' << step.spellId << "\t0x" << std::hex << step.targetGuid << std::dec << '\t'
+                 << static_cast<int>(step.passed) << '\t';
+            if (tick.stepTiming) file << static_cast<uint64_t>(TicksToNs(step.ticks));
+            else file << '-';
+            file << '\n';
+            if (!program || !DecodeStep(*program, tick, s, conditions)) continue;
+            for (const auto& condition : conditions) {
+                file << "    " << condition.pc << '\t' << OpCodeName(static_cast<OpCode>(condition.op)) << '\t'
+                     << (condition.passed ? 1 : 0) << '\t' << (condition.memoized ? 1 : 0) << '\n';
+            }
+        }
+    }
+    Core::Log::Message("[DecisionTrace] Wrote " + std::to_string(ticks.size()) + " tick(s) to " + path);
+    return true;
+}
+
+void DecisionTrace::SetDumpDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dumpDirectory = directory;
+}
+
+std::string DecisionTrace::GetDumpPath() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (std::filesystem::path(m_dumpDirectory) / "rotation_trace.txt").string();
+}
+
+void DecisionTrace::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_next = 0;
+    m_count = 0;
+}
+
+} // namespace Rotation
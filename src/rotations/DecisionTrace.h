@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Build with ROTATION_TRACE=0 to compile the tracing hooks out of the evaluator entirely
+#ifndef ROTATION_TRACE
+#define ROTATION_TRACE 1
+#endif
+
+namespace Rotation {
+
+struct RotationProgram;
+struct WorldSnapshot;
+
+// One step evaluated during a tick (multi-target: one per step and candidate unit)
+struct TraceStep {
+    uint64_t targetGuid = 0;
+    uint32_t spellId = 0;
+    uint32_t ticks = 0;          // Timestamp ticks spent in the step (0 unless the tick has stepTiming), see DecisionTrace::TicksToNs
+    uint16_t stepIndex = 0;      // Index into RotationProfile::steps
+    uint16_t instructions = 0;   // Instructions executed, see DecisionTrace::DecodeStep
+    uint8_t passed = 0;
+};
+
+// Condition result rebuilt from a traced step
+struct TraceCondition {
+    uint32_t pc = 0;       // Header word index in RotationProgram::code
+    uint8_t op = 0;        // OpCode
+    bool passed = false;
+    bool memoized = false; // Result reused from the condition memo
+};
+
+// Everything one FindFirstCastableStep call did. Fixed size so recording never allocates.
+struct TraceTick {
+    static constexpr size_t MAX_STEPS = 128;
+
+    uint64_t programId = 0;       // RotationProgram::id, to match a program for decoding
+    uint64_t sequence = 0;
+    uint64_t snapshotTimeMs = 0;  // WorldSnapshot::timestampMs
+    uint64_t totalNs = 0;         // Whole evaluation
+    uint64_t targetGuid = 0;      // Unit the chosen step passed on
+    uint32_t spellId = 0;         // Chosen spell, 0 = nothing castable
+    int chosenStep = -1;          // Index into RotationProfile::steps
+    uint16_t stepCount = 0;
+    bool multiTarget = false;
+    bool truncated = false;       // More steps ran than fit
+    bool stepTiming = false;      // Steps were timed (one tick in STEP_TIMING_INTERVAL)
+    char profileName[32] = {};
+    TraceStep steps[MAX_STEPS];
+
+    void Reset() {
+        totalNs = targetGuid = 0;
+        spellId = 0;
+        chosenStep = -1;
+        stepCount = 0;
+        multiTarget = truncated = stepTiming = false;
+    }
+
+    // Hot path: called by the VM, no bounds growth, no allocation
+    TraceStep* BeginStep(uint16_t stepIndex, uint32_t spellId, uint64_t targetGuid) {
+        if (stepCount >= MAX_STEPS) {
+            truncated = true;
+            return nullptr;
+        }
+        TraceStep& step = steps[stepCount++];
+        step.stepIndex = stepIndex;
+        step.spellId = spellId;
+        step.targetGuid = targetGuid;
+        step.instructions = 0;
+        step.passed = 0;
+        step.ticks = 0;
+        return &step;
+    }
+};
+
+/**
+ * Ring buffer of the last CAPACITY rotation ticks, written by the VM when enabled.
+ * Each thread fills its own scratch tick and commits it under a short lock, so the evaluator
+ * never allocates and the GUI can copy ticks out at any time. Storage is allocated on the first
+ * SetEnabled(true).
+ * Every tick records the steps evaluated, the chosen action and its total time. Conditions cost
+ * nothing to trace: a step block runs linearly until its first failing check, so the instruction
+ * count per step is enough for DecodeStep to rebuild each condition's result from the program.
+ * Reading a clock per step costs about as much as a step itself, so per-step times (CPU timestamp
+ * counter, converted by TicksToNs) are only taken on one tick in STEP_TIMING_INTERVAL.
+ */
+class DecisionTrace {
+public:
+    static constexpr size_t CAPACITY = 128;
+    static constexpr uint32_t STEP_TIMING_INTERVAL = 16;
+
+    static DecisionTrace& GetInstance();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Start recording a tick on the calling thread
+     * @return Thread-local scratch tick, or nullptr when tracing is off
+     */
+    TraceTick* BeginTick(const RotationProgram& program, const WorldSnapshot& world);
+
+    /**
+     * Copy the scratch tick into the ring
+     */
+    void CommitTick(TraceTick* tick);
+
+    /**
+     * Copy the newest ticks, newest first
+     * @param out Receives up to maxTicks ticks
+     * @param maxTicks Limit
+     */
+    void CopyRecent(std::vector<TraceTick>& out, size_t maxTicks) const;
+
+    /**
+     * Rebuild the condition results of one traced step
+     * @param program Program the tick ran on (tick.programId must match)
+     * @param tick Traced tick
+     * @param stepPos Index into tick.steps
+     * @param out Conditions in execution order
+     * @return false if the program does not match the tick
+     */
+    static bool DecodeStep(const RotationProgram& program, const TraceTick& tick, size_t stepPos, std::vector<TraceCondition>& out);
+
+    /**
+     * Write every buffered tick as text, oldest first (one line per step, plus its conditions when
+     * the tick ran on `program`)
+     * @param path Output file
+     * @param program Program used to decode conditions (may be nullptr)
+     * @return true on success
+     */
+    bool DumpToFile(const std::string& path, const RotationProgram* program) const;
+
+    // Where the GUI writes dumps (set at injection to the DLL's logs folder)
+    void SetDumpDirectory(const std::string& directory);
+    std::string GetDumpPath() const;
+
+    void Clear();
+    uint64_t GetRecordedCount() const { return m_recorded.load(std::memory_order_relaxed); }
+
+    // Cheap timestamp for the hot path (rdtsc where available)
+    static uint64_t Timestamp();
+    double TicksToNs(uint64_t ticks) const;
+
+private:
+    DecisionTrace() = default;
+    DecisionTrace(const DecisionTrace&) = delete;
+    DecisionTrace& operator=(const DecisionTrace&) = delete;
+
+    std::atomic<bool> m_enabled{ false };
+    mutable std::mutex m_mutex;
+    std::vector<TraceTick> m_ring; // CAPACITY entries once enabled
+    size_t m_next = 0;
+    size_t m_count = 0;
+    std::atomic<uint64_t> m_recorded{ 0 };
+    std::string m_dumpDirectory;
+
+    // Calibration of Timestamp() against steady_clock, taken when tracing is enabled (guarded by m_mutex)
+    uint64_t m_calibTicks = 0;
+    std::chrono::steady_clock::time_point m_calibTime;
+};
+
+} // namespace Rotation
@@ -0,0 +1,250 @@
+#include "PriorityRanker.h"
+#include "../types/Rotation.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace Rotation {
+
+namespace {
+
+// Bit index of each input in the signature array
+constexpr int SIG_PLAYER_AURAS = 0;
+constexpr int SIG_TARGET_AURAS = 1;
+constexpr int SIG_PLAYER_HEALTH = 2;
+constexpr int SIG_TARGET_HEALTH = 3;
+constexpr int SIG_RESOURCE = 4;
+constexpr int SIG_TARGET_DISTANCE = 5;
+
+inline uint64_t Mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+inline uint64_t AuraPresence(const UnitSnapshot& unit, const std::vector<uint32_t>& ids) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        hash = Mix(hash, (static_cast<uint64_t>(i) << 1) | (unit.FindAura(ids[i]) ? 1u : 0u));
+    }
+    return hash;
+}
+
+uint32_t DependencyOf(PriorityCondition::Type type) {
+    switch (type) {
+    case PriorityCondition::Type::PLAYER_HAS_AURA: return PRIORITY_INPUT_PLAYER_AURAS;
+    case PriorityCondition::Type::TARGET_HAS_AURA: return PRIORITY_INPUT_TARGET_AURAS;
+    case PriorityCondition::Type::TARGET_HEALTH_PERCENT_BELOW: return PRIORITY_INPUT_TARGET_HEALTH;
+    case PriorityCondition::Type::PLAYER_HEALTH_PERCENT_BELOW: return PRIORITY_INPUT_PLAYER_HEALTH;
+    case PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_ABOVE:
+    case PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_BELOW: return PRIORITY_INPUT_RESOURCE;
+    case PriorityCondition::Type::TARGET_DISTANCE_BELOW: return PRIORITY_INPUT_TARGET_DISTANCE;
+    default: return 0;
+    }
+}
+
+} // namespace
+
+void PriorityRanker::Build(const RotationProfile& profile, const WorldSnapshot& world) {
+    m_steps.clear();
+    m_playerAuraIds.clear();
+    m_targetAuraIds.clear();
+    m_powerTypes.clear();
+
+    m_steps.resize(profile.steps.size());
+    for (size_t i = 0; i < profile.steps.size(); ++i) {
+        const RotationStep& source = profile.steps[i];
+        StepState& step = m_steps[i];
+        step.basePriority = source.basePriority;
+        for (const auto& pc : source.priorityBoosts) {
+            if (pc.type == PriorityCondition::Type::UNKNOWN) continue;
+            Boost boost;
+            boost.type = static_cast<int>(pc.type);
+            boost.spellId = pc.spellId;
+            boost.threshold = pc.thresholdValue;
+            boost.resourceType = pc.resourceType;
+            boost.distance = pc.distanceThreshold;
+            boost.boost = pc.priorityBoost;
+            step.boosts.push_back(boost);
+            step.dependencies |= DependencyOf(pc.type);
+
+            if (pc.type == PriorityCondition::Type::PLAYER_HAS_AURA) m_playerAuraIds.push_back(pc.spellId);
+            if (pc.type == PriorityCondition::Type::TARGET_HAS_AURA) m_targetAuraIds.push_back(pc.spellId);
+            if (pc.type == PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_ABOVE ||
+                pc.type == PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_BELOW) {
+                m_powerTypes.push_back(pc.resourceType);
+            }
+        }
+    }
+    auto dedupe = [](auto& v) {
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    };
+    dedupe(m_playerAuraIds);
+    dedupe(m_targetAuraIds);
+    dedupe(m_powerTypes);
+
+    for (auto& step : m_steps) step.priority = ComputePriority(step, world);
+    ComputeSignatures(world, m_signatures);
+
+    m_heap.resize(m_steps.size());
+    m_heapPos.resize(m_steps.size());
+    for (size_t i = 0; i < m_steps.size(); ++i) {
+        m_heap[i] = static_cast<int>(i);
+        m_heapPos[i] = i;
+    }
+    for (size_t i = m_heap.size() / 2; i-- > 0;) SiftDown(i);
+    m_forceAll = false;
+}
+
+uint32_t PriorityRanker::Update(const WorldSnapshot& world) {
+    ++m_stats.updates;
+
+    uint64_t signatures[INPUT_COUNT];
+    ComputeSignatures(world, signatures);
+    uint32_t dirty = 0;
+    for (int i = 0; i < INPUT_COUNT; ++i) {
+        if (signatures[i] != m_signatures[i]) dirty |= (1u << i);
+        m_signatures[i] = signatures[i];
+    }
+    if (m_forceAll) {
+        dirty = (1u << INPUT_COUNT) - 1;
+        m_forceAll = false;
+    }
+    if (dirty == 0) {
+        ++m_stats.idleUpdates;
+        return 0;
+    }
+
+    for (size_t i = 0; i < m_steps.size(); ++i) {
+        StepState& step = m_steps[i];
+        if ((step.dependencies & dirty) == 0) continue;
+        int priority = ComputePriority(step, world);
+        ++m_stats.stepsRecomputed;
+        if (priority == step.priority) continue;
+        bool raised = priority > step.priority;
+        step.priority = priority;
+        if (raised) SiftUp(m_heapPos[i]);
+        else SiftDown(m_heapPos[i]);
+    }
+    return dirty;
+}
+
+void PriorityRanker::ForEachInOrder(const std::function<bool(int)>& visitor) const {
+    if (m_heap.empty()) return;
+    // Best-first walk of the heap tree: a node's children can only rank below it
+    auto lower = [this](size_t a, size_t b) { return HigherRank(m_heap[b], m_heap[a]); };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(lower)> frontier(lower);
+    frontier.push(0);
+    while (!frontier.empty()) {
+        size_t pos = frontier.top();
+        frontier.pop();
+        if (!visitor(m_heap[pos])) return;
+        size_t left = 2 * pos + 1;
+        if (left < m_heap.size()) frontier.push(left);
+        if (left + 1 < m_heap.size()) frontier.push(left + 1);
+    }
+}
+
+int PriorityRanker::GetPriority(size_t stepIndex) const {
+    return stepIndex < m_steps.size() ? m_steps[stepIndex].priority : 0;
+}
+
+uint32_t PriorityRanker::GetDependencies(size_t stepIndex) const {
+    return stepIndex < m_steps.size() ? m_steps[stepIndex].dependencies : 0;
+}
+
+void PriorityRanker::ComputeSignatures(const WorldSnapshot& world, uint64_t* out) const {
+    uint64_t targetGuid = world.hasTarget ? world.target.guid : 0;
+
+    out[SIG_PLAYER_AURAS] = AuraPresence(world.player, m_playerAuraIds);
+    out[SIG_TARGET_AURAS] = world.hasTarget ? Mix(targetGuid, AuraPresence(world.target, m_targetAuraIds)) : 0;
+    out[SIG_PLAYER_HEALTH] = static_cast<uint64_t>(static_cast<int64_t>(std::floor(world.player.healthPercent)));
+    out[SIG_TARGET_HEALTH] = world.hasTarget
+        ? Mix(targetGuid, static_cast<uint64_t>(static_cast<int64_t>(std::floor(world.target.healthPercent))))
+        : 0;
+
+    uint64_t resource = 0;
+    for (int powerType : m_powerTypes) {
+        resource = Mix(resource, static_cast<uint64_t>(static_cast<int64_t>(std::floor(world.player.GetPowerPercent(powerType)))));
+    }
+    out[SIG_RESOURCE] = resource;
+
+    if (world.hasTarget) {
+        float distance = std::sqrt(world.player.position.DistanceSq(world.target.position));
+        out[SIG_TARGET_DISTANCE] = Mix(targetGuid, static_cast<uint64_t>(static_cast<int64_t>(distance * 2.0f)));
+    } else {
+        out[SIG_TARGET_DISTANCE] = 0;
+    }
+}
+
+int PriorityRanker::ComputePriority(const StepState& step, const WorldSnapshot& world) const {
+    int priority = step.basePriority;
+    for (const auto& boost : step.boosts) {
+        bool active = false;
+        switch (static_cast<PriorityCondition::Type>(boost.type)) {
+        case PriorityCondition::Type::PLAYER_HAS_AURA:
+            active = world.player.FindAura(boost.spellId) != nullptr;
+            break;
+        case PriorityCondition::Type::TARGET_HAS_AURA:
+            active = world.hasTarget && world.target.FindAura(boost.spellId) != nullptr;
+            break;
+        case PriorityCondition::Type::TARGET_HEALTH_PERCENT_BELOW:
+            active = world.hasTarget && world.target.healthPercent < boost.threshold;
+            break;
+        case PriorityCondition::Type::PLAYER_HEALTH_PERCENT_BELOW:
+            active = world.player.healthPercent < boost.threshold;
+            break;
+        case PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_ABOVE:
+            active = world.player.GetPowerPercent(boost.resourceType) > boost.threshold;
+            break;
+        case PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_BELOW:
+            active = world.player.GetPowerPercent(boost.resourceType) < boost.threshold;
+            break;
+        case PriorityCondition::Type::TARGET_DISTANCE_BELOW:
+            active = world.hasTarget &&
+                     world.player.position.DistanceSq(world.target.position) < boost.distance * boost.distance;
+            break;
+        default:
+            break;
+        }
+        if (active) priority += boost.boost;
+    }
+    return priority;
+}
+
+bool PriorityRanker::HigherRank(int a, int b) const {
+    const StepState& sa = m_steps[a];
+    const StepState& sb = m_steps[b];
+    if (sa.priority != sb.priority) return sa.priority > sb.priority;
+    return a < b; // Profile order breaks ties
+}
+
+void PriorityRanker::Swap(size_t a, size_t b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_heapPos[m_heap[a]] = a;
+    m_heapPos[m_heap[b]] = b;
+}
+
+void PriorityRanker::SiftUp(size_t heapPos) {
+    while (heapPos > 0) {
+        size_t parent = (heapPos - 1) / 2;
+        if (!HigherRank(m_heap[heapPos], m_heap[parent])) break;
+        Swap(heapPos, parent);
+        heapPos = parent;
+    }
+}
+
+void PriorityRanker::SiftDown(size_t heapPos) {
+    for (;;) {
+        size_t best = heapPos;
+        size_t left = 2 * heapPos + 1;
+        size_t right = left + 1;
+        if (left < m_heap.size() && HigherRank(m_heap[left], m_heap[best])) best = left;
+        if (right < m_heap.size() && HigherRank(m_heap[right], m_heap[best])) best = right;
+        if (best == heapPos) return;
+        Swap(heapPos, best);
+        heapPos = best;
+    }
+}
+
+} // namespace Rotation
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "WorldSnapshot.h"
+
+namespace Rotation {
+
+struct RotationProfile;
+struct PriorityCondition;
+
+// Inputs a PriorityCondition can depend on
+enum PriorityInput : uint32_t {
+    PRIORITY_INPUT_PLAYER_AURAS    = 1 << 0, // Presence of the aura ids referenced by PLAYER_HAS_AURA boosts
+    PRIORITY_INPUT_TARGET_AURAS    = 1 << 1, // Same for TARGET_HAS_AURA (and the target GUID)
+    PRIORITY_INPUT_PLAYER_HEALTH   = 1 << 2, // Player health, 1% buckets
+    PRIORITY_INPUT_TARGET_HEALTH   = 1 << 3, // Target GUID + health, 1% buckets
+    PRIORITY_INPUT_RESOURCE        = 1 << 4, // Referenced power types, 1% buckets
+    PRIORITY_INPUT_TARGET_DISTANCE = 1 << 5  // Target GUID + distance, 0.5 yard buckets
+};
+
+/**
+ * Keeps the steps of a profile ranked by basePriority + active priorityBoosts.
+ * Each boost depends on a subset of the inputs above. Update() recomputes a signature per input
+ * and only re-evaluates the steps whose inputs changed, restoring their position in an indexed
+ * max-heap. A tick where nothing relevant changed costs one signature pass and no re-ranking.
+ *
+ * Not thread-safe; owned by whoever runs the rotation loop.
+ */
+class PriorityRanker {
+public:
+    /**
+     * Copy the priority data of a profile and rank every step against the snapshot
+     * @param profile Profile to rank (steps are referenced by index)
+     * @param world Current snapshot
+     */
+    void Build(const RotationProfile& profile, const WorldSnapshot& world);
+
+    /**
+     * Re-rank the steps whose inputs changed since the last call
+     * @param world Current snapshot
+     * @return Mask of PriorityInput bits that changed (0 = nothing re-ranked)
+     */
+    uint32_t Update(const WorldSnapshot& world);
+
+    /**
+     * Force every step to be recomputed on the next Update (e.g. after a settings change)
+     */
+    void Invalidate() { m_forceAll = true; }
+
+    /**
+     * @return Step index with the highest priority, or -1 if the profile has no steps
+     */
+    int Top() const { return m_heap.empty() ? -1 : m_heap[0]; }
+
+    /**
+     * Visit steps from highest to lowest priority without modifying the heap.
+     * Costs O(k log k) for the first k steps visited.
+     * @param visitor Called with the step index; return false to stop
+     */
+    void ForEachInOrder(const std::function<bool(int)>& visitor) const;
+
+    /**
+     * @param stepIndex Index into RotationProfile::steps
+     * @return Current calculated priority (basePriority + active boosts)
+     */
+    int GetPriority(size_t stepIndex) const;
+
+    /**
+     * @param stepIndex Index into RotationProfile::steps
+     * @return PriorityInput mask the step's boosts depend on
+     */
+    uint32_t GetDependencies(size_t stepIndex) const;
+
+    size_t Size() const { return m_steps.size(); }
+
+    struct Stats {
+        uint64_t updates = 0;
+        uint64_t idleUpdates = 0;      // Updates where no input changed
+        uint64_t stepsRecomputed = 0;
+    };
+    Stats GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = Stats(); }
+
+private:
+    struct Boost {
+        int type = 0;          // PriorityCondition::Type
+        uint32_t spellId = 0;
+        float threshold = 0.0f;
+        int resourceType = 0;
+        float distance = 0.0f;
+        int boost = 0;         // Priority added while active
+    };
+    struct StepState {
+        int basePriority = 0;
+        int priority = 0;
+        uint32_t dependencies = 0;
+        std::vector<Boost> boosts;
+    };
+
+    static constexpr int INPUT_COUNT = 6;
+
+    void ComputeSignatures(const WorldSnapshot& world, uint64_t* out) const;
+    int ComputePriority(const StepState& step, const WorldSnapshot& world) const;
+    bool HigherRank(int a, int b) const;
+    void SiftUp(size_t heapPos);
+    void SiftDown(size_t heapPos);
+    void Swap(size_t a, size_t b);
+
+    std::vector<StepState> m_steps;
+    std::vector<int> m_heap;      // Step indices, max-heap by priority
+    std::vector<size_t> m_heapPos; // Step index -> position in m_heap
+    std::vector<uint32_t> m_playerAuraIds;
+    std::vector<uint32_t> m_targetAuraIds;
+    std::vector<int> m_powerTypes;
+    uint64_t m_signatures[INPUT_COUNT] = { 0 };
+    bool m_forceAll = true;
+    Stats m_stats;
+};
+
+} // namespace Rotation
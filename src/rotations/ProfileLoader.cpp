@@ -0,0 +1,651 @@
+#include "ProfileLoader.h"
+#include "../types/Rotation.h"
+#include "../spells/spellinfo.h"
+#include "../logs/log.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <type_traits>
+
+namespace fs = std::filesystem;
+
+namespace Rotation {
+
+namespace {
+
+constexpr uint32_t SIDECAR_MAGIC = 0x31435052; // "RPC1"
+// Bump whenever the serialized layout or the JSON mapping changes
+constexpr uint32_t SIDECAR_VERSION = 3;
+constexpr const char* SIDECAR_DIR = ".cache";
+constexpr const char* SIDECAR_EXT = ".rpc";
+
+#pragma pack(push, 1)
+struct SidecarHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t pathHash;    // FNV-1a of the JSON path
+    int64_t lastWrite;    // JSON file_time_type ticks
+    uint64_t fileSize;    // JSON size in bytes
+    uint32_t payloadSize;
+};
+#pragma pack(pop)
+
+uint64_t HashPath(const std::string& path) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : path) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::time_t ToTimeT(fs::file_time_type ft) {
+    // No clock_cast in C++17: shift by the offset between the two clocks
+    auto system = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        ft - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+    return std::chrono::system_clock::to_time_t(system);
+}
+
+// --- Binary writer / bounds-checked reader for the sidecar payload ---
+
+class Writer {
+public:
+    explicit Writer(std::string& out) : m_out(out) {}
+
+    template <typename T>
+    void Put(T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "POD only");
+        m_out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void PutString(const std::string& s) {
+        Put(static_cast<uint32_t>(s.size()));
+        m_out.append(s);
+    }
+
+private:
+    std::string& m_out;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    template <typename T>
+    bool Get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "POD only");
+        if (m_size - m_pos < sizeof(T)) return false;
+        std::memcpy(&value, m_data + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+    bool GetString(std::string& s) {
+        uint32_t length = 0;
+        if (!Get(length) || m_size - m_pos < length) return false;
+        s.assign(reinterpret_cast<const char*>(m_data + m_pos), length);
+        m_pos += length;
+        return true;
+    }
+    // Element count, rejecting counts that cannot fit in the remaining bytes
+    bool GetCount(uint32_t& count, size_t minElementSize) {
+        return Get(count) && static_cast<uint64_t>(count) * minElementSize <= m_size - m_pos;
+    }
+    bool AtEnd() const { return m_pos == m_size; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+};
+
+// --- JSON mapping (RotationCreator schema) ---
+
+TargetType ParseTargetType(const std::string& s) {
+    if (s == "Self") return TargetType::SELF;
+    if (s == "Friendly") return TargetType::FRIENDLY;
+    if (s == "SelfOrFriendly") return TargetType::SELF_OR_FRIENDLY;
+    if (s == "Any") return TargetType::ANY;
+    if (s == "None") return TargetType::NONE;
+    if (s == "EnemyCluster") return TargetType::ENEMY_CLUSTER;
+    if (s == "GroundCluster") return TargetType::GROUND_CLUSTER;
+    return TargetType::ENEMY;
+}
+
+uint8_t ParsePowerType(const std::string& s) {
+    int powerType = PowerTypeFromResource(s);
+    return powerType >= 0 ? static_cast<uint8_t>(powerType) : static_cast<uint8_t>(POWER_TYPE_MANA);
+}
+
+AuraUnit ParseAuraUnit(const std::string& s) {
+    if (s == "Player") return AuraUnit::PLAYER;
+    if (s == "Target") return AuraUnit::TARGET;
+    if (s == "Focus") return AuraUnit::FOCUS;
+    if (s == "Friendly" || s == "SelfOrFriendly") return AuraUnit::FRIENDLY;
+    return AuraUnit::DEFAULT;
+}
+
+// Range used when a condition has no "meleeRangeValue" (same defaults as RotationCompiler)
+float DefaultConditionRange(Condition::Type type) {
+    switch (type) {
+    case Condition::Type::MELEE_UNITS_AROUND_PLAYER_GREATER_THAN: return 5.0f;
+    case Condition::Type::UNITS_IN_FRONTAL_CONE_GT: return 8.0f;
+    default: return 0.0f;
+    }
+}
+
+Condition::Type ParseConditionType(const std::string& s) {
+    static const std::pair<const char*, Condition::Type> table[] = {
+        { "HEALTH_PERCENT_BELOW", Condition::Type::HEALTH_PERCENT_BELOW },
+        { "MANA_PERCENT_ABOVE", Condition::Type::MANA_PERCENT_ABOVE },
+        { "TARGET_IS_CASTING", Condition::Type::TARGET_IS_CASTING },
+        { "PLAYER_HAS_AURA", Condition::Type::PLAYER_HAS_AURA },
+        { "TARGET_HAS_AURA", Condition::Type::TARGET_HAS_AURA },
+        { "PLAYER_MISSING_AURA", Condition::Type::PLAYER_MISSING_AURA },
+        { "TARGET_MISSING_AURA", Condition::Type::TARGET_MISSING_AURA },
+        { "SPELL_OFF_COOLDOWN", Condition::Type::SPELL_OFF_COOLDOWN },
+        { "SPELL_NOT_ON_COOLDOWN", Condition::Type::SPELL_NOT_ON_COOLDOWN },
+        { "MELEE_UNITS_AROUND_PLAYER_GREATER_THAN", Condition::Type::MELEE_UNITS_AROUND_PLAYER_GREATER_THAN },
+        { "UNITS_IN_FRONTAL_CONE_GT", Condition::Type::UNITS_IN_FRONTAL_CONE_GT },
+        { "PLAYER_THREAT_ON_TARGET_BELOW_PERCENT", Condition::Type::PLAYER_THREAT_ON_TARGET_BELOW_PERCENT },
+        { "SPELL_HAS_CHARGES", Condition::Type::SPELL_HAS_CHARGES },
+        { "PLAYER_IS_FACING_TARGET", Condition::Type::PLAYER_IS_FACING_TARGET },
+        { "COMBO_POINTS_GREATER_THAN_OR_EQUAL_TO", Condition::Type::COMBO_POINTS_GREATER_THAN_OR_EQUAL_TO },
+    };
+    for (const auto& entry : table) {
+        if (s == entry.first) return entry.second;
+    }
+    return Condition::Type::UNKNOWN;
+}
+
+PriorityCondition::Type ParsePriorityType(const std::string& s) {
+    if (s == "PLAYER_HAS_AURA") return PriorityCondition::Type::PLAYER_HAS_AURA;
+    if (s == "TARGET_HAS_AURA") return PriorityCondition::Type::TARGET_HAS_AURA;
+    if (s == "TARGET_HEALTH_PERCENT_BELOW") return PriorityCondition::Type::TARGET_HEALTH_PERCENT_BELOW;
+    if (s == "PLAYER_HEALTH_PERCENT_BELOW") return PriorityCondition::Type::PLAYER_HEALTH_PERCENT_BELOW;
+    if (s == "PLAYER_RESOURCE_PERCENT_ABOVE") return PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_ABOVE;
+    if (s == "PLAYER_RESOURCE_PERCENT_BELOW") return PriorityCondition::Type::PLAYER_RESOURCE_PERCENT_BELOW;
+    if (s == "TARGET_DISTANCE_BELOW") return PriorityCondition::Type::TARGET_DISTANCE_BELOW;
+    return PriorityCondition::Type::UNKNOWN;
+}
+
+Condition ParseCondition(const nlohmann::json& j) {
+    Condition c;
+    c.type = ParseConditionType(j.at("type").get<std::string>());
+    c.value = j.value("value", 0.0f);
+    c.targetIsPlayer = j.value("targetIsPlayer", false);
+    c.targetIsFriendly = j.value("targetIsFriendly", false);
+    c.spellId = j.value("spellId", 0u);
+    if (j.contains("multiAuraIds")) j.at("multiAuraIds").get_to(c.multiAuraIds);
+    if (j.value("multiAuraLogic", std::string("ANY_OF")) == "ALL_OF") c.multiAuraLogic = AuraConditionLogic::ALL_OF;
+    c.casterGuid = j.value("casterGuid", 0ULL);
+    c.minStacks = j.value("minStacks", 0);
+    c.auraTarget = ParseAuraUnit(j.value("auraTarget", std::string()));
+    c.range = j.value("meleeRangeValue", DefaultConditionRange(c.type));
+    c.coneAngle = j.value("coneAngleDegrees", 90.0f);
+    c.facingConeAngle = j.value("facingConeAngle", 60.0f);
+    return c;
+}
+
+// Legacy {auraIds, logic, target, presence, minStacks}
+Condition ParseLegacyAuraCondition(const nlohmann::json& j) {
+    Condition c;
+    std::vector<uint32_t> ids;
+    if (j.contains("auraId") && j.at("auraId").is_number_integer()) ids.push_back(j.at("auraId").get<uint32_t>());
+    else if (j.contains("auraIds")) j.at("auraIds").get_to(ids);
+
+    bool onPlayer = j.value("target", std::string("Player")) == "Player";
+    bool presence = j.value("presence", true);
+    if (onPlayer) c.type = presence ? Condition::Type::PLAYER_HAS_AURA : Condition::Type::PLAYER_MISSING_AURA;
+    else c.type = presence ? Condition::Type::TARGET_HAS_AURA : Condition::Type::TARGET_MISSING_AURA;
+
+    if (ids.size() == 1) c.spellId = ids[0];
+    else c.multiAuraIds = std::move(ids);
+    if (j.value("logic", std::string("ANY_OF")) == "ALL_OF") c.multiAuraLogic = AuraConditionLogic::ALL_OF;
+    c.minStacks = j.value("minStacks", 0);
+    return c;
+}
+
+// Legacy {target, percent}
+Condition ParseLegacyHealthCondition(const nlohmann::json& j) {
+    Condition c;
+    c.type = Condition::Type::HEALTH_PERCENT_BELOW;
+    c.targetIsPlayer = j.value("target", std::string("Target")) == "Player";
+    c.value = j.value("percent", 50.0f);
+    return c;
+}
+
+PriorityCondition ParsePriorityCondition(const nlohmann::json& j) {
+    PriorityCondition pc;
+    pc.type = ParsePriorityType(j.at("type").get<std::string>());
+    pc.spellId = j.value("auraId", 0u);
+    pc.thresholdValue = j.value("thresholdValue", 0.0f);
+    pc.priorityBoost = j.value("priorityBoost", 50);
+    pc.resourceType = ParsePowerType(j.value("resourceType", std::string("Mana")));
+    pc.distanceThreshold = j.value("distanceThreshold", 0.0f);
+    return pc;
+}
+
+RotationStep ParseStep(const nlohmann::json& j) {
+    RotationStep step;
+    step.spellId = j.at("id").get<uint32_t>();
+    step.name = j.at("name").get<std::string>();
+
+    if (j.contains("range")) {
+        const auto& range = j.at("range");
+        if (range.is_number()) {
+            step.maxRange = range.get<float>();
+        } else if (range.is_object()) {
+            step.minRange = range.value("min", 0.0f);
+            step.maxRange = range.value("max", 0.0f);
+        }
+    }
+    step.resourceType = j.value("resourceType", std::string("Mana"));
+    step.manaCost = (step.resourceType == "None") ? 0 : j.value("resourceCost", 0);
+    step.castTime = j.value("castTime", 0.0f);
+    step.isChannel = j.value("isChanneled", false);
+    step.targetType = ParseTargetType(j.value("targetType", std::string("Enemy")));
+    step.requiresTarget = j.value("requiresTarget", true);
+    step.basePriority = j.value("basePriority", 10);
+    step.castableWhileMoving = j.value("castableWhileMoving", false);
+    step.baseDamage = j.value("baseDamage", 0);
+    step.maxCharges = j.value("maxCharges", 1);
+    step.rechargeTime = j.value("rechargeTime", 0.0f);
+    step.isHeal = j.value("isHeal", false);
+    step.aoeRadius = j.value("aoeRadius", 8.0f);
+    step.aoeMinCount = j.value("aoeMinCount", 3);
+
+    if (j.contains("priorityBoosts")) {
+        for (const auto& pc : j.at("priorityBoosts")) step.priorityBoosts.push_back(ParsePriorityCondition(pc));
+    }
+    if (j.contains("conditions")) {
+        for (const auto& c : j.at("conditions")) step.conditions.push_back(ParseCondition(c));
+    }
+    if (j.contains("auraConditions")) {
+        for (const auto& c : j.at("auraConditions")) step.conditions.push_back(ParseLegacyAuraCondition(c));
+    }
+    if (j.contains("healthConditions")) {
+        for (const auto& c : j.at("healthConditions")) step.conditions.push_back(ParseLegacyHealthCondition(c));
+    }
+    return step;
+}
+
+bool ReadSidecar(const std::string& sidecar, uint64_t pathHash, int64_t lastWrite, uint64_t fileSize, RotationProfile& out) {
+    Spells::MappedFile mapped;
+    if (!mapped.Open(sidecar) || mapped.Size() < sizeof(SidecarHeader)) return false;
+
+    SidecarHeader header;
+    std::memcpy(&header, mapped.Data(), sizeof(header));
+    if (header.magic != SIDECAR_MAGIC || header.version != SIDECAR_VERSION) return false;
+    if (header.pathHash != pathHash || header.lastWrite != lastWrite || header.fileSize != fileSize) return false;
+    if (header.payloadSize != mapped.Size() - sizeof(SidecarHeader)) return false;
+    return ProfileLoader::DeserializeProfile(mapped.Data() + sizeof(SidecarHeader), header.payloadSize, out);
+}
+
+void WriteSidecar(const std::string& sidecar, uint64_t pathHash, int64_t lastWrite, uint64_t fileSize, const RotationProfile& profile) {
+    std::string payload;
+    ProfileLoader::SerializeProfile(profile, payload);
+
+    SidecarHeader header;
+    header.magic = SIDECAR_MAGIC;
+    header.version = SIDECAR_VERSION;
+    header.pathHash = pathHash;
+    header.lastWrite = lastWrite;
+    header.fileSize = fileSize;
+    header.payloadSize = static_cast<uint32_t>(payload.size());
+
+    std::error_code ec;
+    fs::create_directories(fs::path(sidecar).parent_path(), ec);
+    // Write to a temp file and rename, so a crash never leaves a truncated sidecar behind
+    std::string temp = sidecar + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file) return;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!file) return;
+    }
+    fs::rename(temp, sidecar, ec);
+    if (ec) fs::remove(temp, ec);
+}
+
+} // namespace
+
+ProfileLoader& ProfileLoader::GetInstance() {
+    static ProfileLoader instance;
+    return instance;
+}
+
+std::string ProfileLoader::SidecarPath(const std::string& path) {
+    fs::path json(path);
+    return (json.parent_path() / SIDECAR_DIR / (json.filename().string() + SIDECAR_EXT)).string();
+}
+
+bool ProfileLoader::ParseProfileJson(const nlohmann::json& j, RotationProfile& out, std::string& error) {
+    try {
+        out.name = j.at("name").get<std::string>();
+        out.steps.clear();
+        for (const auto& step : j.at("steps")) out.steps.push_back(ParseStep(step));
+        return true;
+    } catch (const nlohmann::json::exception& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+bool ProfileLoader::LoadProfileFile(const std::string& path, RotationProfile& out, bool& fromCache, std::string& error) {
+    fromCache = false;
+    std::error_code ec;
+    uint64_t fileSize = fs::file_size(path, ec);
+    if (ec) {
+        error = "Cannot stat file: " + ec.message();
+        return false;
+    }
+    fs::file_time_type writeTime = fs::last_write_time(path, ec);
+    if (ec) {
+        error = "Cannot read write time: " + ec.message();
+        return false;
+    }
+    int64_t lastWrite = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    uint64_t pathHash = HashPath(fs::path(path).lexically_normal().string());
+    std::string sidecar = SidecarPath(path);
+
+    if (ReadSidecar(sidecar, pathHash, lastWrite, fileSize, out)) {
+        fromCache = true;
+    } else {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            error = "Cannot open file";
+            return false;
+        }
+        nlohmann::json j = nlohmann::json::parse(file, nullptr, false);
+        if (j.is_discarded()) {
+            error = "Invalid JSON";
+            return false;
+        }
+        if (!ParseProfileJson(j, out, error)) return false;
+        WriteSidecar(sidecar, pathHash, lastWrite, fileSize, out);
+    }
+    out.filePath = path;
+    out.last_modified = ToTimeT(writeTime);
+
+    // Client spell data (cast time, channel, ranges, cost) over the hand-entered step fields. The sidecar
+    // keeps the JSON values. Unknown spells are only resolved from a mapped Spell.dbc: the client DB fallback
+    // is main-thread only (SyncWorkerProgram resolves the running profile there), so without one only the
+    // spells resolved so far are applied.
+    Spells::SpellInfoCache& spellInfo = Spells::SpellInfoCache::GetInstance();
+    spellInfo.ApplyToProfile(out, spellInfo.HasDbcSource());
+    return true;
+}
+
+ProfileLoadReport ProfileLoader::LoadDirectory(const std::string& directory, unsigned maxThreads) {
+    auto start = std::chrono::steady_clock::now();
+    auto msSince = [](std::chrono::steady_clock::time_point from) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - from).count();
+    };
+
+    ProfileLoadReport report;
+    std::vector<std::string> paths;
+    try {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(directory, ec)) {
+            if (entry.is_regular_file(ec) && entry.path().extension() == ".json") paths.push_back(entry.path().string());
+        }
+        if (ec) Core::Log::Message("[ProfileLoader] Cannot scan " + directory + ": " + ec.message());
+    } catch (const std::exception& e) {
+        Core::Log::Message(std::string("[ProfileLoader] Exception scanning directory: ") + e.what());
+    }
+    report.files = paths.size();
+    report.scanMs = msSince(start);
+
+    auto loadStart = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<RotationProfile>> loaded(paths.size());
+    std::vector<char> cached(paths.size(), 0);
+    std::vector<std::string> errors(paths.size());
+    std::atomic<size_t> next{ 0 };
+
+    auto work = [&]() {
+        for (size_t i = next.fetch_add(1); i < paths.size(); i = next.fetch_add(1)) {
+            try {
+                auto profile = std::make_shared<RotationProfile>();
+                bool fromCache = false;
+                if (LoadProfileFile(paths[i], *profile, fromCache, errors[i])) {
+                    loaded[i] = std::move(profile);
+                    cached[i] = fromCache ? 1 : 0;
+                }
+            } catch (const std::exception& e) {
+                errors[i] = e.what();
+            }
+        }
+    };
+
+    unsigned threads = maxThreads ? maxThreads : (std::min)(MAX_LOAD_THREADS, (std::max)(1u, std::thread::hardware_concurrency()));
+    threads = static_cast<unsigned>((std::min)(static_cast<size_t>(threads), paths.size()));
+    report.threads = threads;
+    std::vector<std::thread> pool;
+    try {
+        // The calling thread takes a share too
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    } catch (const std::exception& e) {
+        Core::Log::Message(std::string("[ProfileLoader] Could not start load thread: ") + e.what());
+    }
+    work();
+    for (auto& thread : pool) thread.join();
+    report.loadMs = msSince(loadStart);
+
+    std::vector<std::shared_ptr<const RotationProfile>> profiles;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!loaded[i]) {
+            ++report.failed;
+            Core::Log::Message("[ProfileLoader] Failed to load " + paths[i] + ": " + errors[i]);
+            continue;
+        }
+        if (cached[i]) ++report.cacheHits;
+        else ++report.parsed;
+        profiles.push_back(std::move(loaded[i]));
+    }
+    std::sort(profiles.begin(), profiles.end(), [](const auto& a, const auto& b) { return a->name < b->name; });
+    report.totalMs = msSince(start);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_injectedSet) report.timeToReadyMs = msSince(m_injectedAt);
+    report.engineLoadMs = m_engineLoadMs;
+    m_profiles = std::move(profiles);
+    m_directory = directory;
+    m_lastReport = report;
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "[ProfileLoader] %zu profile(s): %zu from cache, %zu parsed, %zu failed, %u thread(s), %.1f ms + engine load %.1f ms (ready %.1f ms after injection)",
+             report.files, report.cacheHits, report.parsed, report.failed, report.threads, report.totalMs, report.engineLoadMs,
+             report.timeToReadyMs);
+    Core::Log::Message(buffer);
+    return report;
+}
+
+ProfileLoadReport ProfileLoader::ReloadDirectory() {
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        directory = m_directory;
+    }
+    if (directory.empty()) return ProfileLoadReport();
+    return LoadDirectory(directory);
+}
+
+std::vector<std::shared_ptr<const RotationProfile>> ProfileLoader::GetProfiles() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_profiles;
+}
+
+std::vector<std::string> ProfileLoader::GetProfileNames() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> names;
+    names.reserve(m_profiles.size());
+    for (const auto& profile : m_profiles) names.push_back(profile->name);
+    return names;
+}
+
+std::shared_ptr<const RotationProfile> ProfileLoader::FindProfile(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& profile : m_profiles) {
+        if (profile->name == name) return profile;
+    }
+    return nullptr;
+}
+
+void ProfileLoader::RecordEngineLoad(double ms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_engineLoadMs = ms;
+    m_lastReport.engineLoadMs = ms;
+}
+
+ProfileLoadReport ProfileLoader::GetLastReport() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastReport;
+}
+
+void ProfileLoader::ReplaceProfile(std::shared_ptr<const RotationProfile> profile) {
+    if (!profile) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_profiles.begin(), m_profiles.end(),
+                           [&](const auto& existing) { return existing->filePath == profile->filePath; });
+    if (it != m_profiles.end()) *it = std::move(profile);
+    else m_profiles.push_back(std::move(profile));
+    std::sort(m_profiles.begin(), m_profiles.end(), [](const auto& a, const auto& b) { return a->name < b->name; });
+}
+
+bool ProfileLoader::RemoveProfile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_profiles.begin(), m_profiles.end(),
+                           [&](const auto& existing) { return existing->filePath == path; });
+    if (it == m_profiles.end()) return false;
+    m_profiles.erase(it);
+    return true;
+}
+
+void ProfileLoader::SerializeProfile(const RotationProfile& profile, std::string& out) {
+    out.clear();
+    Writer w(out);
+    w.PutString(profile.name);
+    w.Put(static_cast<uint32_t>(profile.steps.size()));
+    for (const auto& step : profile.steps) {
+        w.PutString(step.name);
+        w.Put(step.spellId);
+        w.Put(static_cast<int32_t>(step.targetType));
+        w.Put(static_cast<uint8_t>(step.requiresTarget));
+        w.Put(step.minRange);
+        w.Put(step.maxRange);
+        w.Put(static_cast<int32_t>(step.manaCost));
+        w.PutString(step.resourceType);
+        w.Put(static_cast<int32_t>(step.basePriority));
+        w.Put(static_cast<uint8_t>(step.isChannel));
+        w.Put(step.castTime);
+        w.Put(static_cast<int32_t>(step.maxCharges));
+        w.Put(step.rechargeTime);
+        w.Put(static_cast<uint8_t>(step.isHeal));
+        w.Put(static_cast<int32_t>(step.baseDamage));
+        w.Put(static_cast<uint8_t>(step.castableWhileMoving));
+        w.Put(step.aoeRadius);
+        w.Put(static_cast<int32_t>(step.aoeMinCount));
+
+        w.Put(static_cast<uint32_t>(step.conditions.size()));
+        for (const auto& c : step.conditions) {
+            w.Put(static_cast<int32_t>(c.type));
+            w.Put(c.spellId);
+            w.Put(static_cast<uint32_t>(c.multiAuraIds.size()));
+            for (uint32_t id : c.multiAuraIds) w.Put(id);
+            w.Put(static_cast<int32_t>(c.multiAuraLogic));
+            w.Put(c.casterGuid);
+            w.Put(static_cast<int32_t>(c.minStacks));
+            w.Put(static_cast<uint8_t>(c.auraTarget));
+            w.Put(c.value);
+            w.Put(c.range);
+            w.Put(c.coneAngle);
+            w.Put(c.facingConeAngle);
+            w.Put(static_cast<uint8_t>(c.targetIsPlayer));
+            w.Put(static_cast<uint8_t>(c.targetIsFriendly));
+            w.PutString(c.auraName);
+        }
+
+        w.Put(static_cast<uint32_t>(step.priorityBoosts.size()));
+        for (const auto& pc : step.priorityBoosts) {
+            w.Put(static_cast<int32_t>(pc.type));
+            w.Put(pc.spellId);
+            w.Put(pc.thresholdValue);
+            w.Put(static_cast<int32_t>(pc.priorityBoost));
+            w.Put(pc.resourceType);
+            w.Put(pc.distanceThreshold);
+        }
+    }
+}
+
+bool ProfileLoader::DeserializeProfile(const uint8_t* data, size_t size, RotationProfile& out) {
+    Reader r(data, size);
+    uint32_t stepCount = 0;
+    if (!r.GetString(out.name) || !r.GetCount(stepCount, 4)) return false;
+    out.steps.assign(stepCount, RotationStep());
+
+    for (auto& step : out.steps) {
+        int32_t targetType = 0, manaCost = 0, basePriority = 0, maxCharges = 0, baseDamage = 0, aoeMinCount = 0;
+        uint8_t requiresTarget = 0, isChannel = 0, isHeal = 0, moving = 0;
+        uint32_t conditionCount = 0, boostCount = 0;
+        if (!r.GetString(step.name) || !r.Get(step.spellId) || !r.Get(targetType) || !r.Get(requiresTarget) ||
+            !r.Get(step.minRange) || !r.Get(step.maxRange) || !r.Get(manaCost) || !r.GetString(step.resourceType) ||
+            !r.Get(basePriority) || !r.Get(isChannel) || !r.Get(step.castTime) || !r.Get(maxCharges) ||
+            !r.Get(step.rechargeTime) || !r.Get(isHeal) || !r.Get(baseDamage) || !r.Get(moving) ||
+            !r.Get(step.aoeRadius) || !r.Get(aoeMinCount)) {
+            return false;
+        }
+        step.targetType = static_cast<TargetType>(targetType);
+        step.requiresTarget = requiresTarget != 0;
+        step.manaCost = manaCost;
+        step.basePriority = basePriority;
+        step.isChannel = isChannel != 0;
+        step.maxCharges = maxCharges;
+        step.isHeal = isHeal != 0;
+        step.baseDamage = baseDamage;
+        step.castableWhileMoving = moving != 0;
+        step.aoeMinCount = aoeMinCount;
+
+        if (!r.GetCount(conditionCount, 4)) return false;
+        step.conditions.assign(conditionCount, Condition());
+        for (auto& c : step.conditions) {
+            int32_t type = 0, logic = 0, minStacks = 0;
+            uint32_t auraCount = 0;
+            uint8_t auraTarget = 0, targetIsPlayer = 0, targetIsFriendly = 0;
+            if (!r.Get(type) || !r.Get(c.spellId) || !r.GetCount(auraCount, sizeof(uint32_t))) return false;
+            c.multiAuraIds.resize(auraCount);
+            for (uint32_t& id : c.multiAuraIds) {
+                if (!r.Get(id)) return false;
+            }
+            if (!r.Get(logic) || !r.Get(c.casterGuid) || !r.Get(minStacks) || !r.Get(auraTarget) || !r.Get(c.value) || !r.Get(c.range) ||
+                !r.Get(c.coneAngle) || !r.Get(c.facingConeAngle) || !r.Get(targetIsPlayer) ||
+                !r.Get(targetIsFriendly) || !r.GetString(c.auraName)) {
+                return false;
+            }
+            c.type = static_cast<Condition::Type>(type);
+            c.multiAuraLogic = static_cast<AuraConditionLogic>(logic);
+            c.minStacks = minStacks;
+            c.auraTarget = static_cast<AuraUnit>(auraTarget);
+            c.targetIsPlayer = targetIsPlayer != 0;
+            c.targetIsFriendly = targetIsFriendly != 0;
+        }
+
+        if (!r.GetCount(boostCount, 4)) return false;
+        step.priorityBoosts.assign(boostCount, PriorityCondition());
+        for (auto& pc : step.priorityBoosts) {
+            int32_t type = 0, boost = 0;
+            if (!r.Get(type) || !r.Get(pc.spellId) || !r.Get(pc.thresholdValue) || !r.Get(boost) ||
+                !r.Get(pc.resourceType) || !r.Get(pc.distanceThreshold)) {
+                return false;
+            }
+            pc.type = static_cast<PriorityCondition::Type>(type);
+            pc.priorityBoost = boost;
+        }
+    }
+    return r.AtEnd();
+}
+
+} // namespace Rotation
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+namespace Rotation {
+
+struct RotationProfile;
+
+// Outcome of one LoadDirectory call
+struct ProfileLoadReport {
+    size_t files = 0;        // *.json files found
+    size_t cacheHits = 0;    // Loaded from an up-to-date sidecar
+    size_t parsed = 0;       // Parsed from JSON (sidecar missing or stale)
+    size_t failed = 0;
+    unsigned threads = 0;
+    double scanMs = 0.0;     // Directory scan + stat
+    double loadMs = 0.0;     // Parallel load phase
+    double totalMs = 0.0;
+    double engineLoadMs = 0.0;  // RotationEngine's own serial load of the same directory (RecordEngineLoad)
+    double timeToReadyMs = 0.0; // Since MarkInjected() (covers both loads), 0 if it was never called
+};
+
+/**
+ * Loads every rotation profile of a directory on a small thread pool.
+ * Each parsed profile is written to a binary sidecar in <dir>/.cache, keyed by the JSON file's path,
+ * last write time and size; an unchanged profile is then restored from one mapped read of its
+ * sidecar instead of a DOM parse.
+ *
+ * Loaded profiles are immutable and shared; a reload replaces the whole set.
+ */
+class ProfileLoader {
+public:
+    static constexpr unsigned MAX_LOAD_THREADS = 4;
+
+    static ProfileLoader& GetInstance();
+
+    /**
+     * Remember the injection time so LoadDirectory can report time-to-ready
+     */
+    void MarkInjected() { m_injectedAt = std::chrono::steady_clock::now(); m_injectedSet = true; }
+
+    /**
+     * Duration of RotationEngine's own load of the directory. The engine still parses its copy of every
+     * profile (selection and Start look profiles up there), so that pass counts toward load time too.
+     * Kept in the last report and in every following one.
+     * @param ms Milliseconds
+     */
+    void RecordEngineLoad(double ms);
+
+    /**
+     * Scan a directory for *.json profiles and load them in parallel
+     * @param directory Rotations directory
+     * @param maxThreads Worker threads (0 = min(hardware threads, MAX_LOAD_THREADS))
+     * @return Load report (also kept for GetLastReport)
+     */
+    ProfileLoadReport LoadDirectory(const std::string& directory, unsigned maxThreads = 0);
+
+    /**
+     * Load the directory of the last LoadDirectory call again (e.g. "Reload All Rotations")
+     * @return Load report (empty if LoadDirectory was never called)
+     */
+    ProfileLoadReport ReloadDirectory();
+
+    /**
+     * @return Profiles of the last LoadDirectory call, sorted by name
+     */
+    std::vector<std::shared_ptr<const RotationProfile>> GetProfiles() const;
+
+    /**
+     * @return Names of the loaded profiles, sorted (for the rotation selection list)
+     */
+    std::vector<std::string> GetProfileNames() const;
+
+    /**
+     * @param name Profile name
+     * @return Profile or nullptr
+     */
+    std::shared_ptr<const RotationProfile> FindProfile(const std::string& name) const;
+
+    ProfileLoadReport GetLastReport() const;
+
+    /**
+     * Insert or replace (matched by filePath) a single profile, e.g. after a hot reload
+     * @param profile Newly loaded profile
+     */
+    void ReplaceProfile(std::shared_ptr<const RotationProfile> profile);
+
+    /**
+     * @param path JSON file whose profile should be dropped (file deleted)
+     * @return true if a profile was removed
+     */
+    bool RemoveProfile(const std::string& path);
+
+    /**
+     * Convert a RotationCreator JSON document (see RotationCreator/src/SpellData.h) to a profile.
+     * Legacy auraConditions/healthConditions are folded into conditions.
+     * Keep in step with RotationParser, which maps the same documents for RotationEngine.
+     * @param j JSON document
+     * @param out Profile (filePath and last_modified are left untouched)
+     * @param error Reason on failure
+     * @return true on success
+     */
+    static bool ParseProfileJson(const nlohmann::json& j, RotationProfile& out, std::string& error);
+
+    /**
+     * Load one profile, from its sidecar when it is up to date, otherwise from JSON (rewriting the sidecar).
+     * Steps are then updated with client spell data (SpellInfoCache::ApplyToProfile): resolved from Spell.dbc
+     * when one is mapped, otherwise only the spells the main thread already resolved.
+     * @param path JSON file
+     * @param out Profile
+     * @param fromCache Set to true if the sidecar was used
+     * @param error Reason on failure
+     * @return true on success
+     */
+    static bool LoadProfileFile(const std::string& path, RotationProfile& out, bool& fromCache, std::string& error);
+
+    /**
+     * @param path JSON file
+     * @return Sidecar path for it
+     */
+    static std::string SidecarPath(const std::string& path);
+
+    /**
+     * Binary (de)serialization used by the sidecar
+     */
+    static void SerializeProfile(const RotationProfile& profile, std::string& out);
+    static bool DeserializeProfile(const uint8_t* data, size_t size, RotationProfile& out);
+
+private:
+    ProfileLoader() = default;
+    ProfileLoader(const ProfileLoader&) = delete;
+    ProfileLoader& operator=(const ProfileLoader&) = delete;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<const RotationProfile>> m_profiles;
+    std::string m_directory;
+    ProfileLoadReport m_lastReport;
+    double m_engineLoadMs = 0.0;
+    std::chrono::steady_clock::time_point m_injectedAt;
+    bool m_injectedSet = false;
+};
+
+} // namespace Rotation
@@ -0,0 +1,176 @@
+#include "ProfileWatcher.h"
+#include "ProfileLoader.h"
+#include "RotationCompiler.h"
+#include "RotationWorker.h"
+#include "../types/Rotation.h"
+#include "../logs/log.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Rotation {
+
+namespace {
+
+// Current *.json files of a directory with their write time and size
+std::map<std::string, std::pair<int64_t, uint64_t>> ScanDirectory(const std::string& directory) {
+    std::map<std::string, std::pair<int64_t, uint64_t>> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != ".json") continue;
+        auto writeTime = entry.last_write_time(ec);
+        if (ec) continue;
+        auto size = entry.file_size(ec);
+        if (ec) continue;
+        files[entry.path().string()] = { static_cast<int64_t>(writeTime.time_since_epoch().count()), static_cast<uint64_t>(size) };
+    }
+    return files;
+}
+
+} // namespace
+
+ProfileWatcher::ProfileWatcher(RotationWorker& worker) : m_worker(worker) {}
+
+ProfileWatcher::~ProfileWatcher() {
+    Stop();
+}
+
+void ProfileWatcher::Start(const std::string& directory) {
+    if (m_running.exchange(true)) return;
+    m_directory = directory;
+    // Baseline: whatever is on disk now was loaded at startup
+    m_files.clear();
+    for (const auto& file : ScanDirectory(directory)) {
+        FileStamp stamp;
+        stamp.lastWrite = file.second.first;
+        stamp.size = file.second.second;
+        m_files[file.first] = stamp;
+    }
+    try {
+        m_thread = std::thread(&ProfileWatcher::Run, this);
+        Core::Log::Message("[ProfileWatcher] Watching " + directory + " (" + std::to_string(m_files.size()) + " profile(s)).");
+    } catch (const std::exception& e) {
+        m_running = false;
+        Core::Log::Message(std::string("[ProfileWatcher] Failed to start thread: ") + e.what());
+    }
+}
+
+void ProfileWatcher::Stop() {
+    if (!m_running.exchange(false)) return;
+    m_wakeCv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+    Core::Log::Message("[ProfileWatcher] Stopped.");
+}
+
+void ProfileWatcher::SetPollInterval(int ms) {
+    m_pollMs = (std::max)(MIN_POLL_MS, (std::min)(MAX_POLL_MS, ms));
+}
+
+ProfileWatcher::Stats ProfileWatcher::GetStats() const {
+    Stats stats;
+    stats.polls = m_statPolls.load(std::memory_order_relaxed);
+    stats.reloads = m_statReloads.load(std::memory_order_relaxed);
+    stats.failures = m_statFailures.load(std::memory_order_relaxed);
+    stats.programSwaps = m_statSwaps.load(std::memory_order_relaxed);
+    stats.lastReloadMs = m_statLastReloadMs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ProfileWatcher::Run() {
+    while (m_running.load()) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCv.wait_for(lock, std::chrono::milliseconds(m_pollMs.load()), [this] { return !m_running.load(); });
+        }
+        if (!m_running.load()) break;
+        if (!m_enabled.load()) continue;
+
+        try {
+            Poll();
+        } catch (const std::exception& e) {
+            Core::Log::Message(std::string("[ProfileWatcher] Exception during poll: ") + e.what());
+        }
+    }
+}
+
+void ProfileWatcher::Poll() {
+    m_statPolls.fetch_add(1, std::memory_order_relaxed);
+    auto current = ScanDirectory(m_directory);
+
+    std::vector<std::string> toReload;
+    for (const auto& file : current) {
+        FileStamp now;
+        now.lastWrite = file.second.first;
+        now.size = file.second.second;
+
+        auto it = m_files.find(file.first);
+        if (it == m_files.end()) {
+            now.pending = true; // New file, settle for one poll
+            m_files[file.first] = now;
+            continue;
+        }
+        FileStamp& known = it->second;
+        if (!(known == now)) {
+            known = now;
+            known.pending = true; // Still being written? Wait for the stamp to hold
+        } else if (known.pending) {
+            known.pending = false;
+            toReload.push_back(file.first);
+        }
+    }
+
+    // Deleted files
+    for (auto it = m_files.begin(); it != m_files.end();) {
+        if (current.count(it->first)) {
+            ++it;
+            continue;
+        }
+        if (ProfileLoader::GetInstance().RemoveProfile(it->first)) {
+            Core::Log::Message("[ProfileWatcher] Profile removed: " + it->first);
+            if (m_callback) m_callback(it->first, nullptr);
+        }
+        it = m_files.erase(it);
+    }
+
+    for (const auto& path : toReload) Reload(path);
+}
+
+void ProfileWatcher::Reload(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto profile = std::make_shared<RotationProfile>();
+    bool fromCache = false;
+    std::string error;
+    if (!ProfileLoader::LoadProfileFile(path, *profile, fromCache, error)) {
+        // Keep running the previous version; the next save retries
+        m_statFailures.fetch_add(1, std::memory_order_relaxed);
+        Core::Log::Message("[ProfileWatcher] Reload of " + path + " failed, keeping the previous version: " + error);
+        return;
+    }
+    std::shared_ptr<const RotationProfile> loaded = profile;
+    ProfileLoader::GetInstance().ReplaceProfile(loaded);
+
+    // Recompile here, off the render and decision threads, then swap in one atomic store
+    bool swapped = false;
+    auto running = m_worker.GetProgram();
+    if (running && running->profileName == loaded->name) {
+        m_worker.InstallProfile(*loaded);
+        swapped = true;
+        m_statSwaps.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (m_callback) m_callback(path, loaded);
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_statLastReloadMs.store(elapsedMs, std::memory_order_relaxed);
+    m_statReloads.fetch_add(1, std::memory_order_relaxed);
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "[ProfileWatcher] Reloaded '%s' (%zu steps) in %.2f ms%s",
+             loaded->name.c_str(), loaded->steps.size(), elapsedMs, swapped ? ", running program swapped" : "");
+    Core::Log::Message(buffer);
+}
+
+} // namespace Rotation
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Rotation {
+
+struct RotationProfile;
+class RotationWorker;
+
+/**
+ * Background hot reload of rotation profiles.
+ * Polls the rotations directory and compares each *.json file's write time and size with the last
+ * pass. A changed file is reloaded on its own once its stamp has held for one poll (so a file still
+ * being written by RotationCreator is not read half way), recompiled on the watcher thread and, if
+ * it is the profile the RotationWorker is running, swapped in with RotationWorker::SetProgram.
+ * The rotation keeps running on the old program until the swap; nothing is paused.
+ */
+class ProfileWatcher {
+public:
+    static constexpr int DEFAULT_POLL_MS = 500;
+    static constexpr int MIN_POLL_MS = 100;
+    static constexpr int MAX_POLL_MS = 10000;
+
+    // Called on the watcher thread after a profile was reloaded (nullptr profile = file deleted)
+    using ReloadCallback = std::function<void(const std::string& path, std::shared_ptr<const RotationProfile> profile)>;
+
+    explicit ProfileWatcher(RotationWorker& worker);
+    ~ProfileWatcher();
+
+    ProfileWatcher(const ProfileWatcher&) = delete;
+    ProfileWatcher& operator=(const ProfileWatcher&) = delete;
+
+    /**
+     * Start watching a directory. Files already present are taken as loaded (see ProfileLoader).
+     * @param directory Rotations directory
+     */
+    void Start(const std::string& directory);
+    void Stop();
+    bool IsRunning() const { return m_running.load(); }
+
+    void SetPollInterval(int ms);
+    int GetPollInterval() const { return m_pollMs.load(); }
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled.load(); }
+
+    /**
+     * Let the owner of the rotation state (e.g. RotationEngine) pick up reloaded profiles. Set before Start().
+     */
+    void SetReloadCallback(ReloadCallback callback) { m_callback = std::move(callback); }
+
+    struct Stats {
+        uint64_t polls = 0;
+        uint64_t reloads = 0;
+        uint64_t failures = 0;       // Parse errors; the previous version stays active
+        uint64_t programSwaps = 0;   // Reloads that replaced the worker's running program
+        double lastReloadMs = 0.0;   // Parse + compile time of the last reload
+    };
+    Stats GetStats() const;
+
+private:
+    struct FileStamp {
+        int64_t lastWrite = 0;
+        uint64_t size = 0;
+        bool pending = false;   // Changed on the last poll, reload if unchanged on this one
+        bool operator==(const FileStamp& other) const { return lastWrite == other.lastWrite && size == other.size; }
+    };
+
+    void Run();
+    void Poll();
+    void Reload(const std::string& path);
+
+    RotationWorker& m_worker;
+    std::string m_directory;
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    std::atomic<bool> m_enabled{ true };
+    std::atomic<int> m_pollMs{ DEFAULT_POLL_MS };
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    ReloadCallback m_callback;
+
+    std::map<std::string, FileStamp> m_files; // Watcher thread only
+
+    std::atomic<uint64_t> m_statPolls{ 0 };
+    std::atomic<uint64_t> m_statReloads{ 0 };
+    std::atomic<uint64_t> m_statFailures{ 0 };
+    std::atomic<uint64_t> m_statSwaps{ 0 };
+    std::atomic<double> m_statLastReloadMs{ 0.0 };
+};
+
+} // namespace Rotation
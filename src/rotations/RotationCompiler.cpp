@@ -0,0 +1,843 @@
+#include "RotationCompiler.h"
+#include "ConditionCost.h"
+#include "DecisionTrace.h"
+#include "ClusterIndex.h"
+#include "PriorityRanker.h"
+#include "../types/Rotation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+namespace Rotation {
+
+namespace {
+
+constexpr float VM_PI = 3.14159265358979323846f;
+constexpr float VM_TWO_PI = 2.0f * VM_PI;
+
+std::atomic<uint64_t> g_vmDecisions{ 0 };
+std::atomic<uint64_t> g_vmInstructions{ 0 };
+std::atomic<uint64_t> g_vmTotalNs{ 0 };
+std::atomic<uint64_t> g_vmMemoHits{ 0 };
+std::atomic<uint64_t> g_vmMemoMisses{ 0 };
+
+// One in this many FindFirstCastableStep calls is timed per condition for the cost model
+constexpr uint32_t COST_SAMPLE_INTERVAL = 64;
+
+uint32_t FloatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float BitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Appends instructions to a program while it is being compiled
+class Emitter {
+public:
+    explicit Emitter(RotationProgram& program) : m_program(program) {}
+
+    void Word(uint32_t word) { m_program.code.push_back(word); }
+    void Float(float value) { m_program.code.push_back(FloatBits(value)); }
+    void Spell(uint32_t spellId) {
+        Word(spellId);
+        if (spellId != 0) m_spells.push_back(spellId);
+    }
+
+    // Emits "JUMP_IF_FALSE <patched later>" and remembers it
+    void JumpToFail() {
+        Word(EncodeHeader(OpCode::JUMP_IF_FALSE));
+        m_pendingJumps.push_back(static_cast<uint32_t>(m_program.code.size()));
+        Word(0);
+    }
+    void PatchJumps(uint32_t target) {
+        for (uint32_t at : m_pendingJumps) m_program.code[at] = target;
+        m_pendingJumps.clear();
+    }
+
+    void Condition(const Rotation::Condition& cond) {
+        OperandUnit unit = cond.targetIsPlayer ? OperandUnit::PLAYER : OperandUnit::TARGET;
+        uint64_t caster = cond.casterGuid;
+
+        switch (cond.type) {
+        case Condition::Type::HEALTH_PERCENT_BELOW:
+            Word(EncodeHeader(OpCode::HEALTH_BELOW, unit));
+            Float(cond.value);
+            break;
+        case Condition::Type::MANA_PERCENT_ABOVE:
+            Word(EncodeHeader(OpCode::POWER_PCT_ABOVE, OperandUnit::PLAYER));
+            Word(PowerType::POWER_TYPE_MANA);
+            Float(cond.value);
+            break;
+        case Condition::Type::TARGET_IS_CASTING:
+            Word(EncodeHeader(OpCode::IS_CASTING, OperandUnit::TARGET));
+            Word(cond.spellId);
+            break;
+        case Condition::Type::PLAYER_HAS_AURA:
+        case Condition::Type::TARGET_HAS_AURA:
+        case Condition::Type::PLAYER_MISSING_AURA:
+        case Condition::Type::TARGET_MISSING_AURA: {
+            // "Aura On" Target/Focus/Friendly moves a player check to the step target (the only other unit the VM has)
+            bool onPlayer = (cond.type == Condition::Type::PLAYER_HAS_AURA || cond.type == Condition::Type::PLAYER_MISSING_AURA) &&
+                            (cond.auraTarget == AuraUnit::DEFAULT || cond.auraTarget == AuraUnit::PLAYER);
+            bool missing = cond.type == Condition::Type::PLAYER_MISSING_AURA || cond.type == Condition::Type::TARGET_MISSING_AURA;
+            OperandUnit auraUnit = onPlayer ? OperandUnit::PLAYER : OperandUnit::TARGET;
+            uint32_t flags = missing ? OPFLAG_NEGATE : 0;
+            if (cond.multiAuraIds.empty()) {
+                Word(EncodeHeader(OpCode::HAS_AURA, auraUnit, flags));
+                Word(cond.spellId);
+                Word(static_cast<uint32_t>((std::max)(0, cond.minStacks)));
+                Word(static_cast<uint32_t>(caster & 0xFFFFFFFF));
+                Word(static_cast<uint32_t>(caster >> 32));
+            } else {
+                OpCode op = cond.multiAuraLogic == AuraConditionLogic::ALL_OF ? OpCode::HAS_AURA_ALL : OpCode::HAS_AURA_ANY;
+                Word(EncodeHeader(op, auraUnit, flags));
+                Word(static_cast<uint32_t>((std::max)(0, cond.minStacks)));
+                Word(static_cast<uint32_t>(caster & 0xFFFFFFFF));
+                Word(static_cast<uint32_t>(caster >> 32));
+                Word(static_cast<uint32_t>(cond.multiAuraIds.size()));
+                for (uint32_t id : cond.multiAuraIds) Word(id);
+            }
+            break;
+        }
+        case Condition::Type::SPELL_OFF_COOLDOWN:
+        case Condition::Type::SPELL_NOT_ON_COOLDOWN:
+            Word(EncodeHeader(OpCode::SPELL_READY));
+            Spell(cond.spellId);
+            break;
+        case Condition::Type::MELEE_UNITS_AROUND_PLAYER_GREATER_THAN:
+            Word(EncodeHeader(OpCode::UNITS_NEAR_GT));
+            Float(cond.range > 0.0f ? cond.range : 5.0f);
+            Float(cond.value);
+            break;
+        case Condition::Type::UNITS_IN_FRONTAL_CONE_GT:
+            Word(EncodeHeader(OpCode::UNITS_IN_CONE_GT));
+            Float(cond.range > 0.0f ? cond.range : 8.0f);
+            Float(cond.coneAngle > 0.0f ? cond.coneAngle : 90.0f);
+            Float(cond.value);
+            break;
+        case Condition::Type::PLAYER_THREAT_ON_TARGET_BELOW_PERCENT:
+            Word(EncodeHeader(OpCode::THREAT_BELOW, OperandUnit::TARGET));
+            Float(cond.value);
+            break;
+        case Condition::Type::SPELL_HAS_CHARGES:
+            Word(EncodeHeader(OpCode::CHARGES_AT_LEAST));
+            Spell(cond.spellId);
+            Word(static_cast<uint32_t>((std::max)(1.0f, cond.value)));
+            break;
+        case Condition::Type::PLAYER_IS_FACING_TARGET:
+            Word(EncodeHeader(OpCode::FACING_TARGET, OperandUnit::TARGET));
+            Float(cond.facingConeAngle);
+            break;
+        case Condition::Type::COMBO_POINTS_GREATER_THAN_OR_EQUAL_TO:
+            Word(EncodeHeader(OpCode::COMBO_AT_LEAST, OperandUnit::TARGET));
+            Word(static_cast<uint32_t>((std::max)(0.0f, cond.value)));
+            break;
+        case Condition::Type::UNKNOWN:
+        default:
+            // Unknown conditions never pass (same as the interpreter's default case)
+            Word(EncodeHeader(OpCode::CONST));
+            Word(0);
+            break;
+        }
+    }
+
+    std::vector<uint32_t>& ReferencedSpells() { return m_spells; }
+
+private:
+    RotationProgram& m_program;
+    std::vector<uint32_t> m_pendingJumps;
+    std::vector<uint32_t> m_spells;
+};
+
+// State of one Run() call. `target` is the unit TARGET operands refer to: the current target, or a
+// candidate in multi-target mode. Target-operand results go to targetMemo so player-only results
+// in `memo` stay valid while the candidate changes.
+struct RunContext {
+    const WorldSnapshot& world;
+    const UnitSnapshot* target;
+    ConditionMemo* memo = nullptr;
+    ConditionMemo* targetMemo = nullptr;
+    std::vector<ConditionCostModel::Sample>* samples = nullptr;
+    uint64_t executed = 0;
+
+    RunContext(const WorldSnapshot& w, const UnitSnapshot* t) : world(w), target(t) {}
+};
+
+inline const UnitSnapshot* CurrentTarget(const WorldSnapshot& world) {
+    return world.hasTarget ? &world.target : nullptr;
+}
+
+// Resolves the unit operand; nullptr if the unit is not available
+inline const UnitSnapshot* ResolveUnit(const RunContext& ctx, OperandUnit unit) {
+    return unit == OperandUnit::PLAYER ? &ctx.world.player : ctx.target;
+}
+
+inline bool AuraCheck(const UnitSnapshot& unit, uint32_t spellId, int minStacks, uint64_t caster) {
+    return unit.FindAura(spellId, minStacks, caster) != nullptr;
+}
+
+inline bool InCone(const UnitSnapshot& from, const Vector3& to, float halfAngleRad) {
+    float dx = to.x - from.position.x;
+    float dy = to.y - from.position.y;
+    if (std::fabs(dx) < 0.001f && std::fabs(dy) < 0.001f) return true;
+    float angle = std::atan2(dy, dx);
+    if (angle < 0.0f) angle += VM_TWO_PI;
+    float diff = std::fabs(angle - from.facing);
+    if (diff > VM_PI) diff = VM_TWO_PI - diff;
+    return diff <= halfAngleRad;
+}
+
+inline bool IsConditionOp(OpCode op) {
+    return op != OpCode::RETURN && op != OpCode::JUMP_IF_FALSE && op != OpCode::CONST;
+}
+
+// Tracing entry points; with ROTATION_TRACE=0 they return nullptr/do nothing and the
+// `if (trace)` branches below fold away
+#if ROTATION_TRACE
+inline TraceTick* BeginTrace(const RotationProgram& program, const WorldSnapshot& world) {
+    return DecisionTrace::GetInstance().BeginTick(program, world);
+}
+inline uint64_t TraceTimestamp() { return DecisionTrace::Timestamp(); }
+inline void CommitTrace(TraceTick* tick) { DecisionTrace::GetInstance().CommitTick(tick); }
+#else
+inline TraceTick* BeginTrace(const RotationProgram&, const WorldSnapshot&) { return nullptr; }
+inline uint64_t TraceTimestamp() { return 0; }
+inline void CommitTrace(TraceTick*) {}
+#endif
+
+// Records one step of a traced tick (does nothing when tick is null). Only the instruction count
+// is kept: a step block runs linearly until its first failing check, so DecisionTrace::DecodeStep
+// can rebuild every condition result from the program afterwards.
+class StepTrace {
+public:
+    StepTrace(TraceTick* tick, const CompiledStep& step, const RunContext& ctx) : m_ctx(ctx) {
+        if (!tick) return;
+        m_step = tick->BeginStep(step.stepIndex, step.spellId, ctx.target ? ctx.target->guid : 0);
+        if (!m_step) return;
+        m_executed = ctx.executed;
+        m_timed = tick->stepTiming;
+        if (m_timed) m_start = TraceTimestamp();
+    }
+    void End(bool passed) {
+        if (!m_step) return;
+        if (m_timed) m_step->ticks = static_cast<uint32_t>(TraceTimestamp() - m_start);
+        m_step->instructions = static_cast<uint16_t>((std::min)(m_ctx.executed - m_executed, static_cast<uint64_t>(UINT16_MAX)));
+        m_step->passed = passed ? 1 : 0;
+    }
+
+private:
+    const RunContext& m_ctx;
+    TraceStep* m_step = nullptr;
+    uint64_t m_executed = 0;
+    uint64_t m_start = 0;
+    bool m_timed = false;
+};
+
+// Runs one step's block. Returns the accumulator at RETURN.
+// If samples is set, every computed condition is timed and recorded for the cost model.
+bool Run(const RotationProgram& program, uint32_t pc, RunContext& ctx) {
+    const uint32_t* code = program.code.data();
+    const WorldSnapshot& world = ctx.world;
+    const UnitSnapshot* target = ctx.target;
+    bool isCurrentTarget = target != nullptr && target == CurrentTarget(world);
+    bool acc = true;
+
+    for (;;) {
+        uint32_t headerPc = pc;
+        uint32_t header = code[pc++];
+        ++ctx.executed;
+        OpCode op = HeaderOp(header);
+        bool negate = (HeaderFlags(header) & OPFLAG_NEGATE) != 0;
+
+        ConditionMemo* memo = (HeaderUnit(header) == OperandUnit::TARGET && ctx.targetMemo) ? ctx.targetMemo : ctx.memo;
+        uint32_t memoSlot = memo ? HeaderMemoSlot(header) : 0;
+        if (memoSlot != 0) {
+            if (memo->Lookup(memoSlot - 1, acc)) {
+                ++memo->hits;
+                pc = headerPc + InstructionLength(code, headerPc);
+                continue;
+            }
+            ++memo->misses;
+        }
+
+        std::vector<ConditionCostModel::Sample>* samples = ctx.samples;
+        bool timed = samples && IsConditionOp(op);
+        std::chrono::steady_clock::time_point opStart;
+        if (timed) opStart = std::chrono::steady_clock::now();
+
+        switch (op) {
+        case OpCode::RETURN:
+            return acc;
+        case OpCode::JUMP_IF_FALSE: {
+            uint32_t target = code[pc++];
+            if (!acc) pc = target;
+            continue;
+        }
+        case OpCode::CONST:
+            acc = code[pc++] != 0;
+            break;
+        case OpCode::HAS_TARGET:
+            acc = target && !target->isDead;
+            break;
+        case OpCode::HEALTH_BELOW: {
+            float threshold = BitsFloat(code[pc++]);
+            const UnitSnapshot* unit = ResolveUnit(ctx, HeaderUnit(header));
+            acc = unit && unit->healthPercent < threshold;
+            break;
+        }
+        case OpCode::POWER_PCT_ABOVE: {
+            int powerType = static_cast<int>(code[pc++]);
+            float threshold = BitsFloat(code[pc++]);
+            const UnitSnapshot* unit = ResolveUnit(ctx, HeaderUnit(header));
+            acc = unit && unit->GetPowerPercent(powerType) > threshold;
+            break;
+        }
+        case OpCode::POWER_AT_LEAST: {
+            uint32_t powerType = code[pc++];
+            int amount = static_cast<int>(code[pc++]);
+            const UnitSnapshot* unit = ResolveUnit(ctx, HeaderUnit(header));
+            acc = unit && powerType < PowerType::POWER_TYPE_COUNT && unit->power[powerType] >= amount;
+            break;
+        }
+        case OpCode::IS_CASTING: {
+            uint32_t spellId = code[pc++];
+            const UnitSnapshot* unit = ResolveUnit(ctx, HeaderUnit(header));
+            acc = unit && unit->castingSpellId != 0 && (spellId == 0 || unit->castingSpellId == spellId);
+            break;
+        }
+        case OpCode::HAS_AURA: {
+            uint32_t spellId = code[pc];
+            int minStacks = static_cast<int>(code[pc + 1]);
+            uint64_t caster = static_cast<uint64_t>(code[pc + 2]) | (static_cast<uint64_t>(code[pc + 3]) << 32);
+            pc += 4;
+            const UnitSnapshot* unit = ResolveUnit(ctx, HeaderUnit(header));
+            acc = unit && (AuraCheck(*unit, spellId, minStacks, caster) != negate);
+            break;
+        }
+        case OpCode::HAS_AURA_ANY:
+        case OpCode::HAS_AURA_ALL: {
+            int minStacks = static_cast<int>(code[pc]);
+            uint64_t caster = static_cast<uint64_t>(code[pc + 1]) | (static_cast<uint64_t>(code[pc + 2]) << 32);
+            uint32_t count = code[pc + 3];
+            const uint32_t* ids = code + pc + 4;
+            pc += 4 + count;
+            const UnitSnapshot* unit = ResolveUnit(ctx, HeaderUnit(header));
+            if (!unit) {
+                acc = false;
+                break;
+            }
+            // "Missing" inverts the per-aura presence test: ANY_OF missing = at least one absent
+            bool wantAll = op == OpCode::HAS_AURA_ALL;
+            bool result = wantAll;
+            for (uint32_t i = 0; i < count; ++i) {
+                bool match = AuraCheck(*unit, ids[i], minStacks, caster) != negate;
+                if (wantAll && !match) { result = false; break; }
+                if (!wantAll && match) { result = true; break; }
+            }
+            acc = result;
+            break;
+        }
+        case OpCode::SPELL_READY: {
+            const SpellStateSnapshot* spell = world.FindSpell(code[pc++]);
+            acc = spell && spell->cooldownMs <= 0;
+            break;
+        }
+        case OpCode::CHARGES_AT_LEAST: {
+            const SpellStateSnapshot* spell = world.FindSpell(code[pc]);
+            int wanted = static_cast<int>(code[pc + 1]);
+            pc += 2;
+            acc = spell && spell->charges >= wanted;
+            break;
+        }
+        case OpCode::UNITS_NEAR_GT: {
+            float range = BitsFloat(code[pc]);
+            float count = BitsFloat(code[pc + 1]);
+            pc += 2;
+            float rangeSq = range * range;
+            int found = 0;
+            for (const auto& unit : world.nearbyUnits) {
+                if (unit.isHostile && !unit.isDead && unit.position.DistanceSq(world.player.position) <= rangeSq) ++found;
+            }
+            acc = static_cast<float>(found) > count;
+            break;
+        }
+        case OpCode::UNITS_IN_CONE_GT: {
+            float range = BitsFloat(code[pc]);
+            float halfAngle = BitsFloat(code[pc + 1]) * (VM_PI / 180.0f) * 0.5f;
+            float count = BitsFloat(code[pc + 2]);
+            pc += 3;
+            float rangeSq = range * range;
+            int found = 0;
+            for (const auto& unit : world.nearbyUnits) {
+                if (!unit.isHostile || unit.isDead) continue;
+                if (unit.position.DistanceSq(world.player.position) > rangeSq) continue;
+                if (InCone(world.player, unit.position, halfAngle)) ++found;
+            }
+            acc = static_cast<float>(found) > count;
+            break;
+        }
+        case OpCode::THREAT_BELOW: {
+            float threshold = BitsFloat(code[pc++]);
+            // Threat is only known for the current target; a fresh candidate has none yet
+            acc = target && (isCurrentTarget ? world.playerThreatPercent : 0.0f) < threshold;
+            break;
+        }
+        case OpCode::FACING_TARGET: {
+            float halfAngle = BitsFloat(code[pc++]) * (VM_PI / 180.0f) * 0.5f;
+            acc = target && InCone(world.player, target->position, halfAngle);
+            break;
+        }
+        case OpCode::COMBO_AT_LEAST:
+            // Combo points live on the current target only
+            acc = target && (isCurrentTarget ? world.comboPoints : 0u) >= code[pc++];
+            break;
+        case OpCode::NOT_MOVING:
+            acc = !world.playerMoving;
+            break;
+        case OpCode::CLUSTER_AT_LEAST: {
+            float radius = BitsFloat(code[pc]);
+            int count = static_cast<int>(code[pc + 1]);
+            bool ground = code[pc + 2] != 0;
+            float maxRange = BitsFloat(code[pc + 3]);
+            pc += 4;
+            ClusterIndex& clusters = ClusterIndex::ForThread();
+            clusters.Sync(world);
+            AoeCluster cluster;
+            bool found = ground ? clusters.BestCenter(radius, world.player.position, maxRange, cluster)
+                                : clusters.BestTarget(radius, world.player.position, maxRange, cluster);
+            acc = found && cluster.count >= count;
+            break;
+        }
+        default:
+            // Corrupt program - fail the step rather than running off the end
+            return false;
+        }
+
+        if (memoSlot != 0) memo->Store(memoSlot - 1, acc);
+        if (timed) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - opStart).count();
+            samples->push_back({ ConditionCostModel::ConditionKey(code, headerPc), op, static_cast<uint32_t>(ns), acc });
+        }
+    }
+}
+
+// Gives every condition instruction that occurs more than once in the program a shared memo slot.
+// The key is the whole instruction (header without slot bits + immediates), so thresholds, units
+// and negation must all match.
+void AssignMemoSlots(RotationProgram& program) {
+    std::map<std::vector<uint32_t>, std::vector<uint32_t>> occurrences; // instruction words -> header positions
+    for (const auto& step : program.steps) {
+        uint32_t pc = step.codeOffset;
+        while (pc < step.codeEnd) {
+            uint32_t length = InstructionLength(program.code.data(), pc);
+            if (IsConditionOp(HeaderOp(program.code[pc]))) {
+                std::vector<uint32_t> key(program.code.begin() + pc, program.code.begin() + pc + length);
+                key[0] = WithMemoSlot(key[0], 0);
+                occurrences[key].push_back(pc);
+            }
+            pc += length;
+        }
+    }
+
+    uint32_t slots = 0;
+    for (const auto& entry : occurrences) {
+        if (entry.second.size() < 2 || slots >= MAX_MEMO_SLOTS) continue;
+        ++slots;
+        for (uint32_t at : entry.second) program.code[at] = WithMemoSlot(program.code[at], slots);
+    }
+    program.memoSlotCount = slots;
+}
+
+} // namespace
+
+uint32_t InstructionLength(const uint32_t* code, uint32_t pc) {
+    switch (HeaderOp(code[pc])) {
+    case OpCode::RETURN: case OpCode::HAS_TARGET: case OpCode::NOT_MOVING:
+        return 1;
+    case OpCode::JUMP_IF_FALSE: case OpCode::CONST: case OpCode::HEALTH_BELOW: case OpCode::IS_CASTING:
+    case OpCode::SPELL_READY: case OpCode::THREAT_BELOW: case OpCode::FACING_TARGET: case OpCode::COMBO_AT_LEAST:
+        return 2;
+    case OpCode::POWER_PCT_ABOVE: case OpCode::POWER_AT_LEAST: case OpCode::CHARGES_AT_LEAST: case OpCode::UNITS_NEAR_GT:
+        return 3;
+    case OpCode::UNITS_IN_CONE_GT:
+        return 4;
+    case OpCode::HAS_AURA: case OpCode::CLUSTER_AT_LEAST:
+        return 5;
+    case OpCode::HAS_AURA_ANY: case OpCode::HAS_AURA_ALL:
+        return 5 + code[pc + 4];
+    default:
+        return 1;
+    }
+}
+
+std::shared_ptr<const RotationProgram> RotationCompiler::Compile(const RotationProfile& profile, bool reorderConditions) {
+    auto program = std::make_shared<RotationProgram>();
+    const ConditionCostModel& costModel = ConditionCostModel::GetInstance();
+    static std::atomic<uint64_t> s_nextProgramId{ 1 };
+    program->id = s_nextProgramId.fetch_add(1, std::memory_order_relaxed);
+    program->profileName = profile.name;
+    program->steps.reserve(profile.steps.size());
+
+    Emitter emit(*program);
+    for (size_t i = 0; i < profile.steps.size(); ++i) {
+        const RotationStep& step = profile.steps[i];
+        CompiledStep compiled;
+        compiled.codeOffset = static_cast<uint32_t>(program->code.size());
+        compiled.spellId = step.spellId;
+        compiled.stepIndex = static_cast<uint16_t>(i);
+        compiled.conditionCount = static_cast<uint16_t>(step.conditions.size());
+        compiled.basePriority = step.basePriority;
+        compiled.targetType = step.targetType;
+        compiled.requiresTarget = step.requiresTarget;
+        compiled.maxRange = step.maxRange;
+        bool isCluster = step.targetType == TargetType::ENEMY_CLUSTER || step.targetType == TargetType::GROUND_CLUSTER;
+        compiled.aoeRadius = isCluster ? step.aoeRadius : 0.0f;
+
+        // Implicit checks first: spell ready, target present, resource cost, movement
+        if (step.spellId != 0) {
+            emit.Word(EncodeHeader(OpCode::SPELL_READY));
+            emit.Spell(step.spellId);
+            emit.JumpToFail();
+        }
+        if (step.requiresTarget && step.targetType == TargetType::ENEMY) {
+            emit.Word(EncodeHeader(OpCode::HAS_TARGET, OperandUnit::TARGET));
+            emit.JumpToFail();
+        }
+        int powerType = PowerTypeFromResource(step.resourceType);
+        if (step.manaCost > 0 && powerType >= 0) {
+            emit.Word(EncodeHeader(OpCode::POWER_AT_LEAST, OperandUnit::PLAYER));
+            emit.Word(static_cast<uint32_t>(powerType));
+            emit.Word(static_cast<uint32_t>(step.manaCost));
+            emit.JumpToFail();
+        }
+        if (!step.castableWhileMoving && (step.castTime > 0.0f || step.isChannel)) {
+            emit.Word(EncodeHeader(OpCode::NOT_MOVING));
+            emit.JumpToFail();
+        }
+        if (isCluster) {
+            emit.Word(EncodeHeader(OpCode::CLUSTER_AT_LEAST));
+            emit.Float(step.aoeRadius);
+            emit.Word(static_cast<uint32_t>((std::max)(1, step.aoeMinCount)));
+            emit.Word(step.targetType == TargetType::GROUND_CLUSTER ? 1u : 0u);
+            emit.Float(step.maxRange);
+            emit.JumpToFail();
+        }
+
+        // Lower each condition on its own, then emit them cheapest-and-most-likely-to-fail first.
+        // The conjunction is pure, so the order only changes how much work short-circuiting skips.
+        struct LoweredCondition {
+            std::vector<uint32_t> words;
+            float rank = 0.0f;
+        };
+        std::vector<LoweredCondition> lowered;
+        lowered.reserve(step.conditions.size());
+        for (const auto& cond : step.conditions) {
+            size_t start = program->code.size();
+            if (cond.check) {
+                // Custom callbacks can't be lowered; JSON profiles never set them
+                emit.Word(EncodeHeader(OpCode::CONST));
+                emit.Word(1);
+            } else {
+                emit.Condition(cond);
+            }
+            LoweredCondition entry;
+            entry.words.assign(program->code.begin() + start, program->code.end());
+            program->code.resize(start);
+            if (reorderConditions) {
+                entry.rank = costModel.Rank(ConditionCostModel::ConditionKey(entry.words.data(), 0), HeaderOp(entry.words[0]));
+            }
+            lowered.push_back(std::move(entry));
+        }
+        if (reorderConditions) {
+            std::stable_sort(lowered.begin(), lowered.end(),
+                             [](const LoweredCondition& a, const LoweredCondition& b) { return a.rank < b.rank; });
+        }
+        for (const auto& entry : lowered) {
+            for (uint32_t word : entry.words) emit.Word(word);
+            emit.JumpToFail();
+        }
+
+        // Success exit, then the shared fail exit every JUMP_IF_FALSE of this step lands on
+        emit.Word(EncodeHeader(OpCode::CONST));
+        emit.Word(1);
+        emit.Word(EncodeHeader(OpCode::RETURN));
+        emit.PatchJumps(static_cast<uint32_t>(program->code.size()));
+        emit.Word(EncodeHeader(OpCode::RETURN)); // acc is false here
+
+        compiled.codeEnd = static_cast<uint32_t>(program->code.size());
+        program->steps.push_back(compiled);
+    }
+
+    auto& spells = emit.ReferencedSpells();
+    std::sort(spells.begin(), spells.end());
+    spells.erase(std::unique(spells.begin(), spells.end()), spells.end());
+    program->referencedSpells = spells;
+    AssignMemoSlots(*program);
+
+    // Priority order only differs from profile order if base priorities differ or a step has boosts
+    bool ranked = false;
+    for (const auto& step : profile.steps) {
+        ranked = ranked || !step.priorityBoosts.empty() || step.basePriority != profile.steps.front().basePriority;
+    }
+    if (ranked) {
+        auto ranking = std::make_shared<PriorityRanker>();
+        ranking->Build(profile, WorldSnapshot());
+        ranking->Invalidate(); // Built on an empty snapshot; the first Update re-ranks every step
+        program->ranking = ranking;
+    }
+    return program;
+}
+
+const char* OpCodeName(OpCode op) {
+    static const char* names[] = {
+        "RETURN", "JUMP_IF_FALSE", "CONST", "HAS_TARGET", "HEALTH_BELOW", "POWER_PCT_ABOVE", "POWER_AT_LEAST",
+        "IS_CASTING", "HAS_AURA", "HAS_AURA_ANY", "HAS_AURA_ALL", "SPELL_READY", "CHARGES_AT_LEAST",
+        "UNITS_NEAR_GT", "UNITS_IN_CONE_GT", "THREAT_BELOW", "FACING_TARGET", "COMBO_AT_LEAST", "NOT_MOVING",
+        "CLUSTER_AT_LEAST"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(OpCode::OPCODE_COUNT), "Opcode name table out of date");
+    size_t opIndex = static_cast<size_t>(op);
+    return opIndex < static_cast<size_t>(OpCode::OPCODE_COUNT) ? names[opIndex] : "???";
+}
+
+std::string RotationCompiler::Disassemble(const RotationProgram& program) {
+    std::stringstream ss;
+    ss << "; " << program.profileName << " - " << program.steps.size() << " steps, " << program.code.size() << " words, "
+       << program.memoSlotCount << " shared checks\n";
+    for (const auto& step : program.steps) {
+        ss << "step " << step.stepIndex << " (spell " << step.spellId << "):\n";
+        uint32_t pc = step.codeOffset;
+        while (pc < step.codeEnd) {
+            uint32_t header = program.code[pc];
+            OpCode op = HeaderOp(header);
+            size_t immediates = InstructionLength(program.code.data(), pc) - 1;
+            ss << "  " << pc << ": " << OpCodeName(op);
+            if (HeaderUnit(header) == OperandUnit::TARGET) ss << " [target]";
+            if (HeaderFlags(header) & OPFLAG_NEGATE) ss << " [not]";
+            if (HeaderMemoSlot(header) != 0) ss << " [memo " << (HeaderMemoSlot(header) - 1) << "]";
+            for (size_t i = 1; i <= immediates; ++i) {
+                bool isFloat = op == OpCode::HEALTH_BELOW || op == OpCode::THREAT_BELOW || op == OpCode::FACING_TARGET ||
+                               op == OpCode::UNITS_NEAR_GT || op == OpCode::UNITS_IN_CONE_GT ||
+                               (op == OpCode::POWER_PCT_ABOVE && i == 2) ||
+                               (op == OpCode::CLUSTER_AT_LEAST && (i == 1 || i == 4));
+                if (isFloat) ss << " " << BitsFloat(program.code[pc + i]);
+                else ss << " " << program.code[pc + i];
+            }
+            ss << "\n";
+            pc += static_cast<uint32_t>(1 + immediates);
+        }
+    }
+    return ss.str();
+}
+
+bool RotationVM::EvaluateStep(const RotationProgram& program, size_t stepIndex, const WorldSnapshot& world,
+                              ConditionMemo* memo) {
+    if (stepIndex >= program.steps.size()) return false;
+    RunContext ctx(world, CurrentTarget(world));
+    ctx.memo = memo;
+    uint64_t hitsBefore = memo ? memo->hits : 0;
+    uint64_t missesBefore = memo ? memo->misses : 0;
+    bool result = Run(program, program.steps[stepIndex].codeOffset, ctx);
+    g_vmInstructions.fetch_add(ctx.executed, std::memory_order_relaxed);
+    if (memo) {
+        g_vmMemoHits.fetch_add(memo->hits - hitsBefore, std::memory_order_relaxed);
+        g_vmMemoMisses.fetch_add(memo->misses - missesBefore, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+bool RotationVM::EvaluateStepOnUnit(const RotationProgram& program, size_t stepIndex, const WorldSnapshot& world,
+                                    const UnitSnapshot& unit) {
+    if (stepIndex >= program.steps.size()) return false;
+    RunContext ctx(world, &unit);
+    bool result = Run(program, program.steps[stepIndex].codeOffset, ctx);
+    g_vmInstructions.fetch_add(ctx.executed, std::memory_order_relaxed);
+    return result;
+}
+
+int RotationVM::FindFirstCastableStep(const RotationProgram& program, const WorldSnapshot& world,
+                                      const std::vector<int>* order) {
+    // One memo per thread, reused across calls so evaluation doesn't allocate
+    thread_local ConditionMemo memo;
+    thread_local std::vector<ConditionCostModel::Sample> costSamples;
+    thread_local uint32_t callCount = 0;
+    bool sampleCosts = (++callCount % COST_SAMPLE_INTERVAL) == 0;
+    if (sampleCosts) costSamples.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    memo.Begin(program.memoSlotCount);
+    memo.hits = 0;
+    memo.misses = 0;
+    RunContext ctx(world, CurrentTarget(world));
+    ctx.memo = &memo;
+    ctx.samples = sampleCosts ? &costSamples : nullptr;
+    TraceTick* trace = BeginTrace(program, world);
+    int found = -1;
+    size_t stepCount = order ? order->size() : program.steps.size();
+    for (size_t n = 0; n < stepCount; ++n) {
+        size_t i = order ? static_cast<size_t>((*order)[n]) : n;
+        if (i >= program.steps.size()) continue;
+        StepTrace stepTrace(trace, program.steps[i], ctx);
+        bool passed = Run(program, program.steps[i].codeOffset, ctx);
+        stepTrace.End(passed);
+        if (passed) {
+            found = static_cast<int>(i);
+            break;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (trace) {
+        trace->totalNs = static_cast<uint64_t>(elapsed);
+        if (found >= 0) {
+            trace->chosenStep = program.steps[found].stepIndex;
+            trace->spellId = program.steps[found].spellId;
+            trace->targetGuid = ctx.target ? ctx.target->guid : 0;
+        }
+        CommitTrace(trace);
+    }
+    g_vmDecisions.fetch_add(1, std::memory_order_relaxed);
+    g_vmInstructions.fetch_add(ctx.executed, std::memory_order_relaxed);
+    g_vmTotalNs.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+    g_vmMemoHits.fetch_add(memo.hits, std::memory_order_relaxed);
+    g_vmMemoMisses.fetch_add(memo.misses, std::memory_order_relaxed);
+    if (sampleCosts) ConditionCostModel::GetInstance().Record(costSamples);
+    return found;
+}
+
+RotationVM::TargetedStep RotationVM::FindFirstCastableStepMultiTarget(const RotationProgram& program, const WorldSnapshot& world,
+                                                                     const std::vector<int>* order) {
+    struct Candidate {
+        const UnitSnapshot* unit;
+        float distanceSq;
+    };
+    thread_local ConditionMemo memo;
+    thread_local std::vector<ConditionMemo> targetMemos; // One per candidate, parallel to `candidates`
+    thread_local ConditionMemo noTargetMemo;
+    thread_local std::vector<Candidate> candidates;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Candidate list once per pass: current target first, then living hostiles by combat state and
+    // health (highest first, so DoTs go where they tick longest). Distances are computed here once.
+    candidates.clear();
+    const UnitSnapshot* current = CurrentTarget(world);
+    if (current && !current->isDead) {
+        candidates.push_back({ current, current->position.DistanceSq(world.player.position) });
+    }
+    size_t firstOther = candidates.size();
+    for (const auto& unit : world.nearbyUnits) {
+        if (!unit.isHostile || unit.isDead) continue;
+        if (current && unit.guid == current->guid) continue;
+        candidates.push_back({ &unit, unit.position.DistanceSq(world.player.position) });
+    }
+    std::sort(candidates.begin() + firstOther, candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.unit->inCombat != b.unit->inCombat) return a.unit->inCombat;
+        return a.unit->healthPercent > b.unit->healthPercent;
+    });
+
+    // Player-only results are shared by all candidates; target results are kept per candidate
+    // for the whole pass, so a check repeated across steps on the same unit is still computed once
+    if (targetMemos.size() < candidates.size()) targetMemos.resize(candidates.size());
+    auto beginMemo = [&](ConditionMemo& m) {
+        m.Begin(program.memoSlotCount);
+        m.hits = 0;
+        m.misses = 0;
+    };
+    beginMemo(memo);
+    beginMemo(noTargetMemo);
+    for (size_t c = 0; c < candidates.size(); ++c) beginMemo(targetMemos[c]);
+
+    RunContext ctx(world, current);
+    ctx.memo = &memo;
+    ConditionMemo* currentMemo = (current && firstOther > 0) ? &targetMemos[0] : &noTargetMemo;
+    TraceTick* trace = BeginTrace(program, world);
+
+    TargetedStep result;
+    size_t stepCount = order ? order->size() : program.steps.size();
+    for (size_t n = 0; n < stepCount && result.stepIndex < 0; ++n) {
+        size_t i = order ? static_cast<size_t>((*order)[n]) : n;
+        if (i >= program.steps.size()) continue;
+        const CompiledStep& step = program.steps[i];
+        if (step.targetType != TargetType::ENEMY) {
+            // Self/friendly steps are evaluated once, against the current target as usual
+            ctx.target = current;
+            ctx.targetMemo = currentMemo;
+            StepTrace stepTrace(trace, step, ctx);
+            bool passed = Run(program, step.codeOffset, ctx);
+            stepTrace.End(passed);
+            if (passed) {
+                result.stepIndex = static_cast<int>(i);
+                result.targetGuid = current ? current->guid : 0;
+            }
+            continue;
+        }
+        float maxRangeSq = step.maxRange > 0.0f ? step.maxRange * step.maxRange : 0.0f;
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            const Candidate& candidate = candidates[c];
+            if (maxRangeSq > 0.0f && candidate.distanceSq > maxRangeSq) continue;
+            ctx.target = candidate.unit;
+            ctx.targetMemo = &targetMemos[c];
+            StepTrace stepTrace(trace, step, ctx);
+            bool passed = Run(program, step.codeOffset, ctx);
+            stepTrace.End(passed);
+            if (passed) {
+                result.stepIndex = static_cast<int>(i);
+                result.targetGuid = candidate.unit->guid;
+                result.unit = candidate.unit;
+                break;
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (trace) {
+        trace->totalNs = static_cast<uint64_t>(elapsed);
+        trace->multiTarget = true;
+        if (result.stepIndex >= 0) {
+            trace->chosenStep = program.steps[result.stepIndex].stepIndex;
+            trace->spellId = program.steps[result.stepIndex].spellId;
+            trace->targetGuid = result.targetGuid;
+        }
+        CommitTrace(trace);
+    }
+    g_vmDecisions.fetch_add(1, std::memory_order_relaxed);
+    g_vmInstructions.fetch_add(ctx.executed, std::memory_order_relaxed);
+    g_vmTotalNs.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+    uint64_t hits = memo.hits + noTargetMemo.hits;
+    uint64_t misses = memo.misses + noTargetMemo.misses;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        hits += targetMemos[c].hits;
+        misses += targetMemos[c].misses;
+    }
+    g_vmMemoHits.fetch_add(hits, std::memory_order_relaxed);
+    g_vmMemoMisses.fetch_add(misses, std::memory_order_relaxed);
+    return result;
+}
+
+RotationVM::Stats RotationVM::GetStats() {
+    Stats stats;
+    stats.decisions = g_vmDecisions.load(std::memory_order_relaxed);
+    stats.instructions = g_vmInstructions.load(std::memory_order_relaxed);
+    stats.totalNs = g_vmTotalNs.load(std::memory_order_relaxed);
+    stats.memoHits = g_vmMemoHits.load(std::memory_order_relaxed);
+    stats.memoMisses = g_vmMemoMisses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RotationVM::ResetStats() {
+    g_vmDecisions.store(0, std::memory_order_relaxed);
+    g_vmInstructions.store(0, std::memory_order_relaxed);
+    g_vmTotalNs.store(0, std::memory_order_relaxed);
+    g_vmMemoHits.store(0, std::memory_order_relaxed);
+    g_vmMemoMisses.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Rotation
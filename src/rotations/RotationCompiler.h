@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "WorldSnapshot.h"
+
+namespace Rotation {
+
+struct RotationProfile;
+enum class TargetType;
+class PriorityRanker;
+
+// --- Rotation bytecode ---
+// A compiled profile is one flat array of 32-bit words. Each instruction is a header word
+// (opcode | unit << 8 | flags << 12 | memoSlot << 16) followed by its inline immediates. Condition opcodes set an
+// accumulator; JUMP_IF_FALSE short-circuits to the step's fail exit; RETURN yields the accumulator.
+enum class OpCode : uint8_t {
+    RETURN = 0,          // -
+    JUMP_IF_FALSE,       // u32 target word index
+    CONST,               // u32 value (0/1)
+    HAS_TARGET,          // -
+    HEALTH_BELOW,        // f32 percent
+    POWER_PCT_ABOVE,     // u32 powerType, f32 percent
+    POWER_AT_LEAST,      // u32 powerType, u32 amount
+    IS_CASTING,          // u32 spellId (0 = any)
+    HAS_AURA,            // u32 spellId, u32 minStacks, u32 casterLo, u32 casterHi
+    HAS_AURA_ANY,        // u32 minStacks, u32 casterLo, u32 casterHi, u32 count, count x u32 spellId
+    HAS_AURA_ALL,        // same layout as HAS_AURA_ANY
+    SPELL_READY,         // u32 spellId
+    CHARGES_AT_LEAST,    // u32 spellId, u32 charges
+    UNITS_NEAR_GT,       // f32 range, f32 count
+    UNITS_IN_CONE_GT,    // f32 range, f32 angleDegrees, f32 count
+    THREAT_BELOW,        // f32 percent
+    FACING_TARGET,       // f32 angleDegrees
+    COMBO_AT_LEAST,      // u32 points
+    NOT_MOVING,          // -
+    CLUSTER_AT_LEAST,    // f32 radius, u32 count, u32 ground (0/1), f32 maxRange (see ClusterIndex)
+    OPCODE_COUNT
+};
+
+// Unit operand encoded in the header word
+enum class OperandUnit : uint8_t {
+    PLAYER = 0,
+    TARGET = 1
+};
+
+// Header flags
+constexpr uint32_t OPFLAG_NEGATE = 0x1; // Invert the result (MISSING_AURA); a missing unit still yields false
+
+// Memo slot: 0 = not memoized, otherwise 1 + index into the per-evaluation ConditionMemo
+constexpr uint32_t MAX_MEMO_SLOTS = 0xFFFF;
+
+inline uint32_t EncodeHeader(OpCode op, OperandUnit unit = OperandUnit::PLAYER, uint32_t flags = 0) {
+    return static_cast<uint32_t>(op) | (static_cast<uint32_t>(unit) << 8) | ((flags & 0xF) << 12);
+}
+inline OpCode HeaderOp(uint32_t header) { return static_cast<OpCode>(header & 0xFF); }
+inline OperandUnit HeaderUnit(uint32_t header) { return static_cast<OperandUnit>((header >> 8) & 0xF); }
+inline uint32_t HeaderFlags(uint32_t header) { return (header >> 12) & 0xF; }
+inline uint32_t HeaderMemoSlot(uint32_t header) { return header >> 16; }
+inline uint32_t WithMemoSlot(uint32_t header, uint32_t slot) { return (header & 0xFFFF) | (slot << 16); }
+
+// Number of words (header + immediates) of the instruction starting at code[pc]
+uint32_t InstructionLength(const uint32_t* code, uint32_t pc);
+
+// Mnemonic of an opcode ("???" if out of range)
+const char* OpCodeName(OpCode op);
+
+// Per-step entry into the program
+struct CompiledStep {
+    uint32_t codeOffset = 0;  // First instruction of the step's condition block
+    uint32_t codeEnd = 0;     // One past the step's last instruction
+    uint32_t spellId = 0;
+    uint16_t stepIndex = 0;   // Index into RotationProfile::steps
+    uint16_t conditionCount = 0;
+    int basePriority = 0;
+    TargetType targetType;
+    bool requiresTarget = true;
+    float maxRange = 0.0f;    // 0 = unknown (no range filter in multi-target mode)
+    float aoeRadius = 0.0f;   // ENEMY_CLUSTER / GROUND_CLUSTER only
+};
+
+struct RotationProgram {
+    uint64_t id = 0;                             // Unique per Compile call (never reused, unlike the address)
+    std::string profileName;
+    std::vector<uint32_t> code;
+    std::vector<CompiledStep> steps;             // Profile order
+    std::vector<uint32_t> referencedSpells;      // Sorted, unique: every spell the program reads state for
+    uint32_t memoSlotCount = 0;                  // Distinct condition checks shared by two or more steps
+    std::shared_ptr<const PriorityRanker> ranking; // basePriority + priorityBoosts, unranked (copy, then Update);
+                                                   // nullptr if every step has the same base priority and no boosts
+};
+
+// Results of shared condition checks for one evaluation pass over a program.
+// Begin() invalidates everything in O(1) by bumping a generation counter.
+class ConditionMemo {
+public:
+    void Begin(uint32_t slotCount) {
+        if (m_stamps.size() < slotCount) {
+            m_stamps.resize(slotCount, 0);
+            m_values.resize(slotCount, 0);
+        }
+        if (++m_generation == 0) {
+            std::fill(m_stamps.begin(), m_stamps.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    bool Lookup(uint32_t slot, bool& value) const {
+        if (slot >= m_stamps.size() || m_stamps[slot] != m_generation) return false;
+        value = m_values[slot] != 0;
+        return true;
+    }
+
+    void Store(uint32_t slot, bool value) {
+        if (slot >= m_stamps.size()) return;
+        m_stamps[slot] = m_generation;
+        m_values[slot] = value ? 1 : 0;
+    }
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+private:
+    std::vector<uint32_t> m_stamps;
+    std::vector<uint8_t> m_values;
+    uint32_t m_generation = 0;
+};
+
+class RotationCompiler {
+public:
+    /**
+     * Lower a profile into bytecode. Per step: the step spell must be ready, the target must exist
+     * if required, the resource cost must be met, then every condition in order (AND, short-circuit).
+     * Conditions with a custom `check` callback cannot be lowered and are compiled as CONST 1
+     * (the JSON loader never sets them). Checks that appear more than once (same opcode, unit,
+     * flags and immediates) get a shared memo slot so each is computed once per evaluation.
+     * @param profile Profile to compile
+     * @param reorderConditions Order each step's conditions by ConditionCostModel rank (cost / P(fail))
+     *                          instead of file order. Recompiling later picks up measured costs
+     *                          (RotationWorker::ReorderConditions does so as samples come in).
+     * @return Immutable program, safe to share between threads
+     */
+    static std::shared_ptr<const RotationProgram> Compile(const RotationProfile& profile, bool reorderConditions = true);
+
+    /**
+     * Human-readable listing of a program (for the logs tab / debugging)
+     */
+    static std::string Disassemble(const RotationProgram& program);
+};
+
+class RotationVM {
+public:
+    /**
+     * Run the condition block of one compiled step
+     * @param memo Optional memo shared across the steps of one pass; the caller calls
+     *             memo->Begin(program.memoSlotCount) once per pass
+     * @return true if every check passed
+     */
+    static bool EvaluateStep(const RotationProgram& program, size_t stepIndex, const WorldSnapshot& world,
+                             ConditionMemo* memo = nullptr);
+
+    /**
+     * Run the condition block of one compiled step with `unit` in place of the current target
+     */
+    static bool EvaluateStepOnUnit(const RotationProgram& program, size_t stepIndex, const WorldSnapshot& world,
+                                   const UnitSnapshot& unit);
+
+    /**
+     * Evaluate steps in order. Shared checks are memoized for the duration of the call.
+     * @param order Indices into program.steps to try, highest priority first (nullptr = profile order)
+     * @return Index into program.steps of the first step whose checks pass, or -1
+     */
+    static int FindFirstCastableStep(const RotationProgram& program, const WorldSnapshot& world,
+                                     const std::vector<int>* order = nullptr);
+
+    struct TargetedStep {
+        int stepIndex = -1;                // Index into program.steps, -1 if nothing is castable
+        uint64_t targetGuid = 0;           // Unit the step passed on
+        const UnitSnapshot* unit = nullptr; // Candidate inside the snapshot (nullptr for non-enemy steps)
+    };
+
+    /**
+     * Multi-target mode: ENEMY steps are evaluated against every living hostile in
+     * world.nearbyUnits (current target first, then in-combat and healthiest first, filtered by the
+     * step's maxRange), so e.g. TARGET_MISSING_AURA finds any enemy without the DoT. Other steps use
+     * the current target. Steps keep `order` (profile order if nullptr); the first (step, unit) pair that
+     * passes wins. Needs a snapshot built with nearby auras.
+     */
+    static TargetedStep FindFirstCastableStepMultiTarget(const RotationProgram& program, const WorldSnapshot& world,
+                                                         const std::vector<int>* order = nullptr);
+
+    // Number of decisions and total time spent in FindFirstCastableStep (for decisions/second),
+    // plus memo hits (shared check reused) and misses (shared check computed)
+    struct Stats {
+        uint64_t decisions = 0;
+        uint64_t instructions = 0;
+        uint64_t totalNs = 0;
+        uint64_t memoHits = 0;
+        uint64_t memoMisses = 0;
+    };
+    static Stats GetStats();
+    static void ResetStats();
+};
+
+} // namespace Rotation
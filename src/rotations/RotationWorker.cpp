@@ -0,0 +1,348 @@
+#include "RotationWorker.h"
+#include "ClusterIndex.h"
+#include "ConditionCost.h"
+#include "PriorityRanker.h"
+#include "../types/Rotation.h"
+#include "../spells/cooldowns.h"
+#include "../logs/log.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Rotation {
+
+namespace {
+
+// Steps of a ranked program, highest priority first. The ranker is per thread (the worker, and EndScene
+// when it re-decides) and only re-ranks the steps whose priority inputs changed since its last snapshot.
+const std::vector<int>& RankedOrder(const RotationProgram& program, const WorldSnapshot& world) {
+    thread_local std::shared_ptr<const PriorityRanker> source; // Held so a new program can't reuse the address
+    thread_local PriorityRanker ranker;
+    thread_local std::vector<int> order;
+
+    bool rebuilt = source != program.ranking;
+    if (rebuilt) {
+        source = program.ranking;
+        ranker = *source;
+    }
+    if (ranker.Update(world) != 0 || rebuilt) {
+        order.clear();
+        ranker.ForEachInOrder([](int stepIndex) {
+            order.push_back(stepIndex);
+            return true;
+        });
+    }
+    return order;
+}
+
+inline uint64_t Mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+uint64_t UnitEvents(uint64_t hash, const UnitSnapshot& unit) {
+    hash = Mix(hash, unit.guid);
+    hash = Mix(hash, unit.castingSpellId);
+    for (const auto& aura : unit.auras) {
+        hash = Mix(hash, (static_cast<uint64_t>(aura.spellId) << 8) | aura.stacks);
+    }
+    return hash;
+}
+
+// Aura and cast state of every unit in the snapshot; a change wakes a deferred rotation
+uint64_t EventSignature(const WorldSnapshot& world) {
+    uint64_t hash = UnitEvents(0, world.player);
+    if (world.hasTarget) hash = UnitEvents(hash, world.target);
+    for (const auto& unit : world.nearbyUnits) hash = UnitEvents(hash, unit);
+    return hash;
+}
+
+} // namespace
+
+std::atomic<bool> RotationWorker::s_ownsDecisions{ false };
+
+RotationWorker::~RotationWorker() {
+    Stop();
+}
+
+void RotationWorker::Start() {
+    if (m_running.exchange(true)) return;
+    try {
+        m_thread = std::thread(&RotationWorker::Run, this);
+        Core::Log::Message("[RotationWorker] Started at " + std::to_string(m_decisionHz.load()) + " decisions/s.");
+    } catch (const std::exception& e) {
+        m_running = false;
+        Core::Log::Message(std::string("[RotationWorker] Failed to start thread: ") + e.what());
+    }
+}
+
+void RotationWorker::Stop() {
+    if (!m_running.exchange(false)) return;
+    m_wakeCv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+    Core::Log::Message("[RotationWorker] Stopped.");
+}
+
+void RotationWorker::SetDecisionRate(int hz) {
+    m_decisionHz = (std::max)(MIN_DECISION_HZ, (std::min)(MAX_DECISION_HZ, hz));
+}
+
+void RotationWorker::SetProgram(std::shared_ptr<const RotationProgram> program) {
+    s_ownsDecisions.store(program != nullptr, std::memory_order_release);
+    std::atomic_store(&m_program, std::move(program));
+    m_wakeCv.notify_all();
+}
+
+std::shared_ptr<const RotationProgram> RotationWorker::GetProgram() const {
+    return std::atomic_load(&m_program);
+}
+
+std::shared_ptr<const RotationProgram> RotationWorker::InstallProfile(const RotationProfile& profile) {
+    std::shared_ptr<const RotationProgram> program = RotationCompiler::Compile(profile);
+    std::atomic_store(&m_profile, std::make_shared<const RotationProfile>(profile));
+    if (Spells::CooldownManager* cooldowns = m_cooldowns.load()) {
+        // Tracking resets the readiness timeline, costs included - configure the profile after it
+        cooldowns->TrackProfileSpells(program->referencedSpells);
+        cooldowns->ConfigureProfileSpells(profile);
+    }
+    SetProgram(program);
+    return program;
+}
+
+bool RotationWorker::ReorderConditions() {
+    std::shared_ptr<const RotationProgram> running = std::atomic_load(&m_program);
+    std::shared_ptr<const RotationProfile> profile = std::atomic_load(&m_profile);
+    if (!running || !profile || running->profileName != profile->name) return false;
+
+    // Same profile, same code unless a condition moved (memo slots follow the code)
+    std::shared_ptr<const RotationProgram> resorted = RotationCompiler::Compile(*profile);
+    if (resorted->code == running->code) return false;
+    // Lose to an InstallProfile/SetProgram that happened meanwhile
+    if (!std::atomic_compare_exchange_strong(&m_program, &running, resorted)) return false;
+    m_wakeCv.notify_all();
+    return true;
+}
+
+void RotationWorker::PublishSnapshot(std::shared_ptr<const WorldSnapshot> snapshot) {
+    std::atomic_store(&m_snapshot, std::move(snapshot));
+    m_snapshotSequence.fetch_add(1, std::memory_order_release);
+    m_statSnapshots.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool RotationWorker::TakeDecision(RotationDecision& out) {
+    if (!m_mailbox.Consume(out)) return false;
+    m_statTaken.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool RotationWorker::PollDecision(uint64_t nowMs, RotationDecision& out) {
+    RotationDecision incoming;
+    if (TakeDecision(incoming)) {
+        m_pending = incoming;
+        m_hasPending = incoming.spellId != 0;
+    }
+    if (!m_hasPending || nowMs < m_pending.readyAtMs) return false;
+    out = m_pending;
+    m_hasPending = false;
+    return true;
+}
+
+void RotationWorker::HoldDecision(const RotationDecision& decision) {
+    m_pending = decision;
+    m_hasPending = decision.spellId != 0;
+}
+
+void RotationWorker::RecordSpeculation(bool confirmed) {
+    (confirmed ? m_statSpecConfirmed : m_statSpecRedecided).fetch_add(1, std::memory_order_relaxed);
+}
+
+RotationWorker::Stats RotationWorker::GetStats() const {
+    Stats stats;
+    stats.snapshotsPublished = m_statSnapshots.load(std::memory_order_relaxed);
+    stats.decisions = m_statDecisions.load(std::memory_order_relaxed);
+    stats.idleWakeups = m_statIdle.load(std::memory_order_relaxed);
+    stats.decisionsTaken = m_statTaken.load(std::memory_order_relaxed);
+    stats.decisionNs = m_statDecisionNs.load(std::memory_order_relaxed);
+    stats.speculative = m_statSpeculative.load(std::memory_order_relaxed);
+    stats.speculationConfirmed = m_statSpecConfirmed.load(std::memory_order_relaxed);
+    stats.speculationRedecided = m_statSpecRedecided.load(std::memory_order_relaxed);
+    stats.conditionReorders = m_statReorders.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RotationWorker::ResetStats() {
+    m_statSnapshots = 0;
+    m_statDecisions = 0;
+    m_statIdle = 0;
+    m_statTaken = 0;
+    m_statDecisionNs = 0;
+    m_statSpeculative = 0;
+    m_statSpecConfirmed = 0;
+    m_statSpecRedecided = 0;
+    m_statReorders = 0;
+}
+
+uint64_t RotationWorker::ResolveTargetGuid(const CompiledStep& step, const WorldSnapshot& world) {
+    switch (step.targetType) {
+    case TargetType::SELF:
+        return world.player.guid;
+    case TargetType::NONE:
+        return 0;
+    case TargetType::FRIENDLY:
+    case TargetType::SELF_OR_FRIENDLY:
+        // Current target if it is friendly, otherwise the player
+        return (world.hasTarget && !world.target.isHostile) ? world.target.guid : world.player.guid;
+    case TargetType::ENEMY_CLUSTER:
+    case TargetType::GROUND_CLUSTER: {
+        ClusterIndex& clusters = ClusterIndex::ForThread();
+        clusters.Sync(world);
+        AoeCluster cluster;
+        bool found = step.targetType == TargetType::GROUND_CLUSTER
+            ? clusters.BestCenter(step.aoeRadius, world.player.position, step.maxRange, cluster)
+            : clusters.BestTarget(step.aoeRadius, world.player.position, step.maxRange, cluster);
+        return found ? cluster.targetGuid : 0;
+    }
+    default:
+        return world.hasTarget ? world.target.guid : 0;
+    }
+}
+
+bool RotationWorker::Decide(const RotationProgram& program, const WorldSnapshot& world, bool multiTarget, RotationDecision& out) {
+    out.stepIndex = -1;
+    out.spellId = 0;
+    out.targetGuid = 0;
+    out.requiresTarget = false;
+    out.hasGroundPosition = false;
+
+    // Steps are tried by current priority (basePriority + active boosts) when the profile has any
+    const std::vector<int>* order = program.ranking ? &RankedOrder(program, world) : nullptr;
+    int found = -1;
+    uint64_t targetGuid = 0;
+    if (multiTarget) {
+        RotationVM::TargetedStep targeted = RotationVM::FindFirstCastableStepMultiTarget(program, world, order);
+        found = targeted.stepIndex;
+        targetGuid = targeted.targetGuid;
+    } else {
+        found = RotationVM::FindFirstCastableStep(program, world, order);
+    }
+    if (found < 0) return false;
+
+    const CompiledStep& step = program.steps[found];
+    out.stepIndex = step.stepIndex;
+    out.spellId = step.spellId;
+    // Enemy steps in multi-target mode go to the unit they passed on
+    out.targetGuid = (multiTarget && step.targetType == TargetType::ENEMY) ? targetGuid : ResolveTargetGuid(step, world);
+    out.requiresTarget = step.requiresTarget;
+    if (step.targetType == TargetType::GROUND_CLUSTER) {
+        // Same thread and snapshot as the VM's cluster check, so this is a memo hit
+        AoeCluster cluster;
+        ClusterIndex& clusters = ClusterIndex::ForThread();
+        clusters.Sync(world);
+        if (clusters.BestCenter(step.aoeRadius, world.player.position, step.maxRange, cluster)) {
+            out.hasGroundPosition = true;
+            out.groundPosition = cluster.center;
+        }
+    }
+    return true;
+}
+
+bool RotationWorker::Verify(const RotationProgram& program, const WorldSnapshot& world, const RotationDecision& decision) {
+    if (decision.stepIndex < 0 || static_cast<size_t>(decision.stepIndex) >= program.steps.size()) return false;
+    size_t stepIndex = static_cast<size_t>(decision.stepIndex);
+    const CompiledStep& step = program.steps[stepIndex];
+
+    bool onCurrentTarget = step.targetType != TargetType::ENEMY || decision.targetGuid == 0 ||
+                           (world.hasTarget && world.target.guid == decision.targetGuid);
+    if (onCurrentTarget) return RotationVM::EvaluateStep(program, stepIndex, world);
+
+    const UnitSnapshot* unit = world.FindUnit(decision.targetGuid);
+    return unit && RotationVM::EvaluateStepOnUnit(program, stepIndex, world, *unit);
+}
+
+void RotationWorker::Run() {
+    uint64_t lastSequence = 0;
+    const RotationProgram* lastProgram = nullptr;
+    uint64_t lastEvents = 0;
+    ConditionCostModel& costModel = ConditionCostModel::GetInstance();
+    uint64_t reorderBase = costModel.GetSampleCount();
+
+    while (m_running.load()) {
+        auto interval = std::chrono::microseconds(1000000 / (std::max)(1, m_decisionHz.load()));
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCv.wait_for(lock, interval, [this] { return !m_running.load(); });
+        }
+        if (!m_running.load()) break;
+
+        try {
+            std::shared_ptr<const RotationProgram> program = std::atomic_load(&m_program);
+            uint64_t sequence = m_snapshotSequence.load(std::memory_order_acquire);
+            // Same snapshot and program give the same answer - nothing to do
+            if (!program || (sequence == lastSequence && program.get() == lastProgram)) {
+                m_statIdle.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            std::shared_ptr<const WorldSnapshot> snapshot = std::atomic_load(&m_snapshot);
+            if (!snapshot) {
+                m_statIdle.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            bool programChanged = program.get() != lastProgram;
+            lastSequence = sequence;
+            lastProgram = program.get();
+
+            // Readiness gating: after a pass that found nothing, sleep until the next spell is ready
+            // unless an aura or cast changed (the cooldown manager wakes on casts and target changes itself)
+            Spells::CooldownManager* cooldowns = m_cooldowns.load();
+            if (cooldowns) {
+                uint64_t events = EventSignature(*snapshot);
+                if (events != lastEvents) {
+                    lastEvents = events;
+                    cooldowns->NotifyExternalEvent();
+                }
+                if (!cooldowns->ShouldEvaluate() && !programChanged) {
+                    m_statIdle.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            // During a GCD/cast, decide for the moment it ends instead of (uselessly) for now
+            const WorldSnapshot* world = snapshot.get();
+            bool speculative = false;
+            if (m_lookahead.load() && snapshot->actionableInMs > 0) {
+                m_predicted = *snapshot;
+                m_predicted.AdvanceTime(snapshot->actionableInMs);
+                world = &m_predicted;
+                speculative = true;
+            }
+            RotationDecision& decision = m_mailbox.WriteSlot();
+            decision = RotationDecision();
+            decision.snapshotSequence = sequence;
+            decision.snapshotTimeMs = snapshot->timestampMs;
+            decision.readyAtMs = world->timestampMs;
+            decision.speculative = speculative;
+            bool castable = Decide(*program, *world, m_multiTarget.load(), decision);
+            if (!castable && cooldowns) cooldowns->DeferEvaluation();
+            if (speculative) m_statSpeculative.fetch_add(1, std::memory_order_relaxed);
+            // "Nothing castable" is posted too, so it replaces an older decision that was not taken yet
+            m_mailbox.Publish();
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            m_statDecisions.fetch_add(1, std::memory_order_relaxed);
+            m_statDecisionNs.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+
+            // The VM samples condition costs as it goes; re-sort the conditions once enough came in
+            uint64_t samples = costModel.GetSampleCount();
+            if (samples < reorderBase) reorderBase = samples; // Model was reset
+            if (samples - reorderBase >= REORDER_SAMPLES) {
+                reorderBase = samples;
+                if (ReorderConditions()) m_statReorders.fetch_add(1, std::memory_order_relaxed);
+            }
+        } catch (const std::exception& e) {
+            Core::Log::Message(std::string("[RotationWorker] Exception during decision: ") + e.what());
+        }
+    }
+}
+
+} // namespace Rotation
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include "RotationCompiler.h"
+#include "WorldSnapshot.h"
+
+namespace Spells { class CooldownManager; }
+
+namespace Rotation {
+
+struct RotationProfile;
+
+/**
+ * Lock-free single-producer / single-consumer mailbox that always holds the newest value.
+ * Three slots: the producer writes the back slot and swaps it with the middle one, the consumer
+ * swaps its front slot with the middle one when a fresh value is flagged. Neither side blocks.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer: slot to fill, then Publish()
+    T& WriteSlot() { return m_slots[m_back]; }
+    void Publish() {
+        uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+    }
+
+    // Consumer: copies the newest value if one arrived since the last call
+    bool Consume(T& out) {
+        if ((m_middle.load(std::memory_order_acquire) & FRESH) == 0) return false;
+        uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+        out = m_slots[m_front];
+        return true;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T m_slots[3];
+    uint8_t m_front = 0;               // Consumer-owned
+    uint8_t m_back = 2;                // Producer-owned
+    std::atomic<uint8_t> m_middle{ 1 };
+};
+
+// Action decided by the worker for one snapshot
+struct RotationDecision {
+    uint64_t snapshotSequence = 0;
+    uint64_t snapshotTimeMs = 0;  // WorldSnapshot::timestampMs the decision was made on
+    uint64_t readyAtMs = 0;       // When to cast (same clock); later than snapshotTimeMs for speculative decisions
+    bool speculative = false;     // Decided on the predicted state after the current GCD/cast
+    int stepIndex = -1;           // Index into RotationProfile::steps, -1 = nothing castable
+    uint32_t spellId = 0;
+    uint64_t targetGuid = 0;
+    bool requiresTarget = false;
+    bool hasGroundPosition = false; // GROUND_CLUSTER steps: cast at groundPosition
+    Vector3 groundPosition;
+};
+
+/**
+ * Runs rotation decisions on a dedicated thread.
+ * EndScene builds a WorldSnapshot (client memory is only read on the main thread) and publishes it;
+ * the worker evaluates the compiled program against the newest snapshot at its own rate and posts
+ * the result to a TripleBuffer mailbox. EndScene takes the decision, re-validates it and casts.
+ *
+ * Lookahead: while the GCD or a cast is running, the worker decides on the snapshot advanced to the
+ * moment it ends, so the next action is already waiting when EndScene reaches that frame.
+ *
+ * With a cooldown manager set, new snapshots are gated by CooldownManager::ShouldEvaluate(): a pass that
+ * finds nothing castable defers until the next spell is ready, and aura/cast changes in the snapshot wake it.
+ *
+ * Every REORDER_SAMPLES new ConditionCostModel samples, the worker recompiles the installed profile so each
+ * step's conditions follow the measured costs and failure rates, and swaps the program if the order changed.
+ */
+class RotationWorker {
+public:
+    static constexpr int DEFAULT_DECISION_HZ = 50;
+    static constexpr int MIN_DECISION_HZ = 5;
+    static constexpr int MAX_DECISION_HZ = 500;
+    static constexpr uint64_t REORDER_SAMPLES = 2000; // New cost samples between condition re-sorts
+
+    RotationWorker() = default;
+    ~RotationWorker();
+
+    RotationWorker(const RotationWorker&) = delete;
+    RotationWorker& operator=(const RotationWorker&) = delete;
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_running.load(); }
+
+    /**
+     * Set how often the worker evaluates (independent of FPS)
+     * @param hz Decisions per second, clamped to [MIN_DECISION_HZ, MAX_DECISION_HZ]
+     */
+    void SetDecisionRate(int hz);
+    int GetDecisionRate() const { return m_decisionHz.load(); }
+
+    /**
+     * Swap the compiled program (nullptr = idle). Safe to call from any thread.
+     */
+    void SetProgram(std::shared_ptr<const RotationProgram> program);
+    std::shared_ptr<const RotationProgram> GetProgram() const;
+
+    /**
+     * Whether a worker program makes the rotation's decisions (set by SetProgram). RotationEngine checks this
+     * before its own evaluation pass and skips the pass while it is set, so it queues nothing the worker replaces.
+     * @return true while a program is installed
+     */
+    static bool OwnsDecisions() { return s_ownsDecisions.load(std::memory_order_acquire); }
+
+    /**
+     * Compile a profile and make it the running program. The cooldown manager (if set) is
+     * configured for the profile's steps and switched to the program's referenced spells first,
+     * so the snapshots built for the new program carry its cooldowns. Safe to call from any thread.
+     * @param profile Profile to run
+     * @return The installed program
+     */
+    std::shared_ptr<const RotationProgram> InstallProfile(const RotationProfile& profile);
+
+    /**
+     * Recompile the installed profile with the current ConditionCostModel ranks and swap it in if any
+     * step's condition order changed (and the program was not replaced meanwhile). Runs on the worker
+     * thread every REORDER_SAMPLES samples; safe to call from any thread.
+     * @return true if a re-sorted program was swapped in
+     */
+    bool ReorderConditions();
+
+    /**
+     * Cooldown manager InstallProfile keeps in sync with the running program and whose readiness
+     * timeline gates evaluation (set once at startup)
+     */
+    void SetCooldownManager(Spells::CooldownManager* cooldowns) { m_cooldowns = cooldowns; }
+
+    /**
+     * Hand the worker a new immutable snapshot (main thread)
+     */
+    void PublishSnapshot(std::shared_ptr<const WorldSnapshot> snapshot);
+
+    /**
+     * Take the newest decision if one was posted since the last call (main thread)
+     * @param out Decision
+     * @return true if a new decision was available
+     */
+    bool TakeDecision(RotationDecision& out);
+
+    /**
+     * Main-thread pre-queue: keeps the newest decision with a spell and returns it once it is due
+     * @param nowMs Current steady clock time in milliseconds
+     * @param out Decision whose readyAtMs has been reached
+     * @return true if a decision is due
+     */
+    bool PollDecision(uint64_t nowMs, RotationDecision& out);
+
+    /**
+     * Put a due decision back (e.g. the GCD ended a few ms later than predicted). A newer decision
+     * from the worker still replaces it. Main thread.
+     */
+    void HoldDecision(const RotationDecision& decision);
+
+    /**
+     * Record whether a speculative decision still held when it became due (main thread)
+     */
+    void RecordSpeculation(bool confirmed);
+
+    void SetLookaheadEnabled(bool enabled) { m_lookahead = enabled; }
+    bool IsLookaheadEnabled() const { return m_lookahead.load(); }
+
+    // Multi-target: enemy steps are evaluated against every nearby hostile (snapshots must carry their auras)
+    void SetMultiTargetEnabled(bool enabled) { m_multiTarget = enabled; }
+    bool IsMultiTargetEnabled() const { return m_multiTarget.load(); }
+
+    /**
+     * Target GUID a compiled step should be cast on, given a snapshot.
+     * Cluster steps use the calling thread's ClusterIndex.
+     */
+    static uint64_t ResolveTargetGuid(const CompiledStep& step, const WorldSnapshot& world);
+
+    /**
+     * Pick the action for a snapshot (fills stepIndex, spellId, targetGuid, requiresTarget).
+     * Steps are tried in priority order (PriorityRanker, per calling thread) if the program is ranked.
+     * @param multiTarget Use RotationVM::FindFirstCastableStepMultiTarget
+     * @return false if nothing is castable
+     */
+    static bool Decide(const RotationProgram& program, const WorldSnapshot& world, bool multiTarget, RotationDecision& out);
+
+    /**
+     * Re-check a decision against a newer snapshot: the decided step must still pass on the decided unit
+     */
+    static bool Verify(const RotationProgram& program, const WorldSnapshot& world, const RotationDecision& decision);
+
+    struct Stats {
+        uint64_t snapshotsPublished = 0;
+        uint64_t decisions = 0;
+        uint64_t idleWakeups = 0;   // Woke up without a new snapshot or program, or deferred by the cooldown manager
+        uint64_t decisionsTaken = 0;
+        uint64_t decisionNs = 0;    // Total time spent evaluating
+        uint64_t speculative = 0;   // Decisions made on a predicted post-GCD state
+        uint64_t speculationConfirmed = 0;
+        uint64_t speculationRedecided = 0; // World diverged; EndScene re-decided on the current snapshot
+        uint64_t conditionReorders = 0;    // Programs swapped for one with re-sorted conditions
+    };
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    void Run();
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    std::atomic<int> m_decisionHz{ DEFAULT_DECISION_HZ };
+    std::atomic<bool> m_lookahead{ true };
+    std::atomic<bool> m_multiTarget{ false };
+    std::atomic<Spells::CooldownManager*> m_cooldowns{ nullptr };
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+
+    // Accessed with std::atomic_load/atomic_store
+    std::shared_ptr<const RotationProgram> m_program;
+    std::shared_ptr<const RotationProfile> m_profile; // Source of the program InstallProfile compiled
+    std::shared_ptr<const WorldSnapshot> m_snapshot;
+    std::atomic<uint64_t> m_snapshotSequence{ 0 };
+
+    TripleBuffer<RotationDecision> m_mailbox;
+    WorldSnapshot m_predicted;           // Worker thread only
+    RotationDecision m_pending;          // Main thread only
+    bool m_hasPending = false;
+
+    std::atomic<uint64_t> m_statSnapshots{ 0 };
+    std::atomic<uint64_t> m_statDecisions{ 0 };
+    std::atomic<uint64_t> m_statIdle{ 0 };
+    std::atomic<uint64_t> m_statTaken{ 0 };
+    std::atomic<uint64_t> m_statDecisionNs{ 0 };
+    std::atomic<uint64_t> m_statSpeculative{ 0 };
+    std::atomic<uint64_t> m_statSpecConfirmed{ 0 };
+    std::atomic<uint64_t> m_statSpecRedecided{ 0 };
+    std::atomic<uint64_t> m_statReorders{ 0 };
+
+    static std::atomic<bool> s_ownsDecisions;
+};
+
+} // namespace Rotation
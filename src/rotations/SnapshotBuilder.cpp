@@ -0,0 +1,142 @@
+#include "SnapshotBuilder.h"
+#include "../objectManager/ObjectManager.h"
+#include "../types/wowplayer.h"
+#include "../spells/auras.h"
+#include "../spells/cooldowns.h"
+#include "../spells/motiontracker.h"
+#include "../utils/memory.h"
+#include <chrono>
+
+namespace Rotation {
+
+namespace {
+
+void CopyAuras(WowObject* unit, std::vector<AuraSnapshot>& out) {
+    out.clear();
+    try {
+        uint32_t count = Spells::GetUnitAuraCount(unit);
+        for (uint32_t i = 0; i < count; ++i) {
+            Spells::Aura* aura = Spells::GetAuraByIndex(unit, i);
+            if (!aura || aura->spellId == 0) continue;
+            AuraSnapshot snap;
+            snap.spellId = aura->spellId;
+            snap.casterGuid = aura->casterGuid;
+            snap.stacks = aura->stackCount;
+            out.push_back(snap);
+        }
+    } catch (const MemoryAccessError&) {
+        out.clear();
+    }
+    std::sort(out.begin(), out.end(), [](const AuraSnapshot& a, const AuraSnapshot& b) { return a.spellId < b.spellId; });
+}
+
+// Hostile or unfriendly to the player. Reaction 0 means the client could not tell, not hostile.
+// Only used when the unit table has no relation bits (no classifier registered yet).
+bool ReactionHostile(WowUnit* unit, WowUnit* player) {
+    if (!player || unit == player) return false;
+    int reaction = unit->GetReaction(player);
+    return reaction >= 1 && reaction <= 2;
+}
+
+bool IsHostile(const UnitTable* table, const std::shared_ptr<WowUnit>& unit, WowUnit* player) {
+    if (table && table->hasRelations) return (table->MaskOf(unit->GetGUID64()) & UNIT_CLASS_HOSTILE) != 0;
+    return ReactionHostile(unit.get(), player);
+}
+
+void CopyUnit(const std::shared_ptr<WowUnit>& unit, bool isHostile, bool withAuras, UnitSnapshot& out) {
+    out.guid = unit->GetGUID64();
+    out.position = Spells::MotionTracker::GetInstance().PredictPosition(unit.get()); // Cached position is up to 500 ms old
+    out.facing = unit->GetFacing();
+    out.healthPercent = unit->GetHealthPercent();
+    for (uint8_t type = 0; type < PowerType::POWER_TYPE_COUNT; ++type) {
+        out.power[type] = unit->GetPowerByType(type);
+        out.maxPower[type] = unit->GetMaxPowerByType(type);
+    }
+    out.castingSpellId = unit->IsCasting() ? unit->GetCastingSpellId() : (unit->IsChanneling() ? unit->GetChannelSpellId() : 0);
+    out.isPlayer = unit->IsPlayer();
+    out.isHostile = isHostile;
+    out.isDead = unit->IsDead();
+    out.inCombat = unit->IsInCombat();
+    if (withAuras) {
+        CopyAuras(unit.get(), out.auras);
+    } else {
+        out.auras.clear();
+    }
+}
+
+} // namespace
+
+bool BuildWorldSnapshot(ObjectManager& om, Spells::CooldownManager& cdm, const std::vector<uint32_t>& spellIds,
+                        WorldSnapshot& out, float nearbyRange, bool nearbyHostileAuras) {
+    auto player = om.GetLocalPlayer();
+    if (!player) return false;
+
+    out.timestampMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    // Reaction bits from this update's classification, computed on the main thread with the rest of the table
+    std::shared_ptr<const UnitTable> table = om.GetUnitTable();
+    CopyUnit(player, false, true, out.player);
+    out.playerMoving = player->IsMoving();
+
+    auto now = std::chrono::steady_clock::now();
+    auto actionableAt = cdm.NextActionableTime();
+    out.actionableInMs = actionableAt > now
+        ? static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(actionableAt - now).count())
+        : 0;
+
+    uint64_t targetGuid = om.GetCurrentTargetGUID();
+    auto target = targetGuid != 0 ? om.GetUnitByGuid(WGUID(targetGuid)) : nullptr;
+    out.hasTarget = target != nullptr;
+    out.comboPoints = 0;
+    out.playerThreatPercent = 0.0f;
+    if (target) {
+        CopyUnit(target, IsHostile(table.get(), target, player.get()), true, out.target);
+        if (player->GetComboPointTargetGUID().ToUint64() == targetGuid) {
+            out.comboPoints = player->GetComboPoints();
+        }
+        for (const auto& entry : player->GetThreatTableEntries()) {
+            if (entry.targetGUID.ToUint64() == targetGuid) {
+                out.playerThreatPercent = static_cast<float>(entry.percentage);
+                break;
+            }
+        }
+    } else {
+        out.target = UnitSnapshot();
+    }
+
+    out.nearbyUnits.clear();
+    Vector3 playerPos = out.player.position;
+    float rangeSq = nearbyRange * nearbyRange;
+    auto addNearby = [&](const std::shared_ptr<WowUnit>& unit, bool isHostile) {
+        if (!unit || unit->GetGUID64() == out.player.guid) return;
+        if (unit->GetPosition().DistanceSq(playerPos) > rangeSq) return;
+        UnitSnapshot snap;
+        CopyUnit(unit, isHostile, false, snap);
+        if (nearbyHostileAuras && snap.isHostile && !snap.isDead) CopyAuras(unit.get(), snap.auras);
+        out.nearbyUnits.push_back(std::move(snap));
+    };
+    if (table && table->hasRelations) {
+        for (size_t i = 0; i < table->units.size(); ++i) {
+            addNearby(table->units[i], (table->masks[i] & UNIT_CLASS_HOSTILE) != 0);
+        }
+    } else {
+        for (const auto& unit : om.GetAllUnits()) {
+            if (unit) addNearby(unit, ReactionHostile(unit.get(), player.get()));
+        }
+    }
+
+    out.spells.clear();
+    out.spells.reserve(spellIds.size());
+    for (uint32_t spellId : spellIds) {
+        SpellStateSnapshot spell;
+        spell.spellId = spellId;
+        spell.cooldownMs = cdm.GetRemainingCooldown(static_cast<int>(spellId));
+        spell.charges = cdm.GetCharges(static_cast<int>(spellId));
+        out.spells.push_back(spell);
+    }
+    std::sort(out.spells.begin(), out.spells.end(),
+              [](const SpellStateSnapshot& a, const SpellStateSnapshot& b) { return a.spellId < b.spellId; });
+    return true;
+}
+
+} // namespace Rotation
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "WorldSnapshot.h"
+
+class ObjectManager;
+namespace Spells { class CooldownManager; }
+
+namespace Rotation {
+
+// Default radius for units copied into WorldSnapshot::nearbyUnits (max spell range in 3.3.5)
+constexpr float SNAPSHOT_NEARBY_RANGE = 40.0f;
+
+/**
+ * Fill a WorldSnapshot from the ObjectManager cache, the unit aura tables and the CooldownManager.
+ * Reads client memory - call on the main thread (EndScene).
+ * @param om Object manager (cache must be up to date for this frame)
+ * @param cdm Cooldown manager (cooldown table must be refreshed for this frame)
+ * @param spellIds Spells whose cooldown/charges are needed (usually RotationProgram::referencedSpells)
+ * @param out Snapshot to fill (reuses its vectors' capacity)
+ * @param nearbyRange Radius around the player for nearbyUnits
+ * @param nearbyHostileAuras Also copy the auras of hostile nearby units (multi-target evaluation)
+ * @return false if there is no local player
+ */
+bool BuildWorldSnapshot(ObjectManager& om, Spells::CooldownManager& cdm, const std::vector<uint32_t>& spellIds,
+                        WorldSnapshot& out, float nearbyRange = SNAPSHOT_NEARBY_RANGE, bool nearbyHostileAuras = false);
+
+} // namespace Rotation
@@ -0,0 +1,156 @@
+#include "WorldSnapshot.h"
+#include <fstream>
+
+namespace Rotation {
+
+void WorldSnapshot::SortForLookup() {
+    auto byAura = [](const AuraSnapshot& a, const AuraSnapshot& b) { return a.spellId < b.spellId; };
+    std::sort(player.auras.begin(), player.auras.end(), byAura);
+    std::sort(target.auras.begin(), target.auras.end(), byAura);
+    for (auto& unit : nearbyUnits) std::sort(unit.auras.begin(), unit.auras.end(), byAura);
+    std::sort(spells.begin(), spells.end(),
+              [](const SpellStateSnapshot& a, const SpellStateSnapshot& b) { return a.spellId < b.spellId; });
+}
+
+void WorldSnapshot::AdvanceTime(uint32_t ms) {
+    timestampMs += ms;
+    for (auto& spell : spells) {
+        spell.cooldownMs = (std::max)(0, spell.cooldownMs - static_cast<int>(ms));
+    }
+    if (ms >= actionableInMs) {
+        actionableInMs = 0;
+        player.castingSpellId = 0;
+    } else {
+        actionableInMs -= ms;
+    }
+}
+
+namespace {
+
+nlohmann::json UnitToJson(const UnitSnapshot& unit) {
+    nlohmann::json auras = nlohmann::json::array();
+    for (const auto& aura : unit.auras) {
+        auras.push_back({ {"id", aura.spellId}, {"caster", aura.casterGuid}, {"stacks", aura.stacks} });
+    }
+    return {
+        {"guid", unit.guid},
+        {"pos", { unit.position.x, unit.position.y, unit.position.z }},
+        {"facing", unit.facing},
+        {"health", unit.healthPercent},
+        {"power", std::vector<int>(std::begin(unit.power), std::end(unit.power))},
+        {"maxPower", std::vector<int>(std::begin(unit.maxPower), std::end(unit.maxPower))},
+        {"casting", unit.castingSpellId},
+        {"isPlayer", unit.isPlayer},
+        {"hostile", unit.isHostile},
+        {"dead", unit.isDead},
+        {"combat", unit.inCombat},
+        {"auras", auras}
+    };
+}
+
+void UnitFromJson(const nlohmann::json& j, UnitSnapshot& unit) {
+    unit.guid = j.value("guid", 0ULL);
+    if (j.contains("pos") && j["pos"].is_array() && j["pos"].size() == 3) {
+        unit.position = Vector3(j["pos"][0].get<float>(), j["pos"][1].get<float>(), j["pos"][2].get<float>());
+    }
+    unit.facing = j.value("facing", 0.0f);
+    unit.healthPercent = j.value("health", 0.0f);
+    if (j.contains("power")) {
+        auto power = j["power"].get<std::vector<int>>();
+        for (size_t i = 0; i < power.size() && i < PowerType::POWER_TYPE_COUNT; ++i) unit.power[i] = power[i];
+    }
+    if (j.contains("maxPower")) {
+        auto maxPower = j["maxPower"].get<std::vector<int>>();
+        for (size_t i = 0; i < maxPower.size() && i < PowerType::POWER_TYPE_COUNT; ++i) unit.maxPower[i] = maxPower[i];
+    }
+    unit.castingSpellId = j.value("casting", 0u);
+    unit.isPlayer = j.value("isPlayer", false);
+    unit.isHostile = j.value("hostile", false);
+    unit.isDead = j.value("dead", false);
+    unit.inCombat = j.value("combat", false);
+    unit.auras.clear();
+    if (j.contains("auras")) {
+        for (const auto& a : j["auras"]) {
+            AuraSnapshot aura;
+            aura.spellId = a.value("id", 0u);
+            aura.casterGuid = a.value("caster", 0ULL);
+            aura.stacks = a.value("stacks", static_cast<uint8_t>(0));
+            unit.auras.push_back(aura);
+        }
+    }
+}
+
+} // namespace
+
+void to_json(nlohmann::json& j, const WorldSnapshot& snapshot) {
+    nlohmann::json nearby = nlohmann::json::array();
+    for (const auto& unit : snapshot.nearbyUnits) nearby.push_back(UnitToJson(unit));
+    nlohmann::json spells = nlohmann::json::array();
+    for (const auto& spell : snapshot.spells) {
+        spells.push_back({ {"id", spell.spellId}, {"cd", spell.cooldownMs}, {"charges", spell.charges} });
+    }
+    j = {
+        {"time", snapshot.timestampMs},
+        {"player", UnitToJson(snapshot.player)},
+        {"hasTarget", snapshot.hasTarget},
+        {"target", UnitToJson(snapshot.target)},
+        {"nearby", nearby},
+        {"spells", spells},
+        {"combo", snapshot.comboPoints},
+        {"threat", snapshot.playerThreatPercent},
+        {"moving", snapshot.playerMoving},
+        {"actionableIn", snapshot.actionableInMs}
+    };
+}
+
+void from_json(const nlohmann::json& j, WorldSnapshot& snapshot) {
+    snapshot.timestampMs = j.value("time", 0ULL);
+    if (j.contains("player")) UnitFromJson(j["player"], snapshot.player);
+    snapshot.hasTarget = j.value("hasTarget", false);
+    if (j.contains("target")) UnitFromJson(j["target"], snapshot.target);
+    snapshot.nearbyUnits.clear();
+    if (j.contains("nearby")) {
+        for (const auto& u : j["nearby"]) {
+            UnitSnapshot unit;
+            UnitFromJson(u, unit);
+            snapshot.nearbyUnits.push_back(std::move(unit));
+        }
+    }
+    snapshot.spells.clear();
+    if (j.contains("spells")) {
+        for (const auto& s : j["spells"]) {
+            SpellStateSnapshot spell;
+            spell.spellId = s.value("id", 0u);
+            spell.cooldownMs = s.value("cd", 0);
+            spell.charges = s.value("charges", 1);
+            snapshot.spells.push_back(spell);
+        }
+    }
+    snapshot.comboPoints = j.value("combo", static_cast<uint8_t>(0));
+    snapshot.playerThreatPercent = j.value("threat", 0.0f);
+    snapshot.playerMoving = j.value("moving", false);
+    snapshot.actionableInMs = j.value("actionableIn", 0u);
+    snapshot.SortForLookup();
+}
+
+bool SaveSnapshots(const std::string& path, const std::vector<WorldSnapshot>& snapshots) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    nlohmann::json j = snapshots;
+    out << j.dump();
+    return out.good();
+}
+
+bool LoadSnapshots(const std::string& path, std::vector<WorldSnapshot>& snapshots) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    try {
+        nlohmann::json j = nlohmann::json::parse(in);
+        snapshots = j.get<std::vector<WorldSnapshot>>();
+        return true;
+    } catch (const nlohmann::json::exception&) {
+        return false;
+    }
+}
+
+} // namespace Rotation
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include "../types/types.h"
+#include "nlohmann/json.hpp"
+
+namespace Rotation {
+
+// Plain-data copy of the game state a rotation decision needs.
+// Built once per decision on the main thread (see SnapshotBuilder.h); evaluating against it
+// never touches client memory, so it can run on another thread or offline on recorded snapshots.
+
+struct AuraSnapshot {
+    uint32_t spellId = 0;
+    uint64_t casterGuid = 0;
+    uint8_t stacks = 0;
+};
+
+struct UnitSnapshot {
+    uint64_t guid = 0;
+    Vector3 position;
+    float facing = 0.0f;          // Radians [0, 2*PI)
+    float healthPercent = 0.0f;
+    int power[PowerType::POWER_TYPE_COUNT] = { 0 };
+    int maxPower[PowerType::POWER_TYPE_COUNT] = { 0 };
+    uint32_t castingSpellId = 0;  // 0 if not casting/channeling
+    bool isPlayer = false;
+    bool isHostile = false;       // Hostile to the local player
+    bool isDead = false;
+    bool inCombat = false;
+    std::vector<AuraSnapshot> auras; // Sorted by spellId
+
+    float GetPowerPercent(int powerType) const {
+        if (powerType < 0 || powerType >= PowerType::POWER_TYPE_COUNT || maxPower[powerType] <= 0) return 0.0f;
+        return 100.0f * static_cast<float>(power[powerType]) / static_cast<float>(maxPower[powerType]);
+    }
+
+    // Returns the first aura with this spellId that satisfies stacks/caster, or nullptr
+    const AuraSnapshot* FindAura(uint32_t spellId, int minStacks = 0, uint64_t casterGuid = 0) const {
+        auto it = std::lower_bound(auras.begin(), auras.end(), spellId,
+                                   [](const AuraSnapshot& a, uint32_t id) { return a.spellId < id; });
+        for (; it != auras.end() && it->spellId == spellId; ++it) {
+            if (casterGuid != 0 && it->casterGuid != casterGuid) continue;
+            if (minStacks > 0 && it->stacks < minStacks) continue;
+            return &(*it);
+        }
+        return nullptr;
+    }
+};
+
+struct SpellStateSnapshot {
+    uint32_t spellId = 0;
+    int cooldownMs = 0; // Remaining cooldown (incl. GCD), 0 if ready
+    int charges = 1;    // Available charges (1/0 for normal spells)
+};
+
+struct WorldSnapshot {
+    uint64_t timestampMs = 0;
+    UnitSnapshot player;
+    bool hasTarget = false;
+    UnitSnapshot target;
+    std::vector<UnitSnapshot> nearbyUnits;  // Other units for area counts; hostile ones carry auras when built for multi-target
+    std::vector<SpellStateSnapshot> spells; // Sorted by spellId
+    uint8_t comboPoints = 0;                // On the current target
+    float playerThreatPercent = 0.0f;       // Player's threat on the current target
+    bool playerMoving = false;
+    uint32_t actionableInMs = 0;            // Until the GCD and the player's cast/channel end (0 = can act now)
+
+    const SpellStateSnapshot* FindSpell(uint32_t spellId) const {
+        auto it = std::lower_bound(spells.begin(), spells.end(), spellId,
+                                   [](const SpellStateSnapshot& s, uint32_t id) { return s.spellId < id; });
+        return (it != spells.end() && it->spellId == spellId) ? &(*it) : nullptr;
+    }
+
+    // Current target or a nearby unit by GUID, nullptr if not in the snapshot
+    const UnitSnapshot* FindUnit(uint64_t guid) const {
+        if (guid == 0) return nullptr;
+        if (guid == player.guid) return &player;
+        if (hasTarget && guid == target.guid) return &target;
+        for (const auto& unit : nearbyUnits) {
+            if (unit.guid == guid) return &unit;
+        }
+        return nullptr;
+    }
+
+    // Restores the sort order required by FindAura/FindSpell after filling the vectors by hand
+    void SortForLookup();
+
+    // Predicted state `ms` later, assuming nothing but time passes: cooldowns and actionableInMs
+    // count down, and the player's cast finishes once actionableInMs runs out
+    void AdvanceTime(uint32_t ms);
+};
+
+// JSON (de)serialization so snapshots can be recorded in game and replayed offline
+void to_json(nlohmann::json& j, const WorldSnapshot& snapshot);
+void from_json(const nlohmann::json& j, WorldSnapshot& snapshot);
+
+bool SaveSnapshots(const std::string& path, const std::vector<WorldSnapshot>& snapshots);
+bool LoadSnapshots(const std::string& path, std::vector<WorldSnapshot>& snapshots);
+
+} // namespace Rotation
@@ -11,6 +11,15 @@ typedef char (__cdecl* CastLocalPlayerSpell_t)(int spellId, int unknown, uint64_
 // Define the function pointer at the specified address
 CastLocalPlayerSpell_t CastLocalPlayerSpell_ptr = (CastLocalPlayerSpell_t)0x0080DA40;
 
+// Event the world frame hands to Spell_C_HandleTerrainClick when the player clicks the ground while targeting
+struct TerrainClickEvent {
+    uint64_t guid;   // 0 for terrain
+    float x, y, z;
+    uint32_t button; // 1 = left
+};
+typedef char (__cdecl* HandleTerrainClick_t)(TerrainClickEvent* click);
+HandleTerrainClick_t HandleTerrainClick_ptr = (HandleTerrainClick_t)0x0080C340;
+
 namespace Spells {
 
 bool CastSpell(int spellId, uint64_t targetGuid, bool requiresTarget) {
@@ -74,6 +83,25 @@ bool CastSpell(int spellId, uint64_t targetGuid, bool requiresTarget) {
     }
 }
 
+bool CastSpellAtPosition(int spellId, const Vector3& position) {
+    try {
+        // Starting a ground-targeted spell only arms the targeting cursor; the click below places it
+        CastLocalPlayerSpell_ptr(spellId, 0, 0, 0);
+
+        TerrainClickEvent click = {};
+        click.guid = 0;
+        click.x = position.x;
+        click.y = position.y;
+        click.z = position.z;
+        click.button = 1;
+        return HandleTerrainClick_ptr(&click) != 0;
+    }
+    catch (...) {
+        Core::Log::Message("CastSpellAtPosition: Exception occurred during cast!");
+        return false;
+    }
+}
+
 // Simplified SpellExists implementation
 bool SpellExists(int spellId) {
     // In a full implementation, this would check the player's spell book.
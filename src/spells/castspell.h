@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include "../types/types.h"
 
 namespace Spells {
 
@@ -10,6 +11,12 @@ namespace Spells {
 // Returns true on success (based on char return type), false otherwise.
 bool CastSpell(int spellId, uint64_t targetGuid, bool requiresTarget);
 
+// Address: 0x0080C340 (Spell_C_HandleTerrainClick)
+// Casts a ground-targeted spell (Blizzard, Death and Decay, ...) at a world position: starts the cast,
+// which puts the client into targeting mode, then places it with a left click on the terrain at `position`.
+// Returns true if the click was accepted.
+bool CastSpellAtPosition(int spellId, const Vector3& position);
+
 // Check if spell exists in player's spellbook
 bool SpellExists(int spellId);
 
@@ -0,0 +1,93 @@
+#include "charges.h"
+#include <algorithm>
+
+namespace Spells {
+
+void ChargeTracker::Configure(int spellId, int maxCharges, int rechargeMs) {
+    if (spellId <= 0) return;
+    if (maxCharges <= 1 || rechargeMs <= 0) {
+        m_states.erase(spellId);
+        return;
+    }
+
+    auto it = m_states.find(spellId);
+    if (it == m_states.end()) {
+        ChargeState state;
+        state.maxCharges = maxCharges;
+        state.rechargeMs = rechargeMs;
+        state.charges = maxCharges; // Assume full until a cast or cooldown read says otherwise
+        m_states.emplace(spellId, state);
+        return;
+    }
+
+    ChargeState& state = it->second;
+    state.maxCharges = maxCharges;
+    state.rechargeMs = rechargeMs;
+    state.charges = (std::min)(state.charges, maxCharges);
+}
+
+void ChargeTracker::OnSpellCast(int spellId, Clock::time_point now) {
+    auto it = m_states.find(spellId);
+    if (it == m_states.end()) return;
+
+    ChargeState& state = it->second;
+    Advance(state, now);
+    if (state.charges == state.maxCharges) {
+        // Recharge starts with the first charge spent
+        state.nextChargeAt = now + std::chrono::milliseconds(state.rechargeMs);
+    }
+    if (state.charges > 0) {
+        --state.charges;
+    }
+}
+
+void ChargeTracker::OnCooldownRead(int spellId, int remainingMs, int gcdMs, Clock::time_point now) {
+    auto it = m_states.find(spellId);
+    if (it == m_states.end() || remainingMs < 0) return;
+
+    ChargeState& state = it->second;
+    Advance(state, now);
+
+    if (remainingMs > gcdMs) {
+        // Client says the spell is locked by its own cooldown: out of charges
+        state.charges = 0;
+        state.nextChargeAt = now + std::chrono::milliseconds(remainingMs);
+    } else if (remainingMs == 0 && state.charges == 0) {
+        // Client says usable: the model is behind, at least one charge is back
+        state.charges = 1;
+        if (state.charges < state.maxCharges) {
+            state.nextChargeAt = now + std::chrono::milliseconds(state.rechargeMs);
+        }
+    }
+}
+
+int ChargeTracker::GetCharges(int spellId, Clock::time_point now) {
+    auto it = m_states.find(spellId);
+    if (it == m_states.end()) return -1;
+    Advance(it->second, now);
+    return it->second.charges;
+}
+
+int ChargeTracker::TimeToNextCharge(int spellId, Clock::time_point now) {
+    auto it = m_states.find(spellId);
+    if (it == m_states.end()) return 0;
+
+    ChargeState& state = it->second;
+    Advance(state, now);
+    if (state.charges >= state.maxCharges) return 0;
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(state.nextChargeAt - now).count();
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+void ChargeTracker::Advance(ChargeState& state, Clock::time_point now) {
+    // Bounded by maxCharges iterations
+    while (state.charges < state.maxCharges && now >= state.nextChargeAt) {
+        ++state.charges;
+        if (state.charges < state.maxCharges) {
+            state.nextChargeAt += std::chrono::milliseconds(state.rechargeMs);
+        }
+    }
+}
+
+}
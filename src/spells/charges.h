@@ -0,0 +1,85 @@
+#pragma once
+
+#include <unordered_map>
+#include <chrono>
+
+namespace Spells {
+
+/**
+ * Models charge-based spells (RotationStep::maxCharges / rechargeTime).
+ * The 3.3.5 client has no charge API, so charges are simulated from cast events and
+ * corrected from cooldown reads. Queries are answered from cached state; recharges are
+ * applied lazily when a spell is looked at.
+ *
+ * Not thread-safe on its own - CooldownManager owns it and guards it with its mutex.
+ */
+class ChargeTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Configure a spell as charge-based. Re-configuring keeps the current charge count (clamped).
+     * @param spellId The ID of the spell
+     * @param maxCharges Maximum number of charges (values <= 1 remove the spell from the tracker)
+     * @param rechargeMs Time to regain one charge in milliseconds
+     */
+    void Configure(int spellId, int maxCharges, int rechargeMs);
+
+    /**
+     * Remove all configured spells
+     */
+    void Clear() { m_states.clear(); }
+
+    /**
+     * @return true if the spell was configured with more than one charge
+     */
+    bool IsTracked(int spellId) const { return m_states.count(spellId) > 0; }
+
+    /**
+     * Consume a charge after a successful cast
+     * @param spellId The ID of the spell
+     * @param now Time of the cast
+     */
+    void OnSpellCast(int spellId, Clock::time_point now);
+
+    /**
+     * Correct the model from the client's cooldown for the spell. A cooldown longer than the GCD
+     * means no charge is left; a ready spell means at least one charge is available.
+     * @param spellId The ID of the spell
+     * @param remainingMs Remaining cooldown reported by the client
+     * @param gcdMs Current GCD length, to tell a GCD lockout from a real recharge
+     * @param now Time of the read
+     */
+    void OnCooldownRead(int spellId, int remainingMs, int gcdMs, Clock::time_point now);
+
+    /**
+     * Get the current number of charges
+     * @param spellId The ID of the spell
+     * @param now Current time
+     * @return Number of charges, or -1 if the spell is not tracked
+     */
+    int GetCharges(int spellId, Clock::time_point now);
+
+    /**
+     * Get the time until the next charge is regained
+     * @param spellId The ID of the spell
+     * @param now Current time
+     * @return Milliseconds until the next charge (0 if full or not tracked)
+     */
+    int TimeToNextCharge(int spellId, Clock::time_point now);
+
+private:
+    struct ChargeState {
+        int maxCharges = 1;
+        int rechargeMs = 0;
+        int charges = 1;
+        Clock::time_point nextChargeAt{}; // Only meaningful while charges < maxCharges
+    };
+
+    // Apply all recharges that completed before 'now'
+    static void Advance(ChargeState& state, Clock::time_point now);
+
+    std::unordered_map<int, ChargeState> m_states;
+};
+
+}
@@ -0,0 +1,35 @@
+#include "cooldowns.h"
+#include "../objectManager/ObjectManager.h"
+#include "../types/wowplayer.h"
+#include "../utils/memory.h"
+
+// Player state reads of CooldownManager::Update (ObjectManager, client memory). In their own file so tests can
+// link cooldowns.cpp with scripted reads instead.
+
+namespace Spells {
+
+void CooldownManager::ReadPlayerState(FrameReads& reads) {
+    ObjectManager* objMgr = ObjectManager::GetInstance();
+    if (!objMgr || !objMgr->IsInitialized()) return;
+
+    reads.hasWorld = true;
+    reads.targetGuid = objMgr->GetCurrentTargetGUID();
+
+    auto player = objMgr->GetLocalPlayer();
+    if (!player || player->GetBaseAddress() == 0) return;
+
+    for (uint8_t powerType : player->GetActivePowerTypes()) {
+        reads.powers.emplace_back(powerType, player->GetPowerByType(powerType));
+    }
+
+    // Read directly instead of using the cached fields - those are only refreshed every ObjectManager::Update (500ms)
+    try {
+        reads.castingId = Memory::Read<uint32_t>(player->GetBaseAddress() + Offsets::OBJECT_CASTING_ID);
+        reads.channelId = Memory::Read<uint32_t>(player->GetBaseAddress() + Offsets::OBJECT_CHANNEL_ID);
+        reads.castStateValid = true;
+    } catch (const MemoryAccessError&) {
+        // Player object went away (loading screen etc.) - skip this frame
+    }
+}
+
+}
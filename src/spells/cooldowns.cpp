@@ -1,82 +1,350 @@
 #include "cooldowns.h"
 #include "SpellManager.h"
+#include "spellinfo.h"
+#include "../types/Rotation.h"
 // #include "logs/log.h" // Ensure Log.h is included for Core::Log
 // #include <sstream>   // For std::stringstream
 #include <Windows.h> // For OutputDebugStringA
 
 namespace Spells {
 
-void CooldownManager::RecordSpellCast(int spellId) {
+void CooldownManager::RecordSpellCast(int spellId, bool succeeded) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+    m_gcdModel.OnCastAttempt(spellId, succeeded, now);
+    if (!succeeded) {
+        // Nothing was cast - keep the spell available for the next decision
+        return;
+    }
+
     // Record cast time for debugging and GCD tracking
-    spellLastCastTime[spellId] = std::chrono::steady_clock::now();
-    
+    spellLastCastTime[spellId] = now;
+    m_chargeTracker.OnSpellCast(spellId, now);
+
+    // The cached entry for this spell is stale now - force a client read on next query
+    auto it = m_cooldownTable.find(spellId);
+    if (it != m_cooldownTable.end()) {
+        it->second.frame = 0;
+    }
+
+    // Something happened - re-evaluate on the next tick
+    m_wakeRequested = true;
+
     // Removed logging - no more cast logs
 }
 
+void CooldownManager::Update() {
+    // Read the client first without holding m_mutex, so worker-thread queries never wait on memory reads
+    FrameReads reads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        reads.cooldowns.reserve(m_trackedSpells.size());
+        for (int spellId : m_trackedSpells) {
+            reads.cooldowns.emplace_back(spellId, 0);
+        }
+    }
+    for (auto& cooldown : reads.cooldowns) {
+        cooldown.second = SpellManager::GetSpellCooldownMs(cooldown.first);
+    }
+    ReadPlayerState(reads);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_frame;
+    m_stats.frame = m_frame;
+    m_stats.clientCalls += reads.cooldowns.size();
+
+    auto now = std::chrono::steady_clock::now();
+    if (reads.castStateValid) {
+        m_gcdModel.ObserveCastState(reads.castingId, reads.channelId, now);
+    }
+    for (const auto& cooldown : reads.cooldowns) {
+        // Skip spells dropped by TrackProfileSpells() while we were reading
+        if (m_trackedSpells.count(cooldown.first)) {
+            ApplyCooldownRead(cooldown.first, cooldown.second, now);
+        }
+    }
+    UpdateReadiness(reads, now);
+}
+
+void CooldownManager::UpdateReadiness(const FrameReads& reads, std::chrono::steady_clock::time_point now) {
+    if (reads.hasWorld) {
+        // Target changes invalidate every decision
+        if (reads.targetGuid != m_lastTargetGuid) {
+            m_lastTargetGuid = reads.targetGuid;
+            m_wakeRequested = true;
+        }
+
+        for (const auto& power : reads.powers) {
+            m_readiness.ObservePower(power.first, power.second, now);
+        }
+    }
+
+    // Cast/channel started or ended
+    bool castInProgress = m_gcdModel.IsCastInProgress();
+    if (castInProgress != m_lastCastInProgress) {
+        m_lastCastInProgress = castInProgress;
+        m_wakeRequested = true;
+    }
+
+    auto globalReady = m_gcdModel.NextActionableTime();
+    for (int spellId : m_trackedSpells) {
+        auto readyAt = globalReady;
+        auto it = m_cooldownTable.find(spellId);
+        if (it != m_cooldownTable.end() && it->second.valid) {
+            readyAt = (std::max)(readyAt, it->second.readyAt);
+        }
+        if (m_chargeTracker.IsTracked(spellId) && m_chargeTracker.GetCharges(spellId, now) == 0) {
+            readyAt = (std::max)(readyAt, now + std::chrono::milliseconds(m_chargeTracker.TimeToNextCharge(spellId, now)));
+        }
+        m_readiness.Schedule(spellId, readyAt, now);
+    }
+    m_stats.pendingSpells = m_readiness.GetPendingCount();
+}
+
+void CooldownManager::TrackProfileSpells(const std::vector<uint32_t>& spellIds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trackedSpells.clear();
+    for (uint32_t spellId : spellIds) {
+        if (spellId != 0) {
+            m_trackedSpells.insert(static_cast<int>(spellId));
+        }
+    }
+    for (auto it = m_cooldownTable.begin(); it != m_cooldownTable.end();) {
+        it = m_trackedSpells.count(it->first) ? std::next(it) : m_cooldownTable.erase(it);
+    }
+    m_readiness.Clear();
+    m_wakeRequested = true;
+    m_stats.trackedSpells = m_trackedSpells.size();
+}
+
+void CooldownManager::ConfigureProfileSpells(const Rotation::RotationProfile& profile) {
+    // Look up cast times before locking (SpellInfoCache only returns spells resolved earlier, it never reads the client)
+    std::vector<std::pair<int, int>> baseCastTimes;
+    baseCastTimes.reserve(profile.steps.size());
+    for (const auto& step : profile.steps) {
+        if (step.spellId == 0) continue;
+        // Prefer the client's base cast time; profile cast times are in seconds
+        SpellInfo info;
+        int baseCastMs = SpellInfoCache::GetInstance().Get(step.spellId, info) && info.HasCastTime()
+            ? info.castTimeMs
+            : static_cast<int>(step.castTime * 1000.0f);
+        baseCastTimes.emplace_back(static_cast<int>(step.spellId), baseCastMs);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_chargeTracker.Clear();
+    for (const auto& castTime : baseCastTimes) {
+        m_gcdModel.SetBaseCastTime(castTime.first, castTime.second);
+    }
+    for (const auto& step : profile.steps) {
+        if (step.spellId == 0) continue;
+        m_readiness.SetSpellCost(static_cast<int>(step.spellId), Rotation::PowerTypeFromResource(step.resourceType), step.manaCost);
+        if (step.maxCharges > 1 && step.rechargeTime > 0.0f) {
+            // Profile recharge times are in seconds
+            m_chargeTracker.Configure(static_cast<int>(step.spellId), step.maxCharges, static_cast<int>(step.rechargeTime * 1000.0f));
+        }
+    }
+}
+
+void CooldownManager::TrackSpell(int spellId) {
+    if (spellId <= 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trackedSpells.insert(spellId);
+    m_stats.trackedSpells = m_trackedSpells.size();
+}
+
+void CooldownManager::ClearTrackedSpells() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trackedSpells.clear();
+    m_cooldownTable.clear();
+    m_chargeTracker.Clear();
+    m_readiness.Clear();
+    m_wakeRequested = true;
+    m_stats.trackedSpells = 0;
+}
+
+CooldownManager::CacheStats CooldownManager::GetCacheStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void CooldownManager::ResetCacheStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.hits = 0;
+    m_stats.misses = 0;
+    m_stats.clientCalls = 0;
+    m_stats.evaluationsRun = 0;
+    m_stats.evaluationsSkipped = 0;
+}
+
+const CooldownManager::CooldownEntry& CooldownManager::ApplyCooldownRead(int spellId, int remainingMs, std::chrono::steady_clock::time_point now) {
+    CooldownEntry& entry = m_cooldownTable[spellId];
+    entry.valid = remainingMs >= 0; // -1 means the client call failed
+    entry.readyAt = now + std::chrono::milliseconds(remainingMs > 0 ? remainingMs : 0);
+    entry.frame = m_frame;
+    m_gcdModel.OnCooldownRead(spellId, remainingMs, now);
+    m_chargeTracker.OnCooldownRead(spellId, remainingMs, m_gcdModel.GetGcdMs(), now);
+    return entry;
+}
+
+int CooldownManager::GetGameCooldownMs(int spellId, std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point now) {
+    auto it = m_cooldownTable.find(spellId);
+    if (it != m_cooldownTable.end() && it->second.frame == m_frame && m_frame != 0) {
+        ++m_stats.hits;
+        if (!it->second.valid) return -1;
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(it->second.readyAt - now).count();
+        return remaining > 0 ? static_cast<int>(remaining) : 0;
+    }
+
+    // Miss: read it now (without the lock) and keep refreshing it every frame from here on
+    ++m_stats.misses;
+    ++m_stats.clientCalls;
+    if (m_trackedSpells.insert(spellId).second) {
+        m_stats.trackedSpells = m_trackedSpells.size();
+    }
+    lock.unlock();
+    int remainingMs = SpellManager::GetSpellCooldownMs(spellId);
+    lock.lock();
+    const CooldownEntry& entry = ApplyCooldownRead(spellId, remainingMs, now);
+    if (!entry.valid) return -1;
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(entry.readyAt - now).count();
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+int CooldownManager::GetLocalGcdRemainingMs(int spellId, std::chrono::steady_clock::time_point now) const {
+    auto it = spellLastCastTime.find(spellId);
+    if (it == spellLastCastTime.end()) return 0;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second);
+    // If less than one (learned) GCD has passed since last cast, consider it on GCD
+    int gcdMs = m_gcdModel.GetGcdMs();
+    if (elapsed.count() < gcdMs) {
+        return gcdMs - static_cast<int>(elapsed.count());
+    }
+    return 0;
+}
+
+std::chrono::steady_clock::time_point CooldownManager::NextActionableTime() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gcdModel.NextActionableTime();
+}
+
+int CooldownManager::GetGcdMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gcdModel.GetGcdMs();
+}
+
+float CooldownManager::GetHasteFactor() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gcdModel.GetHasteFactor();
+}
+
+int CooldownManager::GetCastTimeMs(int spellId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gcdModel.GetCastTimeMs(spellId);
+}
+
+void CooldownManager::GetCastCounters(uint64_t& outSucceeded, uint64_t& outFailed) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    outSucceeded = m_gcdModel.GetSuccessfulCasts();
+    outFailed = m_gcdModel.GetFailedCasts();
+}
+
 bool CooldownManager::IsSpellOnCooldown(int spellId) {
-    // std::stringstream ss_cd_check; // Use a stringstream for structured logging
-    // ss_cd_check << "[CooldownCheck] Checking SpellID: " << spellId;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    // Use WoW's internal cooldown system, answered from the per-frame table
+    int remainingCooldownMs = GetGameCooldownMs(spellId, lock, now);
 
-    // Use WoW's internal cooldown system via SpellManager
-    int remainingCooldownMs = SpellManager::GetSpellCooldownMs(spellId);
-    // ss_cd_check << ", GameCD_Ms: " << remainingCooldownMs;
-    
     // If cooldown is reported by the game, use that
     if (remainingCooldownMs > 0) {
-        // ss_cd_check << ". Result: true (Game reports cooldown).";
-        // OutputDebugStringA(ss_cd_check.str().c_str()); // Direct debug output
-        // Core::Log::Message(ss_cd_check.str());
         return true;
     }
-    
-    // If the game says spell is ready, check for GCD (basic 1.5s rule)
+
+    // If the game says spell is ready, check for GCD (learned GCD length)
     // This is a safety check in case WoW's cooldown system doesn't properly report GCD
-    if (spellLastCastTime.count(spellId) > 0) {
-        auto now = std::chrono::steady_clock::now();
-        auto lastCastPoint = spellLastCastTime[spellId]; // Get the time point
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastCastPoint);
-        
-        // ss_cd_check << ", GCD_Check: lastCastTime found, Elapsed_Ms: " << elapsed.count();
-
-        // If less than 1.5s has passed since last cast, consider it on GCD
-        if (elapsed.count() < 1500) {
-            // ss_cd_check << ". Result: true (GCD active < 1500ms).";
-            // OutputDebugStringA(ss_cd_check.str().c_str()); // Direct debug output
-            // Core::Log::Message(ss_cd_check.str());
-            return true;
-        }
-        // ss_cd_check << " (GCD > 1500ms)";
-    } // else {
-        // ss_cd_check << ", GCD_Check: No lastCastTime recorded for this spell.";
-    // }
-    
-    // Not on cooldown
-    // ss_cd_check << ". Result: false (Not on game CD, not on GCD).";
-    // OutputDebugStringA(ss_cd_check.str().c_str()); // Direct debug output
-    // Core::Log::Message(ss_cd_check.str());
-    return false;
+    return GetLocalGcdRemainingMs(spellId, now) > 0;
 }
 
 int CooldownManager::GetRemainingCooldown(int spellId) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+
     // Always use the game's cooldown data first
-    int gameCooldown = SpellManager::GetSpellCooldownMs(spellId);
+    int gameCooldown = GetGameCooldownMs(spellId, lock, now);
     if (gameCooldown > 0) {
         return gameCooldown;
     }
-    
+
     // Check GCD
-    if (spellLastCastTime.count(spellId) > 0) {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - spellLastCastTime[spellId]);
-        
-        // If within GCD window, return remaining GCD time
-        if (elapsed.count() < 1500) {
-            return 1500 - static_cast<int>(elapsed.count());
-        }
+    return GetLocalGcdRemainingMs(spellId, now);
+}
+
+int CooldownManager::GetCharges(int spellId) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    int charges = m_chargeTracker.GetCharges(spellId, now);
+    if (charges >= 0) {
+        return charges;
     }
-    
-    // Not on cooldown
-    return 0;
+
+    // Not a charge spell: one "charge" when ready
+    return GetGameCooldownMs(spellId, lock, now) > 0 ? 0 : 1;
+}
+
+int CooldownManager::TimeToNextCharge(int spellId) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    if (m_chargeTracker.IsTracked(spellId)) {
+        return m_chargeTracker.TimeToNextCharge(spellId, now);
+    }
+
+    int remaining = GetGameCooldownMs(spellId, lock, now);
+    return remaining > 0 ? remaining : 0;
+}
+
+void CooldownManager::ConfigureCharges(int spellId, int maxCharges, int rechargeMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_chargeTracker.Configure(spellId, maxCharges, rechargeMs);
+}
+
+std::chrono::steady_clock::time_point CooldownManager::NextReadyTime() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::chrono::steady_clock::time_point next{};
+    m_readiness.NextPendingReadyTime(std::chrono::steady_clock::now(), next);
+    return next;
 }
 
-} 
\ No newline at end of file
+bool CooldownManager::ShouldEvaluate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+    if (m_wakeRequested || now >= m_nextWake) {
+        m_wakeRequested = false;
+        ++m_stats.evaluationsRun;
+        return true;
+    }
+    ++m_stats.evaluationsSkipped;
+    return false;
+}
+
+void CooldownManager::DeferEvaluation() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+    auto wake = now + std::chrono::milliseconds(MAX_IDLE_MS);
+
+    std::chrono::steady_clock::time_point nextReady;
+    if (m_readiness.NextPendingReadyTime(now, nextReady) && nextReady < wake) {
+        wake = nextReady;
+    }
+    m_nextWake = wake;
+}
+
+void CooldownManager::NotifyExternalEvent() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wakeRequested = true;
+}
+
+}
@@ -1,25 +1,52 @@
 #pragma once
 
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <cstdint>
 #include <chrono> // For time tracking
+#include "gcd.h"
+#include "charges.h"
+#include "readiness.h"
+
+namespace Rotation { struct RotationProfile; }
 
 namespace Spells {
 
 class CooldownManager {
 public:
+    // Counters for the frame-coherent cooldown table
+    struct CacheStats {
+        uint64_t hits = 0;        // Queries answered from the table
+        uint64_t misses = 0;      // Queries that had to call into the client
+        uint64_t clientCalls = 0; // Total calls to SpellManager::GetSpellCooldownMs (refresh + misses)
+        uint64_t frame = 0;       // Number of Update() calls so far
+        size_t trackedSpells = 0; // Spells refreshed every Update()
+        uint64_t evaluationsRun = 0;     // ShouldEvaluate() returned true
+        uint64_t evaluationsSkipped = 0; // ShouldEvaluate() returned false
+        size_t pendingSpells = 0;        // Spells waiting in the readiness timeline
+    };
+
+    // Upper bound for how long the rotation may sleep without a ready spell or an event.
+    // World state (auras, health, positions) is only refreshed every ObjectManager update (500ms),
+    // so waiting longer than that could miss condition changes.
+    static constexpr int MAX_IDLE_MS = 500;
+
     /**
-     * Record when a spell is cast to track its cooldown
+     * Record a cast attempt to track its cooldown and feed the GCD model
      * @param spellId The ID of the spell that was cast
+     * @param succeeded Result of Spells::CastSpell. Failed casts do not start a GCD window.
      */
-    void RecordSpellCast(int spellId);
-    
+    void RecordSpellCast(int spellId, bool succeeded = true);
+
     /**
      * Check if a spell is on cooldown according to WoW or GCD tracking
      * @param spellId The ID of the spell to check
      * @return true if the spell is on cooldown, false otherwise
      */
     bool IsSpellOnCooldown(int spellId);
-    
+
     /**
      * Get the remaining cooldown time in milliseconds
      * @param spellId The ID of the spell to check
@@ -27,9 +54,182 @@ public:
      */
     int GetRemainingCooldown(int spellId);
 
+    /**
+     * Get the number of charges currently available for a spell.
+     * Spells without charges report 1 when ready and 0 when on cooldown.
+     * @param spellId The ID of the spell to check
+     * @return Available charges
+     */
+    int GetCharges(int spellId);
+
+    /**
+     * Get the time until a charge-based spell regains its next charge
+     * @param spellId The ID of the spell to check
+     * @return Milliseconds until the next charge (for spells without charges: remaining cooldown)
+     */
+    int TimeToNextCharge(int spellId);
+
+    /**
+     * Configure a spell as charge-based (done automatically for profile steps with maxCharges > 1)
+     * @param spellId The ID of the spell
+     * @param maxCharges Maximum number of charges
+     * @param rechargeMs Time to regain one charge in milliseconds
+     */
+    void ConfigureCharges(int spellId, int maxCharges, int rechargeMs);
+
+    /**
+     * Refresh the cooldown table for every tracked spell. Call once per frame from EndScene,
+     * after the ObjectManager update, so all rotation queries in that frame see the same data.
+     */
+    void Update();
+
+    /**
+     * Replace the tracked set with the spells a compiled program reads state for, so they are
+     * refreshed by Update() instead of being queried on demand. Entries of spells that are no
+     * longer referenced are dropped. Resets the readiness timeline (spell costs included), so call it
+     * before ConfigureProfileSpells.
+     * @param spellIds RotationProgram::referencedSpells of the program that is about to become active
+     */
+    void TrackProfileSpells(const std::vector<uint32_t>& spellIds);
+
+    /**
+     * Feed the per-step data of a profile into the GCD, charge and readiness models
+     * (base cast times, resource costs, charge counts).
+     * @param profile The rotation profile that is about to become active
+     */
+    void ConfigureProfileSpells(const Rotation::RotationProfile& profile);
+
+    /**
+     * Register a single spell to be refreshed by Update()
+     * @param spellId The ID of the spell to track
+     */
+    void TrackSpell(int spellId);
+
+    /**
+     * Forget all tracked spells and cached cooldowns (e.g. when the rotation is switched)
+     */
+    void ClearTrackedSpells();
+
+    /**
+     * Earliest time a new action can start, based on the learned GCD and the cast/channel in progress.
+     * The rotation can schedule its next decision for this moment instead of polling.
+     * @return Time point (epoch/default if nothing is blocking)
+     */
+    std::chrono::steady_clock::time_point NextActionableTime() const;
+
+    /**
+     * @return Learned GCD in milliseconds (1500 until the first observation)
+     */
+    int GetGcdMs() const;
+
+    /**
+     * @return Learned haste multiplier applied to cast times and the GCD
+     */
+    float GetHasteFactor() const;
+
+    /**
+     * Get the learned cast duration of a spell
+     * @param spellId The ID of the spell
+     * @return Cast duration in milliseconds (0 if instant or unknown)
+     */
+    int GetCastTimeMs(int spellId) const;
+
+    /**
+     * Earliest time a spell of the active profile that is currently unusable becomes usable
+     * (cooldown, GCD, charges and estimated resource regeneration combined).
+     * @return Time point, or a default time point if no spell is pending
+     */
+    std::chrono::steady_clock::time_point NextReadyTime();
+
+    /**
+     * Whether the rotation should run a full evaluation now. True after an external event,
+     * or once the wake time set by DeferEvaluation() has passed.
+     * @return true if the rotation should evaluate its steps
+     */
+    bool ShouldEvaluate();
+
+    /**
+     * Called by the rotation after an evaluation that did not queue a cast: sleep until the
+     * next spell becomes ready (capped at MAX_IDLE_MS) or an external event arrives.
+     */
+    void DeferEvaluation();
+
+    /**
+     * Wake the rotation on the next ShouldEvaluate() (e.g. target changed, settings changed).
+     * Casts, target changes and cast-state changes are detected internally.
+     */
+    void NotifyExternalEvent();
+
+    /**
+     * Get cast attempt counters
+     * @param outSucceeded Number of successful casts recorded
+     * @param outFailed Number of failed casts recorded
+     */
+    void GetCastCounters(uint64_t& outSucceeded, uint64_t& outFailed) const;
+
+    /**
+     * Get hit/miss counters of the cooldown table
+     * @return A copy of the current counters
+     */
+    CacheStats GetCacheStats() const;
+
+    /**
+     * Reset hit/miss counters (tracked spells are kept)
+     */
+    void ResetCacheStats();
+
 private:
-    // Last time each spell was cast (for GCD tracking)
+    struct CooldownEntry {
+        std::chrono::steady_clock::time_point readyAt; // When the client reports the spell usable again
+        uint64_t frame = 0;                            // Update() generation this entry was read in
+        bool valid = false;                            // False if the client call failed
+    };
+
+    // Client state read by Update() before it takes m_mutex
+    struct FrameReads {
+        std::vector<std::pair<int, int>> cooldowns;     // spellId, remaining ms (-1 = read failed)
+        std::vector<std::pair<uint8_t, int>> powers;    // powerType, current value
+        uint64_t targetGuid = 0;
+        bool hasWorld = false;                          // ObjectManager ready (target/powers valid)
+        uint32_t castingId = 0;
+        uint32_t channelId = 0;
+        bool castStateValid = false;
+    };
+
+    // Reads the local player's target, powers and cast/channel state (cooldownreads.cpp). Does not touch m_mutex.
+    static void ReadPlayerState(FrameReads& reads);
+    // Stores one client cooldown read in the table. Caller holds m_mutex.
+    const CooldownEntry& ApplyCooldownRead(int spellId, int remainingMs, std::chrono::steady_clock::time_point now);
+    // Returns the game-reported remaining cooldown, served from the table when fresh. On a miss the client
+    // is read with `lock` released. Caller holds `lock` on m_mutex.
+    int GetGameCooldownMs(int spellId, std::unique_lock<std::mutex>& lock, std::chrono::steady_clock::time_point now);
+    // Returns the remaining time of the local GCD safety window. Caller holds m_mutex.
+    int GetLocalGcdRemainingMs(int spellId, std::chrono::steady_clock::time_point now) const;
+
+    mutable std::mutex m_mutex;
+
+    // Last time each spell was successfully cast (for GCD tracking)
     std::unordered_map<int, std::chrono::steady_clock::time_point> spellLastCastTime;
+
+    // Learned GCD / cast durations
+    GcdModel m_gcdModel;
+
+    // Simulated charges for spells with maxCharges > 1
+    ChargeTracker m_chargeTracker;
+
+    // Readiness timeline / evaluation scheduling
+    void UpdateReadiness(const FrameReads& reads, std::chrono::steady_clock::time_point now);
+    ReadinessTimeline m_readiness;
+    std::chrono::steady_clock::time_point m_nextWake{};
+    bool m_wakeRequested = true;
+    uint64_t m_lastTargetGuid = 0;
+    bool m_lastCastInProgress = false;
+
+    // Frame-coherent cooldown table
+    std::unordered_set<int> m_trackedSpells;
+    std::unordered_map<int, CooldownEntry> m_cooldownTable;
+    uint64_t m_frame = 0;
+    CacheStats m_stats;
 };
 
-} 
\ No newline at end of file
+}
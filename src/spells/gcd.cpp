@@ -0,0 +1,122 @@
+#include "gcd.h"
+#include <algorithm>
+
+namespace Spells {
+
+void GcdModel::OnCastAttempt(int spellId, bool succeeded, Clock::time_point now) {
+    if (!succeeded) {
+        // A failed cast does not trigger the GCD - don't block the next decision on it
+        ++m_failedCasts;
+        return;
+    }
+    ++m_successfulCasts;
+    m_lastSuccessTime = now;
+    m_lastSuccessSpellId = spellId;
+    m_awaitingGcdSample = true;
+}
+
+void GcdModel::OnCooldownRead(int spellId, int remainingMs, Clock::time_point now) {
+    if (!m_awaitingGcdSample || spellId != m_lastSuccessSpellId || remainingMs <= 0) {
+        return;
+    }
+    m_awaitingGcdSample = false;
+
+    // Only the first read after the cast is used: elapsed + remaining = total cooldown.
+    // Anything above the base GCD is the spell's own cooldown, not the GCD.
+    float elapsedMs = static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastSuccessTime).count());
+    float totalMs = elapsedMs + static_cast<float>(remainingMs);
+    if (totalMs >= MIN_GCD_MS - 50 && totalMs <= BASE_GCD_MS + 50) {
+        AddGcdSample(totalMs);
+    }
+}
+
+void GcdModel::ObserveCastState(uint32_t castingSpellId, uint32_t channelSpellId, Clock::time_point now) {
+    uint32_t current = castingSpellId != 0 ? castingSpellId : channelSpellId;
+    if (current == m_castSpellId) {
+        return;
+    }
+
+    // Previous cast/channel ended (finished, interrupted or replaced)
+    if (m_castSpellId != 0) {
+        int spellId = static_cast<int>(m_castSpellId);
+        float observedMs = static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(now - m_castStart).count());
+        CastSample& sample = m_castTimes[spellId];
+        // A cast that ended well before its learned duration was most likely interrupted or moved out of
+        if (sample.samples == 0 || observedMs >= sample.durationMs * 0.5f) {
+            sample.durationMs = sample.samples == 0 ? observedMs : (sample.durationMs + EMA_ALPHA * (observedMs - sample.durationMs));
+            ++sample.samples;
+            if (!m_castIsChannel) {
+                UpdateHasteFromCast(spellId, observedMs);
+            }
+        }
+    }
+
+    m_castSpellId = current;
+    m_castIsChannel = (castingSpellId == 0 && channelSpellId != 0);
+    m_castStart = now;
+}
+
+void GcdModel::SetBaseCastTime(int spellId, int castTimeMs) {
+    if (spellId <= 0 || castTimeMs < 0) return;
+    m_baseCastTimes[spellId] = castTimeMs;
+}
+
+int GcdModel::GetGcdMs() const {
+    if (m_gcdSamples > 0) {
+        return static_cast<int>(m_gcdMs + 0.5f);
+    }
+    // No direct GCD reading yet - derive it from haste observed on cast times
+    int hasted = static_cast<int>(BASE_GCD_MS * m_hasteFactor + 0.5f);
+    return (std::max)(MIN_GCD_MS, (std::min)(BASE_GCD_MS, hasted));
+}
+
+int GcdModel::GetCastTimeMs(int spellId) const {
+    auto it = m_castTimes.find(spellId);
+    if (it != m_castTimes.end() && it->second.samples > 0) {
+        return static_cast<int>(it->second.durationMs + 0.5f);
+    }
+    auto baseIt = m_baseCastTimes.find(spellId);
+    if (baseIt != m_baseCastTimes.end()) {
+        return static_cast<int>(baseIt->second * m_hasteFactor + 0.5f);
+    }
+    return 0;
+}
+
+int GcdModel::GetGcdRemainingMs(Clock::time_point now) const {
+    if (m_successfulCasts == 0) return 0;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastSuccessTime).count();
+    int gcd = GetGcdMs();
+    return elapsed < gcd ? static_cast<int>(gcd - elapsed) : 0;
+}
+
+GcdModel::Clock::time_point GcdModel::NextActionableTime() const {
+    Clock::time_point next{};
+    if (m_successfulCasts > 0) {
+        next = m_lastSuccessTime + std::chrono::milliseconds(GetGcdMs());
+    }
+    if (m_castSpellId != 0) {
+        int castMs = GetCastTimeMs(static_cast<int>(m_castSpellId));
+        if (castMs > 0) {
+            next = (std::max)(next, m_castStart + std::chrono::milliseconds(castMs));
+        }
+    }
+    return next;
+}
+
+void GcdModel::AddGcdSample(float gcdMs) {
+    gcdMs = (std::max)(static_cast<float>(MIN_GCD_MS), (std::min)(static_cast<float>(BASE_GCD_MS), gcdMs));
+    m_gcdMs = m_gcdSamples == 0 ? gcdMs : (m_gcdMs + EMA_ALPHA * (gcdMs - m_gcdMs));
+    ++m_gcdSamples;
+}
+
+void GcdModel::UpdateHasteFromCast(int spellId, float observedMs) {
+    auto it = m_baseCastTimes.find(spellId);
+    if (it == m_baseCastTimes.end() || it->second <= 0) return;
+
+    float ratio = observedMs / static_cast<float>(it->second);
+    // Ignore obviously bogus samples (pushback, frame hitches, wrong base data)
+    if (ratio < 0.3f || ratio > 1.5f) return;
+    m_hasteFactor += EMA_ALPHA * (ratio - m_hasteFactor);
+}
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <unordered_map>
+#include <cstdint>
+#include <chrono>
+
+namespace Spells {
+
+/**
+ * Learns the player's real global cooldown and per-spell cast durations from what actually
+ * happens in the client (cast results, cooldown reads and the local player's casting state),
+ * instead of assuming a fixed 1.5s GCD.
+ *
+ * Not thread-safe on its own - CooldownManager owns it and guards it with its mutex.
+ */
+class GcdModel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Base (unhasted) global cooldown in 3.3.5
+    static constexpr int BASE_GCD_MS = 1500;
+    // Haste cannot push the GCD below 1s
+    static constexpr int MIN_GCD_MS = 1000;
+
+    /**
+     * Record the result of a cast attempt
+     * @param spellId The ID of the spell that was attempted
+     * @param succeeded Result returned by Spells::CastSpell
+     * @param now Time of the attempt
+     */
+    void OnCastAttempt(int spellId, bool succeeded, Clock::time_point now);
+
+    /**
+     * Feed the client-reported remaining cooldown of a spell shortly after it was cast.
+     * Readies within the GCD range are used as GCD samples.
+     * @param spellId The ID of the spell
+     * @param remainingMs Remaining cooldown reported by the client
+     * @param now Time of the read
+     */
+    void OnCooldownRead(int spellId, int remainingMs, Clock::time_point now);
+
+    /**
+     * Feed the local player's casting/channel state once per frame
+     * @param castingSpellId Spell currently being cast (0 if none)
+     * @param channelSpellId Spell currently being channeled (0 if none)
+     * @param now Time of the observation
+     */
+    void ObserveCastState(uint32_t castingSpellId, uint32_t channelSpellId, Clock::time_point now);
+
+    /**
+     * Provide the unhasted cast time of a spell (from the rotation profile) so haste can be inferred
+     * @param spellId The ID of the spell
+     * @param castTimeMs Base cast time in milliseconds (0 for instants)
+     */
+    void SetBaseCastTime(int spellId, int castTimeMs);
+
+    /**
+     * @return Learned GCD length in milliseconds
+     */
+    int GetGcdMs() const;
+
+    /**
+     * @return Learned haste multiplier (1.0 = no haste, 0.8 = 25% haste)
+     */
+    float GetHasteFactor() const { return m_hasteFactor; }
+
+    /**
+     * Get the learned cast duration of a spell
+     * @param spellId The ID of the spell
+     * @return Learned duration in ms, the hasted base cast time if never observed, or 0 if unknown
+     */
+    int GetCastTimeMs(int spellId) const;
+
+    /**
+     * Remaining GCD after the last successful cast
+     * @param now Current time
+     * @return Remaining milliseconds (0 if the GCD is over)
+     */
+    int GetGcdRemainingMs(Clock::time_point now) const;
+
+    /**
+     * Earliest time the player can start a new action: after both the GCD and the
+     * current cast/channel (if any) are expected to have finished.
+     */
+    Clock::time_point NextActionableTime() const;
+
+    // Counters for the GUI
+    uint64_t GetSuccessfulCasts() const { return m_successfulCasts; }
+    uint64_t GetFailedCasts() const { return m_failedCasts; }
+    bool IsCastInProgress() const { return m_castSpellId != 0; }
+
+private:
+    struct CastSample {
+        float durationMs = 0.0f; // EMA of observed durations
+        int samples = 0;
+    };
+
+    void AddGcdSample(float gcdMs);
+    void UpdateHasteFromCast(int spellId, float observedMs);
+
+    static constexpr float EMA_ALPHA = 0.3f;
+
+    float m_gcdMs = static_cast<float>(BASE_GCD_MS);
+    int m_gcdSamples = 0;
+    float m_hasteFactor = 1.0f;
+
+    // Last successful cast (GCD start)
+    Clock::time_point m_lastSuccessTime{};
+    int m_lastSuccessSpellId = 0;
+    bool m_awaitingGcdSample = false;
+
+    // Cast/channel currently observed on the local player
+    uint32_t m_castSpellId = 0;
+    bool m_castIsChannel = false;
+    Clock::time_point m_castStart{};
+
+    std::unordered_map<int, CastSample> m_castTimes;
+    std::unordered_map<int, int> m_baseCastTimes;
+
+    uint64_t m_successfulCasts = 0;
+    uint64_t m_failedCasts = 0;
+};
+
+}
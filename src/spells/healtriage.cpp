@@ -0,0 +1,246 @@
+#include "healtriage.h"
+#include "../types/wowunit.h"
+#include <algorithm>
+
+namespace Spells {
+
+namespace {
+
+// Health samples closer together than this only move the unit in the heap, not its damage rate
+constexpr auto RATE_MIN_SAMPLE_INTERVAL = std::chrono::milliseconds(250);
+// Weight of the newest damage rate in the smoothed rate
+constexpr float RATE_SMOOTHING = 0.3f;
+// No health change for this long: the unit is no longer taking damage
+constexpr auto RATE_STALE_AFTER = std::chrono::seconds(3);
+
+} // namespace
+
+float HealTriage::EffectiveHealth(const Entry& entry) {
+    if (entry.maxHealth <= 0) return 1.0f;
+    float predicted = (std::max)(0.0f, entry.candidate.damagePerSecond) * PREDICTION_SECONDS;
+    float effective = static_cast<float>(entry.health + entry.shield) - predicted;
+    return effective / static_cast<float>(entry.maxHealth);
+}
+
+void HealTriage::Refresh(const std::vector<std::shared_ptr<WowObject>>& units, const Vector3& from, const Filter& filter) {
+    auto now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastRefresh = now;
+    m_stats.refreshes++;
+    ++m_pass;
+
+    for (const auto& object : units) {
+        auto unit = std::dynamic_pointer_cast<WowUnit>(object);
+        if (!unit) continue;
+        uint64_t guid = unit->GetGUID64();
+        auto it = m_entries.find(guid);
+
+        if (unit->IsDead() || unit->GetMaxHealth() <= 0) {
+            if (it != m_entries.end()) RemoveLocked(guid);
+            continue;
+        }
+
+        // Reaction can change (a unit turns hostile), so tracked units are checked again every refresh
+        if (filter && !filter(*unit)) {
+            if (it != m_entries.end()) RemoveLocked(guid);
+            continue;
+        }
+
+        int health = unit->GetHealth();
+        int maxHealth = unit->GetMaxHealth();
+        int shield = m_shields ? (std::max)(0, m_shields(*unit)) : 0;
+
+        if (it == m_entries.end()) {
+            Entry& entry = m_entries[guid];
+            entry.candidate.guid = guid;
+            entry.health = health;
+            entry.maxHealth = maxHealth;
+            entry.shield = shield;
+            entry.sampleHealth = health;
+            entry.lastChange = now;
+            entry.lastSample = now;
+            entry.seenPass = m_pass;
+            entry.candidate.distance = from.Distance(unit->GetPosition());
+            entry.candidate.healthPercent = static_cast<float>(health) / static_cast<float>(maxHealth) * 100.0f;
+            entry.candidate.effectiveHealth = EffectiveHealth(entry);
+            Push(guid);
+            continue;
+        }
+
+        Entry& entry = it->second;
+        entry.seenPass = m_pass;
+        entry.candidate.distance = from.Distance(unit->GetPosition()); // Not part of the key
+
+        bool changed = health != entry.health || maxHealth != entry.maxHealth || shield != entry.shield;
+        if (changed) {
+            auto elapsed = now - entry.lastSample;
+            if (elapsed >= RATE_MIN_SAMPLE_INTERVAL) {
+                float seconds = std::chrono::duration<float>(elapsed).count();
+                float rate = static_cast<float>(entry.sampleHealth - health) / seconds; // Negative while healed
+                entry.candidate.damagePerSecond = entry.candidate.damagePerSecond * (1.0f - RATE_SMOOTHING) + rate * RATE_SMOOTHING;
+                entry.sampleHealth = health;
+                entry.lastSample = now;
+            }
+            entry.health = health;
+            entry.maxHealth = maxHealth;
+            entry.shield = shield;
+            entry.lastChange = now;
+        } else if (entry.candidate.damagePerSecond != 0.0f && now - entry.lastChange > RATE_STALE_AFTER) {
+            entry.candidate.damagePerSecond = 0.0f;
+            entry.sampleHealth = health;
+            entry.lastSample = now;
+            changed = true;
+        }
+
+        if (changed) {
+            entry.candidate.healthPercent = static_cast<float>(health) / static_cast<float>(maxHealth) * 100.0f;
+            Rekey(guid);
+            m_stats.rekeys++;
+        } else {
+            m_stats.unchanged++;
+        }
+    }
+
+    // Units that despawned or went out of the object table
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->second.seenPass != m_pass) {
+            uint64_t guid = it->first;
+            ++it;
+            RemoveLocked(guid);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool HealTriage::IsStale(std::chrono::milliseconds minInterval) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Clock::now() - m_lastRefresh >= minInterval;
+}
+
+bool HealTriage::RefreshIfStale(const std::vector<std::shared_ptr<WowObject>>& units, const Vector3& from, const Filter& filter,
+                                std::chrono::milliseconds minInterval) {
+    if (!IsStale(minInterval)) return false;
+    Refresh(units, from, filter);
+    return true;
+}
+
+size_t HealTriage::Lowest(size_t n, float maxEffectiveHealth, float maxRange, uint64_t excludeGuid, std::vector<HealCandidate>& out) {
+    out.clear();
+    if (n == 0) return 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.queries++;
+    if (m_heap.empty()) return 0;
+
+    // Best-first walk: a node's children are never lower, so stop at the first one over the threshold
+    auto openCompare = [this](size_t a, size_t b) { return KeyAt(a) > KeyAt(b); };
+    m_open.clear();
+    m_open.push_back(0);
+    while (!m_open.empty() && out.size() < n) {
+        std::pop_heap(m_open.begin(), m_open.end(), openCompare);
+        size_t index = m_open.back();
+        m_open.pop_back();
+        m_stats.visited++;
+
+        if (m_heap[index].key >= maxEffectiveHealth) break;
+        const Entry& entry = m_entries.at(m_heap[index].guid);
+        if (entry.candidate.guid != excludeGuid && (maxRange <= 0.0f || entry.candidate.distance <= maxRange)) {
+            out.push_back(entry.candidate);
+        }
+
+        for (size_t child = index * 2 + 1; child <= index * 2 + 2 && child < m_heap.size(); ++child) {
+            m_open.push_back(child);
+            std::push_heap(m_open.begin(), m_open.end(), openCompare);
+        }
+    }
+    return out.size();
+}
+
+void HealTriage::SetShieldProvider(ShieldProvider provider) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shields = std::move(provider);
+}
+
+void HealTriage::Remove(uint64_t guid) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.count(guid)) RemoveLocked(guid);
+}
+
+void HealTriage::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_heap.clear();
+}
+
+HealTriage::Stats HealTriage::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.tracked = m_heap.size();
+    return stats;
+}
+
+void HealTriage::Push(uint64_t guid) {
+    Entry& entry = m_entries[guid];
+    m_heap.push_back({ entry.candidate.effectiveHealth, guid });
+    entry.heapIndex = m_heap.size() - 1;
+    SiftUp(entry.heapIndex);
+}
+
+void HealTriage::Rekey(uint64_t guid) {
+    Entry& entry = m_entries[guid];
+    entry.candidate.effectiveHealth = EffectiveHealth(entry);
+    m_heap[entry.heapIndex].key = entry.candidate.effectiveHealth;
+    SiftUp(entry.heapIndex);
+    SiftDown(entry.heapIndex);
+}
+
+void HealTriage::RemoveLocked(uint64_t guid) {
+    auto it = m_entries.find(guid);
+    size_t index = it->second.heapIndex;
+    size_t last = m_heap.size() - 1;
+    m_entries.erase(it);
+    if (index != last) {
+        uint64_t moved = m_heap[last].guid;
+        m_heap[index] = m_heap[last];
+        m_heap.pop_back();
+        Entry& movedEntry = m_entries[moved];
+        movedEntry.heapIndex = index;
+        SiftUp(index);
+        SiftDown(movedEntry.heapIndex);
+    } else {
+        m_heap.pop_back();
+    }
+}
+
+void HealTriage::Swap(size_t a, size_t b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_entries[m_heap[a].guid].heapIndex = a;
+    m_entries[m_heap[b].guid].heapIndex = b;
+}
+
+void HealTriage::SiftUp(size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (KeyAt(parent) <= KeyAt(index)) break;
+        Swap(parent, index);
+        index = parent;
+    }
+}
+
+void HealTriage::SiftDown(size_t index) {
+    size_t size = m_heap.size();
+    while (true) {
+        size_t smallest = index;
+        size_t left = index * 2 + 1;
+        size_t right = left + 1;
+        if (left < size && KeyAt(left) < KeyAt(smallest)) smallest = left;
+        if (right < size && KeyAt(right) < KeyAt(smallest)) smallest = right;
+        if (smallest == index) break;
+        Swap(index, smallest);
+        index = smallest;
+    }
+}
+
+} // namespace Spells
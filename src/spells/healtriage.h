@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../types/types.h"
+
+class WowObject;
+class WowUnit;
+
+namespace Spells {
+
+struct HealCandidate {
+    uint64_t guid = 0;
+    float effectiveHealth = 1.0f; // (health + shield - predicted damage) / max health
+    float healthPercent = 100.0f;
+    float damagePerSecond = 0.0f;
+    float distance = 0.0f;
+};
+
+/**
+ * Friendly units ordered by effective health, kept in an indexed min-heap.
+ * Refresh() walks the unit table but only re-keys units whose health, max health or shield changed
+ * (or whose damage rate went stale), each in O(log n); units that left are removed the same way.
+ * Queries walk the heap best-first and stop at the threshold, so "lowest N under X% in range" costs
+ * O((N + skipped) log n) instead of a scan of every unit.
+ *
+ * Effective health = health + shield - damage rate * PREDICTION_SECONDS, as a fraction of max health.
+ *
+ * Thread-safe.
+ */
+class HealTriage {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Filter = std::function<bool(WowUnit& unit)>;
+    using ShieldProvider = std::function<int(WowUnit& unit)>; // Absorb amount left on the unit
+
+    static constexpr float PREDICTION_SECONDS = 1.5f;
+
+    struct Stats {
+        uint64_t refreshes = 0;
+        uint64_t rekeys = 0;   // Heap updates for changed units
+        uint64_t unchanged = 0; // Units skipped by a refresh
+        uint64_t queries = 0;
+        uint64_t visited = 0;  // Heap nodes looked at by queries
+        size_t tracked = 0;
+    };
+
+    /**
+     * Sync with the unit table
+     * @param units Friendly candidates are picked by the filter (dead units are dropped)
+     * @param from Position distances are measured from (the player)
+     * @param filter Reaction/blacklist check, called for every unit on each refresh (tracked units that fail it are removed)
+     */
+    void Refresh(const std::vector<std::shared_ptr<WowObject>>& units, const Vector3& from, const Filter& filter);
+
+    // Refresh unless the last one is more recent than minInterval
+    bool RefreshIfStale(const std::vector<std::shared_ptr<WowObject>>& units, const Vector3& from, const Filter& filter,
+                        std::chrono::milliseconds minInterval);
+    bool IsStale(std::chrono::milliseconds minInterval) const;
+
+    /**
+     * Lowest effective health first
+     * @param n Max results
+     * @param maxEffectiveHealth Only units below this fraction (e.g. 0.8 for 80%)
+     * @param maxRange Yards from the refresh position, 0 = any
+     * @param excludeGuid Unit to skip (e.g. the player), 0 = none
+     * @param out Results, most urgent first
+     * @return Number of results
+     */
+    size_t Lowest(size_t n, float maxEffectiveHealth, float maxRange, uint64_t excludeGuid, std::vector<HealCandidate>& out);
+
+    void SetShieldProvider(ShieldProvider provider);
+    void Remove(uint64_t guid);
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        HealCandidate candidate;
+        int health = 0;
+        int maxHealth = 0;
+        int shield = 0;
+        Clock::time_point lastChange;
+        Clock::time_point lastSample;
+        int sampleHealth = 0;
+        uint32_t seenPass = 0;
+        size_t heapIndex = 0;
+    };
+
+    struct HeapNode {
+        float key;     // Effective health, copied so sifting needs no map lookups
+        uint64_t guid;
+    };
+
+    static float EffectiveHealth(const Entry& entry);
+
+    void Push(uint64_t guid);
+    void Rekey(uint64_t guid);
+    void RemoveLocked(uint64_t guid);
+    void SiftUp(size_t index);
+    void SiftDown(size_t index);
+    void Swap(size_t a, size_t b);
+    float KeyAt(size_t index) const { return m_heap[index].key; }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    std::vector<HeapNode> m_heap; // Min-heap on effective health
+    std::vector<size_t> m_open;   // Query scratch: frontier of heap indices
+    ShieldProvider m_shields;
+    uint32_t m_pass = 0;
+    Clock::time_point m_lastRefresh;
+    Stats m_stats;
+};
+
+} // namespace Spells
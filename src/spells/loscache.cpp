@@ -0,0 +1,160 @@
+#include "loscache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Spells {
+
+bool LosCache::Key::operator==(const Key& other) const {
+    return casterGuid == other.casterGuid && targetGuid == other.targetGuid &&
+           std::memcmp(cells, other.cells, sizeof(cells)) == 0;
+}
+
+size_t LosCache::KeyHash::operator()(const Key& key) const {
+    // FNV-1a over the guids and cells
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(key.casterGuid);
+    mix(key.targetGuid);
+    for (int32_t cell : key.cells) mix(static_cast<uint32_t>(cell));
+    return static_cast<size_t>(hash);
+}
+
+LosCache& LosCache::GetInstance() {
+    static LosCache instance;
+    return instance;
+}
+
+LosCache::Key LosCache::MakeKey(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end) const {
+    Key key;
+    key.casterGuid = casterGuid;
+    key.targetGuid = targetGuid;
+    const float coords[6] = { start.x, start.y, start.z, end.x, end.y, end.z };
+    for (int i = 0; i < 6; ++i) {
+        key.cells[i] = static_cast<int32_t>(std::floor(coords[i] / m_moveThreshold));
+    }
+    return key;
+}
+
+bool LosCache::Lookup(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy, bool& outHasLos) {
+    if (!m_enabled.load(std::memory_order_relaxed)) return false;
+
+    Key key = MakeKey(casterGuid, targetGuid, start, end);
+    auto now = Clock::now();
+    bool hasPair = casterGuid != 0 && targetGuid != 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        // Same units, different cells: one of them moved, the old result is useless
+        if (hasPair) {
+            auto pairIt = m_pairKeys.find({ casterGuid, targetGuid });
+            if (pairIt != m_pairKeys.end()) {
+                m_entries.erase(pairIt->second);
+                m_pairKeys.erase(pairIt);
+                m_moved.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const Entry& entry = it->second;
+    bool expired = now - entry.tracedAt > std::chrono::milliseconds(m_ttlMs.load(std::memory_order_relaxed));
+    float thresholdSq = m_moveThreshold * m_moveThreshold;
+    bool moved = !expired && (start.DistanceSq(entry.start) > thresholdSq || end.DistanceSq(entry.end) > thresholdSq);
+    if (expired || moved) {
+        (expired ? m_expired : m_moved).fetch_add(1, std::memory_order_relaxed);
+        m_entries.erase(it);
+        if (hasPair) m_pairKeys.erase({ casterGuid, targetGuid });
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Fast verdict, full check asked: trace again (Store upgrades the entry)
+    if (policy == LosPolicy::Full && !entry.full) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    outHasLos = entry.hasLos;
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void LosCache::Store(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy, bool hasLos) {
+    if (!m_enabled.load(std::memory_order_relaxed)) return;
+
+    Key key = MakeKey(casterGuid, targetGuid, start, end);
+    auto now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (casterGuid != 0 && targetGuid != 0) {
+        auto pairIt = m_pairKeys.find({ casterGuid, targetGuid });
+        if (pairIt != m_pairKeys.end()) {
+            if (!(pairIt->second == key)) m_entries.erase(pairIt->second);
+            pairIt->second = key;
+        } else {
+            m_pairKeys.emplace(std::make_pair(casterGuid, targetGuid), key);
+        }
+    }
+
+    Entry& entry = m_entries[key];
+    entry.start = start;
+    entry.end = end;
+    entry.tracedAt = now;
+    entry.hasLos = hasLos;
+    entry.full = policy == LosPolicy::Full;
+
+    if (m_entries.size() > MAX_ENTRIES) PruneLocked(now);
+}
+
+void LosCache::PruneLocked(Clock::time_point now) {
+    auto ttl = std::chrono::milliseconds(m_ttlMs.load(std::memory_order_relaxed));
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (now - it->second.tracedAt > ttl) it = m_entries.erase(it);
+        else ++it;
+    }
+    // Still full of fresh entries (huge crowd): start over rather than pick victims
+    if (m_entries.size() > MAX_ENTRIES) m_entries.clear();
+
+    for (auto it = m_pairKeys.begin(); it != m_pairKeys.end();) {
+        if (!m_entries.count(it->second)) it = m_pairKeys.erase(it);
+        else ++it;
+    }
+}
+
+void LosCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_pairKeys.clear();
+}
+
+void LosCache::SetTtlMs(int ms) {
+    m_ttlMs = (std::max)(0, (std::min)(MAX_TTL_MS, ms));
+}
+
+LosCache::Stats LosCache::GetStats() const {
+    Stats stats;
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.expired = m_expired.load(std::memory_order_relaxed);
+    stats.moved = m_moved.load(std::memory_order_relaxed);
+    stats.worldTraces = m_worldTraces.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.entries = m_entries.size();
+    return stats;
+}
+
+void LosCache::ResetStats() {
+    m_hits = 0;
+    m_misses = 0;
+    m_expired = 0;
+    m_moved = 0;
+    m_worldTraces = 0;
+}
+
+} // namespace Spells
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "../types/types.h"
+#include "lostrace.h"
+
+namespace Spells {
+
+// Hash for (caster GUID, target GUID) keys
+struct GuidPairHash {
+    size_t operator()(const std::pair<uint64_t, uint64_t>& pair) const {
+        return std::hash<uint64_t>()(pair.first * 0x9E3779B97F4A7C15ull ^ pair.second);
+    }
+};
+
+/**
+ * Cache of line-of-sight results. An IsInLineOfSight check fires up to 14 world traces, and targeting
+ * asks it for every candidate every tick; in a static fight almost every query repeats the previous one.
+ *
+ * Entries are keyed on the caster and target GUIDs plus both endpoints quantized to cells of
+ * moveThreshold yards. A result is reused while it is younger than the TTL and neither endpoint moved
+ * more than moveThreshold from where it was traced. When a unit pair is traced again from new cells,
+ * its previous entry is dropped. Queries without GUIDs (raw positions) are keyed on the cells only and
+ * expire through the TTL. A Fast-policy result only answers Fast queries; a Full result answers both.
+ *
+ * Thread-safe.
+ */
+class LosCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int DEFAULT_TTL_MS = 300;
+    static constexpr int MAX_TTL_MS = 2000;
+    static constexpr float DEFAULT_MOVE_THRESHOLD = 0.5f; // Yards
+    static constexpr size_t MAX_ENTRIES = 512;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;        // Queries that had to trace (includes expired and moved)
+        uint64_t expired = 0;       // Entry found but older than the TTL
+        uint64_t moved = 0;         // Entry dropped because an endpoint left its cell or moved past the threshold
+        uint64_t worldTraces = 0;   // WorldIntersect calls made by LOS checks
+        size_t entries = 0;
+    };
+
+    static LosCache& GetInstance();
+
+    /**
+     * Look up a cached result
+     * @param casterGuid GUID of the unit at start (0 if unknown)
+     * @param targetGuid GUID of the unit at end (0 if unknown)
+     * @param start Trace start
+     * @param end Trace end
+     * @param policy Policy of the query
+     * @param outHasLos Cached result
+     * @return true on a hit
+     */
+    bool Lookup(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy, bool& outHasLos);
+
+    /**
+     * Store a traced result (replaces the pair's previous entry)
+     */
+    void Store(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy, bool hasLos);
+
+    // Count world traces issued by the LOS check (for the stats)
+    void AddWorldTraces(uint32_t count) { m_worldTraces.fetch_add(count, std::memory_order_relaxed); }
+
+    // Drop every entry (e.g. on loading screens; geometry and positions are no longer comparable)
+    void Clear();
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled.load(); }
+
+    void SetTtlMs(int ms);
+    int GetTtlMs() const { return m_ttlMs.load(); }
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    LosCache() = default;
+    LosCache(const LosCache&) = delete;
+    LosCache& operator=(const LosCache&) = delete;
+
+    struct Key {
+        uint64_t casterGuid;
+        uint64_t targetGuid;
+        int32_t cells[6]; // Start x/y/z, end x/y/z
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Vector3 start;
+        Vector3 end;
+        Clock::time_point tracedAt;
+        bool hasLos = false;
+        bool full = false; // Traced with LosPolicy::Full
+    };
+
+    Key MakeKey(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end) const;
+    void PruneLocked(Clock::time_point now);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    std::unordered_map<std::pair<uint64_t, uint64_t>, Key, GuidPairHash> m_pairKeys; // Current key of each GUID pair
+
+    std::atomic<bool> m_enabled{ true };
+    std::atomic<int> m_ttlMs{ DEFAULT_TTL_MS };
+    float m_moveThreshold = DEFAULT_MOVE_THRESHOLD;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_misses{ 0 };
+    std::atomic<uint64_t> m_expired{ 0 };
+    std::atomic<uint64_t> m_moved{ 0 };
+    std::atomic<uint64_t> m_worldTraces{ 0 };
+};
+
+} // namespace Spells
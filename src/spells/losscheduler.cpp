@@ -0,0 +1,183 @@
+#include "losscheduler.h"
+#include "targeting.h"
+#include <algorithm>
+
+namespace Spells {
+
+namespace {
+
+// Last known answers kept before pruning old ones
+constexpr size_t MAX_KNOWN = 1024;
+
+} // namespace
+
+LosScheduler& LosScheduler::GetInstance() {
+    static LosScheduler instance;
+    return instance;
+}
+
+bool LosScheduler::Query(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy,
+                         bool& outHasLos, bool* outFresh) {
+    if (outFresh) *outFresh = true;
+    // Disabled, or no pair to track the check by: check now
+    if (!m_enabled.load(std::memory_order_relaxed) || casterGuid == 0 || targetGuid == 0) {
+        outHasLos = IsInLineOfSight(casterGuid, targetGuid, start, end, policy);
+        return true;
+    }
+    if (LosCache::GetInstance().Lookup(casterGuid, targetGuid, start, end, policy, outHasLos)) {
+        return true;
+    }
+
+    auto now = Clock::now();
+    PairKey pair(casterGuid, targetGuid);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SubmitLocked(pair, start, end, policy, now);
+
+    if (const Known* known = FindKnownLocked(pair, policy, now)) {
+        outHasLos = known->hasLos;
+        if (outFresh) *outFresh = false;
+        m_stats.staleAnswers++;
+        return true;
+    }
+    m_stats.unknown++;
+    return false;
+}
+
+const LosScheduler::Known* LosScheduler::FindKnownLocked(const PairKey& pair, LosPolicy policy, Clock::time_point now) const {
+    const Known* best = nullptr;
+    // A Fast query may take a Full answer; a Full query never takes a Fast one
+    for (LosPolicy candidate : { LosPolicy::Full, LosPolicy::Fast }) {
+        if (candidate == LosPolicy::Fast && policy == LosPolicy::Full) break;
+        auto it = m_known.find(KnownKey{ pair, candidate });
+        if (it == m_known.end() || now - it->second.at > std::chrono::milliseconds(MAX_STALE_MS)) continue;
+        if (!best || it->second.at > best->at) best = &it->second;
+    }
+    return best;
+}
+
+void LosScheduler::Submit(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy) {
+    if (casterGuid == 0 || targetGuid == 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SubmitLocked(PairKey(casterGuid, targetGuid), start, end, policy, Clock::now());
+}
+
+void LosScheduler::SubmitLocked(const PairKey& pair, const Vector3& start, const Vector3& end, LosPolicy policy, Clock::time_point now) {
+    m_stats.submitted++;
+    auto it = m_pending.find(pair);
+    if (it != m_pending.end()) {
+        // Same pair already queued: check the newest positions, at the stricter policy
+        m_stats.merged++;
+        it->second.start = start;
+        it->second.end = end;
+        if (policy == LosPolicy::Full && it->second.policy != LosPolicy::Full) {
+            it->second.policy = LosPolicy::Full;
+            m_fullQueue.push_back(pair);
+        }
+        return;
+    }
+    if (m_pending.size() >= MAX_PENDING) {
+        m_stats.dropped++;
+        return;
+    }
+
+    Job job;
+    job.start = start;
+    job.end = end;
+    job.policy = policy;
+    job.submitted = now;
+    m_pending.emplace(pair, job);
+    (policy == LosPolicy::Full ? m_fullQueue : m_fastQueue).push_back(pair);
+}
+
+bool LosScheduler::PopLocked(PairKey& outPair, Job& outJob, Clock::time_point now) {
+    for (std::deque<PairKey>* queue : { &m_fullQueue, &m_fastQueue }) {
+        while (!queue->empty()) {
+            PairKey pair = queue->front();
+            queue->pop_front();
+            auto it = m_pending.find(pair);
+            if (it == m_pending.end()) continue; // Ran from the other queue
+            if (now - it->second.submitted > std::chrono::milliseconds(MAX_JOB_AGE_MS)) {
+                m_stats.dropped++;
+                m_pending.erase(it);
+                continue;
+            }
+            outPair = pair;
+            outJob = it->second;
+            m_pending.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LosScheduler::RunFrame() {
+    if (!m_enabled.load(std::memory_order_relaxed)) return;
+
+    auto frameStart = Clock::now();
+    auto budget = std::chrono::microseconds(m_frameBudgetUs.load(std::memory_order_relaxed));
+    uint32_t executed = 0;
+    // At least one check per frame, so the queue drains even with a tiny budget
+    for (;;) {
+        PairKey pair;
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!PopLocked(pair, job, Clock::now())) break;
+        }
+
+        bool hasLos = TraceAndCacheLineOfSight(pair.first, pair.second, job.start, job.end, job.policy);
+        auto done = Clock::now();
+        executed++;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Known& known = m_known[KnownKey{ pair, job.policy }];
+            known.hasLos = hasLos;
+            known.at = done;
+            m_stats.executed++;
+            m_latencyTotalMs += std::chrono::duration<double, std::milli>(done - job.submitted).count();
+        }
+        if (done - frameStart >= budget) break;
+    }
+    if (executed == 0) return;
+
+    double frameUs = std::chrono::duration<double, std::micro>(Clock::now() - frameStart).count();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.frames++;
+    m_stats.lastFrameUs = frameUs;
+    m_stats.maxFrameUs = (std::max)(m_stats.maxFrameUs, frameUs);
+    if (m_known.size() > MAX_KNOWN) {
+        auto now = Clock::now();
+        for (auto it = m_known.begin(); it != m_known.end();) {
+            if (now - it->second.at > std::chrono::milliseconds(MAX_STALE_MS)) it = m_known.erase(it);
+            else ++it;
+        }
+    }
+}
+
+void LosScheduler::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.clear();
+    m_fullQueue.clear();
+    m_fastQueue.clear();
+    m_known.clear();
+}
+
+void LosScheduler::SetFrameBudgetUs(int us) {
+    m_frameBudgetUs = (std::max)(MIN_FRAME_BUDGET_US, (std::min)(MAX_FRAME_BUDGET_US, us));
+}
+
+LosScheduler::Stats LosScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.pending = m_pending.size();
+    stats.avgLatencyMs = m_stats.executed > 0 ? m_latencyTotalMs / static_cast<double>(m_stats.executed) : 0.0;
+    return stats;
+}
+
+void LosScheduler::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = Stats();
+    m_latencyTotalMs = 0.0;
+}
+
+} // namespace Spells
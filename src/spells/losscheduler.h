@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "../types/types.h"
+#include "loscache.h"
+#include "lostrace.h"
+
+namespace Spells {
+
+/**
+ * Spreads line of sight checks for targeting candidates over frames.
+ * Targeting asks Query() for each candidate and gets the cached or last known answer at once; a unit
+ * without a current answer is queued. RunFrame(), called from EndScene (WorldIntersect must run on the
+ * render thread), works through the queue until the frame's microsecond budget is spent, so a big pull
+ * no longer fires hundreds of traces in one frame. Results land in LosCache.
+
+Last known answers are kept per policy: a Full query only takes a Full answer, a Fast query takes either.
+ *
+ * One pending check per unit pair (a newer request updates its positions); Full checks go before Fast.
+ * Thread-safe.
+ */
+class LosScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int DEFAULT_FRAME_BUDGET_US = 200;
+    static constexpr int MIN_FRAME_BUDGET_US = 50;
+    static constexpr int MAX_FRAME_BUDGET_US = 5000;
+    static constexpr int MAX_STALE_MS = 2000;   // Oldest last-known answer Query() still returns
+    static constexpr int MAX_JOB_AGE_MS = 1000; // Queued checks older than this are dropped (unit gone or moved on)
+    static constexpr size_t MAX_PENDING = 256;
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t merged = 0;       // Requests folded into a pending check of the same pair
+        uint64_t executed = 0;
+        uint64_t dropped = 0;      // Too old or queue full
+        uint64_t staleAnswers = 0; // Query() answered with a last known result while a check was queued
+        uint64_t unknown = 0;      // Query() had no answer yet
+        uint64_t frames = 0;       // RunFrame() calls that executed at least one check
+        size_t pending = 0;
+        double lastFrameUs = 0.0;
+        double maxFrameUs = 0.0;
+        double avgLatencyMs = 0.0; // Submit to result
+    };
+
+    static LosScheduler& GetInstance();
+
+    /**
+     * Non-blocking line of sight for a unit pair
+     * @param casterGuid GUID of the unit at start (non-zero)
+     * @param targetGuid GUID of the unit at end (non-zero)
+     * @param start Caster position
+     * @param end Target position
+     * @param policy Policy of the check
+     * @param outHasLos Answer
+     * @param outFresh Optional: false if the answer is a last known result while a new check is queued
+     * @return false if there is no answer yet (a check is queued)
+     */
+    bool Query(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy,
+               bool& outHasLos, bool* outFresh = nullptr);
+
+    /**
+     * Queue a check without asking for an answer (e.g. to warm up the next target)
+     */
+    void Submit(uint64_t casterGuid, uint64_t targetGuid, const Vector3& start, const Vector3& end, LosPolicy policy);
+
+    // Run queued checks within the frame budget. Render thread only.
+    void RunFrame();
+
+    // Drop queued checks and last known answers (e.g. on loading screens)
+    void Clear();
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled.load(); }
+
+    void SetFrameBudgetUs(int us);
+    int GetFrameBudgetUs() const { return m_frameBudgetUs.load(); }
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    LosScheduler() = default;
+    LosScheduler(const LosScheduler&) = delete;
+    LosScheduler& operator=(const LosScheduler&) = delete;
+
+    using PairKey = std::pair<uint64_t, uint64_t>;
+
+    struct Job {
+        Vector3 start;
+        Vector3 end;
+        LosPolicy policy = LosPolicy::Fast;
+        Clock::time_point submitted;
+    };
+
+    // Last known answer of a unit pair at one policy
+    struct KnownKey {
+        PairKey pair;
+        LosPolicy policy = LosPolicy::Fast;
+
+        bool operator==(const KnownKey& other) const { return pair == other.pair && policy == other.policy; }
+    };
+
+    struct KnownKeyHash {
+        size_t operator()(const KnownKey& key) const {
+            return GuidPairHash()(key.pair) ^ static_cast<size_t>(key.policy);
+        }
+    };
+
+    struct Known {
+        bool hasLos = false;
+        Clock::time_point at;
+    };
+
+    const Known* FindKnownLocked(const PairKey& pair, LosPolicy policy, Clock::time_point now) const;
+
+    void SubmitLocked(const PairKey& pair, const Vector3& start, const Vector3& end, LosPolicy policy, Clock::time_point now);
+    bool PopLocked(PairKey& outPair, Job& outJob, Clock::time_point now);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<PairKey, Job, GuidPairHash> m_pending;
+    std::deque<PairKey> m_fullQueue; // May hold pairs already executed; skipped when popped
+    std::deque<PairKey> m_fastQueue;
+    std::unordered_map<KnownKey, Known, KnownKeyHash> m_known;
+
+    std::atomic<bool> m_enabled{ true };
+    std::atomic<int> m_frameBudgetUs{ DEFAULT_FRAME_BUDGET_US };
+
+    Stats m_stats;
+    double m_latencyTotalMs = 0.0;
+};
+
+} // namespace Spells
@@ -0,0 +1,119 @@
+#include "lostrace.h"
+#include "targeting.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Spells {
+
+namespace {
+
+// Height offsets with both flag sets, then partial rays at base height
+const LosTraceStrategy::Trace kTraces[LosTraceStrategy::TRACE_COUNT] = {
+    { 0.0f, 1.0f, GameGenericLOS }, { 0.0f, 1.0f, GameObservedPlayerLOS },
+    { 0.5f, 1.0f, GameGenericLOS }, { 0.5f, 1.0f, GameObservedPlayerLOS },
+    { 1.0f, 1.0f, GameGenericLOS }, { 1.0f, 1.0f, GameObservedPlayerLOS },
+    { 1.5f, 1.0f, GameGenericLOS }, { 1.5f, 1.0f, GameObservedPlayerLOS },
+    { 2.0f, 1.0f, GameGenericLOS }, { 2.0f, 1.0f, GameObservedPlayerLOS },
+    { 0.0f, 0.2f, GameGenericLOS }, { 0.0f, 0.4f, GameGenericLOS },
+    { 0.0f, 0.6f, GameGenericLOS }, { 0.0f, 0.8f, GameGenericLOS },
+};
+
+// Eye height first, then outwards; longer partial rays before shorter ones
+const LosTraceStrategy::Order kDefaultOrder = { 6, 7, 8, 9, 4, 5, 13, 2, 3, 12, 0, 1, 11, 10 };
+
+// Halve the slot counters past this so the order follows the current area
+constexpr uint32_t SLOT_HISTORY_LIMIT = 1u << 16;
+
+} // namespace
+
+LosTraceStrategy& LosTraceStrategy::GetInstance() {
+    static LosTraceStrategy instance;
+    return instance;
+}
+
+LosTraceStrategy::LosTraceStrategy() : m_order(kDefaultOrder) {}
+
+const LosTraceStrategy::Trace& LosTraceStrategy::GetTrace(int slot) {
+    return kTraces[slot];
+}
+
+int LosTraceStrategy::RequiredClear(int traceCount, float horizontalDistance) {
+    // Closer targets are judged more leniently
+    float ratio = horizontalDistance < 20.0f ? 0.7f : 0.8f;
+    return (std::max)(1, static_cast<int>(std::ceil(ratio * static_cast<float>(traceCount) - 1e-4f)));
+}
+
+LosTraceStrategy::Order LosTraceStrategy::GetOrder() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_order;
+}
+
+int LosTraceStrategy::GetBudget(LosPolicy policy) const {
+    return policy == LosPolicy::Fast ? m_fastBudget.load(std::memory_order_relaxed) : TRACE_COUNT;
+}
+
+void LosTraceStrategy::Record(LosPolicy policy, const int8_t (&results)[TRACE_COUNT], int tracesRun, bool visible) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    PolicyStats& stats = policy == LosPolicy::Fast ? m_fast : m_full;
+    stats.checks++;
+    stats.traces += static_cast<uint64_t>(tracesRun);
+    if (visible) stats.visible++;
+    if (tracesRun < GetBudget(policy)) stats.earlyExits++;
+
+    for (int slot = 0; slot < TRACE_COUNT; ++slot) {
+        if (results[slot] == TRACE_NOT_RUN) continue;
+        m_slotRuns[slot]++;
+        if ((results[slot] == TRACE_CLEAR) == visible) m_slotAgreed[slot]++;
+        if (m_slotRuns[slot] > SLOT_HISTORY_LIMIT) {
+            m_slotRuns[slot] /= 2;
+            m_slotAgreed[slot] /= 2;
+        }
+    }
+
+    if (m_adaptiveOrder.load(std::memory_order_relaxed) && ++m_sinceReorder >= REORDER_INTERVAL) {
+        m_sinceReorder = 0;
+        ReorderLocked();
+    }
+}
+
+void LosTraceStrategy::ReorderLocked() {
+    float score[TRACE_COUNT];
+    for (int slot = 0; slot < TRACE_COUNT; ++slot) {
+        // Laplace prior keeps slots without history in their default place
+        score[slot] = (static_cast<float>(m_slotAgreed[slot]) + 1.0f) / (static_cast<float>(m_slotRuns[slot]) + 2.0f);
+    }
+    Order order = kDefaultOrder;
+    std::stable_sort(order.begin(), order.end(), [&score](uint8_t a, uint8_t b) { return score[a] > score[b]; });
+    m_order = order;
+}
+
+void LosTraceStrategy::SetAdaptiveOrderEnabled(bool enabled) {
+    m_adaptiveOrder = enabled;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (enabled) ReorderLocked();
+    else m_order = kDefaultOrder;
+}
+
+void LosTraceStrategy::SetFastBudget(int traces) {
+    m_fastBudget = (std::max)(1, (std::min)(TRACE_COUNT, traces));
+}
+
+LosTraceStrategy::Stats LosTraceStrategy::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.full = m_full;
+    stats.fast = m_fast;
+    stats.order = m_order;
+    for (int slot = 0; slot < TRACE_COUNT; ++slot) {
+        stats.agreement[slot] = m_slotRuns[slot] > 0 ? static_cast<float>(m_slotAgreed[slot]) / static_cast<float>(m_slotRuns[slot]) : 0.0f;
+    }
+    return stats;
+}
+
+void LosTraceStrategy::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_full = PolicyStats();
+    m_fast = PolicyStats();
+}
+
+} // namespace Spells
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace Spells {
+
+// How much work a line of sight check may spend
+enum class LosPolicy {
+    Full, // All traces until the verdict is certain (same verdict as running every trace)
+    Fast  // Only the most decisive traces, for filtering candidates
+};
+
+/**
+ * Trace plan for IsInLineOfSight: the 14 world traces (5 height offsets x 2 flag sets, plus 4
+ * partial rays from the start), the order they are fired in and when to stop.
+ *
+ * A check is visible when at least 70% of its traces are clear (80% beyond 20 yards). Traces are fired
+ * in order of how often each agreed with the final verdict (eye height first until there is history),
+ * and the check stops as soon as the remaining traces cannot change the verdict. The Fast policy only
+ * fires the first FastBudget traces of that order and applies the same ratio to them.
+ *
+ * Thread-safe.
+ */
+class LosTraceStrategy {
+public:
+    static constexpr int TRACE_COUNT = 14;
+    static constexpr int DEFAULT_FAST_BUDGET = 4;
+    static constexpr uint32_t REORDER_INTERVAL = 128; // Recorded checks between re-sorts of the order
+
+    struct Trace {
+        float heightOffset; // Added to both ends
+        float fraction;     // Part of the ray traced from the start (1 = whole ray)
+        uint32_t flags;     // IntersectFlags
+    };
+
+    using Order = std::array<uint8_t, TRACE_COUNT>;
+
+    // Per-check outcome of one trace slot
+    enum : int8_t { TRACE_NOT_RUN = -1, TRACE_BLOCKED = 0, TRACE_CLEAR = 1 };
+
+    struct PolicyStats {
+        uint64_t checks = 0;
+        uint64_t traces = 0;     // World traces fired
+        uint64_t visible = 0;
+        uint64_t earlyExits = 0; // Checks that stopped before their budget
+    };
+
+    struct Stats {
+        PolicyStats full;
+        PolicyStats fast;
+        Order order{};
+        std::array<float, TRACE_COUNT> agreement{}; // Per slot, how often its result matched the verdict
+    };
+
+    static LosTraceStrategy& GetInstance();
+
+    static const Trace& GetTrace(int slot);
+
+    /**
+     * Clear traces needed for a visible verdict
+     * @param traceCount Traces the policy may fire
+     * @param horizontalDistance Distance between the endpoints in the XY plane
+     */
+    static int RequiredClear(int traceCount, float horizontalDistance);
+
+    Order GetOrder() const;
+
+    // Traces a check under the policy may fire
+    int GetBudget(LosPolicy policy) const;
+
+    /**
+     * Record a finished check (feeds the adaptive order and the metrics)
+     * @param results Per slot TRACE_NOT_RUN / TRACE_BLOCKED / TRACE_CLEAR
+     * @param tracesRun Traces fired
+     * @param visible Verdict
+     */
+    void Record(LosPolicy policy, const int8_t (&results)[TRACE_COUNT], int tracesRun, bool visible);
+
+    void SetEarlyExitEnabled(bool enabled) { m_earlyExit = enabled; }
+    bool IsEarlyExitEnabled() const { return m_earlyExit.load(); }
+
+    void SetAdaptiveOrderEnabled(bool enabled);
+    bool IsAdaptiveOrderEnabled() const { return m_adaptiveOrder.load(); }
+
+    void SetFastBudget(int traces);
+    int GetFastBudget() const { return m_fastBudget.load(); }
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    LosTraceStrategy();
+    LosTraceStrategy(const LosTraceStrategy&) = delete;
+    LosTraceStrategy& operator=(const LosTraceStrategy&) = delete;
+
+    void ReorderLocked();
+
+    mutable std::mutex m_mutex;
+    Order m_order{};
+    uint32_t m_slotRuns[TRACE_COUNT] = {};
+    uint32_t m_slotAgreed[TRACE_COUNT] = {};
+    uint32_t m_sinceReorder = 0;
+    PolicyStats m_full;
+    PolicyStats m_fast;
+
+    std::atomic<bool> m_earlyExit{ true };
+    std::atomic<bool> m_adaptiveOrder{ true };
+    std::atomic<int> m_fastBudget{ DEFAULT_FAST_BUDGET };
+};
+
+} // namespace Spells
@@ -0,0 +1,172 @@
+#include "motiontracker.h"
+#include "../types/wowunit.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Spells {
+
+namespace {
+
+// Samples closer together than this replace the newest one instead of adding a zero-length segment
+constexpr auto MIN_SAMPLE_INTERVAL = std::chrono::milliseconds(50);
+// Tracks without a sample for this long belong to units that despawned or went out of range
+constexpr auto TRACK_TTL = std::chrono::seconds(5);
+
+constexpr float PI_F = 3.14159265358979323846f;
+
+float AngleBetween(float a, float b) {
+    float diff = std::fabs(a - b);
+    while (diff > 2.0f * PI_F) diff -= 2.0f * PI_F;
+    return diff > PI_F ? 2.0f * PI_F - diff : diff;
+}
+
+} // namespace
+
+MotionTracker& MotionTracker::GetInstance() {
+    static MotionTracker instance;
+    return instance;
+}
+
+void MotionTracker::Record(WowUnit& unit, bool flagsKnown) {
+    Vector3 position = unit.GetPosition();
+    if (position.IsZero()) return;
+    auto now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Track& track = m_tracks[unit.GetGUID64()];
+    if (track.count > 0 && now - Recent(track, 0).time < MIN_SAMPLE_INTERVAL) {
+        track.next = (track.next + HISTORY - 1) % HISTORY;
+        track.count--;
+    }
+    Sample& sample = track.samples[track.next];
+    sample.time = now;
+    sample.position = position;
+    sample.facing = unit.GetFacing();
+    sample.movementFlags = unit.GetMovementFlags();
+    track.next = (track.next + 1) % HISTORY;
+    track.count = (std::min)(track.count + 1, HISTORY);
+    track.standing = flagsKnown && !unit.IsMoving();
+    FitVelocity(track);
+    m_samples.fetch_add(1, std::memory_order_relaxed);
+
+    if (now - m_lastPrune > TRACK_TTL) PruneLocked(now);
+}
+
+void MotionTracker::FitVelocity(Track& track) {
+    track.velocity = Vector3();
+    if (track.count < 2 || track.standing) return;
+
+    const Sample& newest = Recent(track, 0);
+    const Sample& previous = Recent(track, 1);
+    if (newest.position.Distance(previous.position) < STOPPED_DISTANCE) return;
+
+    auto secondsBefore = [&newest](const Sample& sample) {
+        return std::chrono::duration<float>(sample.time - newest.time).count(); // <= 0
+    };
+
+    Vector3 velocity;
+    float segmentSeconds = -secondsBefore(previous);
+    if (AngleBetween(newest.facing, previous.facing) > TURN_ANGLE) {
+        // Turned: older samples describe the old heading
+        velocity = Vector3((newest.position.x - previous.position.x) / segmentSeconds,
+                           (newest.position.y - previous.position.y) / segmentSeconds,
+                           (newest.position.z - previous.position.z) / segmentSeconds);
+    } else {
+        // Least-squares slope over the samples in the window
+        size_t used = 0;
+        float sumT = 0.0f, sumX = 0.0f, sumY = 0.0f, sumZ = 0.0f;
+        for (size_t i = 0; i < track.count; ++i) {
+            const Sample& sample = Recent(track, i);
+            float t = secondsBefore(sample);
+            if (-t * 1000.0f > static_cast<float>(VELOCITY_WINDOW_MS)) break;
+            sumT += t;
+            sumX += sample.position.x;
+            sumY += sample.position.y;
+            sumZ += sample.position.z;
+            ++used;
+        }
+        float n = static_cast<float>(used);
+        float meanT = sumT / n, meanX = sumX / n, meanY = sumY / n, meanZ = sumZ / n;
+        float varT = 0.0f;
+        Vector3 cov;
+        for (size_t i = 0; i < used; ++i) {
+            const Sample& sample = Recent(track, i);
+            float dt = secondsBefore(sample) - meanT;
+            varT += dt * dt;
+            cov.x += dt * (sample.position.x - meanX);
+            cov.y += dt * (sample.position.y - meanY);
+            cov.z += dt * (sample.position.z - meanZ);
+        }
+        if (varT <= 1e-6f) return;
+        velocity = Vector3(cov.x / varT, cov.y / varT, cov.z / varT);
+    }
+
+    float speed = std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z);
+    if (speed > MAX_SPEED) return; // Teleport, blink or charge - don't extrapolate it
+    track.velocity = velocity;
+}
+
+Vector3 MotionTracker::PredictPosition(WowUnit* unit, int dtMs) {
+    if (!unit) return Vector3();
+    Vector3 cached = unit->GetPosition();
+    if (!m_enabled.load(std::memory_order_relaxed)) return cached;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_predictions.fetch_add(1, std::memory_order_relaxed);
+    auto it = m_tracks.find(unit->GetGUID64());
+    if (it == m_tracks.end() || it->second.count == 0) return cached;
+    const Track& track = it->second;
+    if (track.velocity.IsZero()) return cached;
+
+    const Sample& newest = Recent(track, 0);
+    float ms = std::chrono::duration<float, std::milli>(Clock::now() - newest.time).count() + static_cast<float>(dtMs);
+    float seconds = (std::max)(0.0f, (std::min)(static_cast<float>(MAX_PREDICT_MS), ms)) / 1000.0f;
+    m_moving.fetch_add(1, std::memory_order_relaxed);
+    return Vector3(newest.position.x + track.velocity.x * seconds,
+                   newest.position.y + track.velocity.y * seconds,
+                   newest.position.z + track.velocity.z * seconds);
+}
+
+float MotionTracker::PredictDistance(WowUnit* from, WowUnit* to, int dtMs) {
+    if (!from || !to) return 0.0f;
+    return PredictPosition(from, dtMs).Distance(PredictPosition(to, dtMs));
+}
+
+bool MotionTracker::GetVelocity(uint64_t guid, Vector3& outVelocity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_tracks.find(guid);
+    if (it == m_tracks.end()) return false;
+    outVelocity = it->second.velocity;
+    return true;
+}
+
+void MotionTracker::PruneLocked(Clock::time_point now) {
+    m_lastPrune = now;
+    for (auto it = m_tracks.begin(); it != m_tracks.end();) {
+        if (it->second.count == 0 || now - Recent(it->second, 0).time > TRACK_TTL) it = m_tracks.erase(it);
+        else ++it;
+    }
+}
+
+void MotionTracker::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tracks.clear();
+}
+
+MotionTracker::Stats MotionTracker::GetStats() const {
+    Stats stats;
+    stats.samples = m_samples.load(std::memory_order_relaxed);
+    stats.predictions = m_predictions.load(std::memory_order_relaxed);
+    stats.moving = m_moving.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.tracked = m_tracks.size();
+    return stats;
+}
+
+void MotionTracker::ResetStats() {
+    m_samples = 0;
+    m_predictions = 0;
+    m_moving = 0;
+}
+
+} // namespace Spells
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include "../types/types.h"
+
+class WowUnit;
+
+namespace Spells {
+
+/**
+ * Per-unit motion model for cast-time range, cone and line of sight checks.
+ * Unit positions are only refreshed by the ObjectManager update (every 500 ms), so a moving target
+ * is already up to half a second away from its cached position when a cast goes out. Each update
+ * records (time, position, facing, movement flags) into a short ring buffer per unit; the velocity
+ * is a least-squares fit over the samples of the last VELOCITY_WINDOW_MS, or the last segment alone
+ * once the unit turned sharply (kiting). PredictPosition() extrapolates from the newest sample.
+ *
+ * A unit whose last two samples are at the same spot (or the local player without locomotion
+ * flags) is treated as standing, so stationary targets keep their exact cached position.
+ *
+ * Thread-safe.
+ */
+class MotionTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t HISTORY = 6;
+    static constexpr int VELOCITY_WINDOW_MS = 1600; // Samples older than this don't shape the velocity
+    static constexpr int MAX_PREDICT_MS = 1500;     // Extrapolate at most this far past the newest sample
+    static constexpr float MAX_SPEED = 30.0f;       // Yards/second; faster fits are sampling glitches (teleports, blinks)
+    static constexpr float STOPPED_DISTANCE = 0.1f; // Yards between the last two samples below which the unit stands
+    static constexpr float TURN_ANGLE = 1.0f;       // Radians of facing change that reset the fit to the last segment
+
+    struct Stats {
+        uint64_t samples = 0;
+        uint64_t predictions = 0;
+        uint64_t moving = 0;   // Predictions that moved the position
+        size_t tracked = 0;
+    };
+
+    static MotionTracker& GetInstance();
+
+    /**
+     * Record a unit's state after an ObjectManager update
+     * @param unit Freshly updated unit
+     * @param flagsKnown Movement flags are read for this unit (local player only)
+     */
+    void Record(WowUnit& unit, bool flagsKnown);
+
+    /**
+     * Position of a unit dtMs from now, extrapolated from its samples
+     * @param unit Unit (its cached position is returned if it isn't tracked or stands still)
+     * @param dtMs Lead time, e.g. cast time plus latency (0 = where the unit is now)
+     */
+    Vector3 PredictPosition(WowUnit* unit, int dtMs = 0);
+
+    // Distance between two units' predicted positions
+    float PredictDistance(WowUnit* from, WowUnit* to, int dtMs = 0);
+
+    /**
+     * Estimated velocity in yards/second
+     * @return false if the unit isn't tracked
+     */
+    bool GetVelocity(uint64_t guid, Vector3& outVelocity);
+
+    // Drop every track (e.g. on loading screens)
+    void Clear();
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled.load(); }
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    MotionTracker() = default;
+    MotionTracker(const MotionTracker&) = delete;
+    MotionTracker& operator=(const MotionTracker&) = delete;
+
+    struct Sample {
+        Clock::time_point time;
+        Vector3 position;
+        float facing = 0.0f;
+        uint32_t movementFlags = 0;
+    };
+
+    struct Track {
+        std::array<Sample, HISTORY> samples;
+        size_t next = 0;  // Ring write position
+        size_t count = 0;
+        bool standing = false; // Movement flags known and no locomotion flag set
+        Vector3 velocity;      // Refit on every sample
+    };
+
+    static void FitVelocity(Track& track);
+    // i = 0 is the newest sample
+    static const Sample& Recent(const Track& track, size_t i) { return track.samples[(track.next + HISTORY - 1 - i) % HISTORY]; }
+    void PruneLocked(Clock::time_point now);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, Track> m_tracks;
+    Clock::time_point m_lastPrune;
+    std::atomic<bool> m_enabled{ true };
+
+    std::atomic<uint64_t> m_samples{ 0 };
+    std::atomic<uint64_t> m_predictions{ 0 };
+    std::atomic<uint64_t> m_moving{ 0 };
+};
+
+} // namespace Spells
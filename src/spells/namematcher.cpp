@@ -0,0 +1,161 @@
+#include "namematcher.h"
+#include "../types/wowunit.h"
+#include <cctype>
+#include <queue>
+
+namespace Spells {
+
+namespace {
+
+// Same folding as the std::tolower comparison this replaces
+inline uint8_t Fold(char c) {
+    return static_cast<uint8_t>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// Creature entries and player GUIDs share the memo
+constexpr uint64_t ENTRY_KEY_TAG = 1ull << 63;
+
+} // namespace
+
+void NameMatcher::Compile(const std::vector<std::string>& exactNames, const std::vector<std::string>& substrings, const std::string& filter) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CompileLocked(exactNames, substrings, filter);
+}
+
+void NameMatcher::SetFilter(const std::string& filter) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (filter == m_filter) return;
+    std::vector<std::string> exactNames = m_exactNames;
+    std::vector<std::string> substrings = m_substrings;
+    CompileLocked(exactNames, substrings, filter);
+}
+
+void NameMatcher::CompileLocked(const std::vector<std::string>& exactNames, const std::vector<std::string>& substrings, const std::string& filter) {
+    m_exactNames = exactNames;
+    m_substrings = substrings;
+    m_filter = filter;
+    m_hasFilter = !filter.empty();
+
+    // Byte classes: one per distinct (folded) byte used by a pattern, 0 for everything else
+    m_classOf.fill(0);
+    m_classCount = 1;
+    auto addClasses = [this](const std::string& pattern) {
+        for (char c : pattern) {
+            uint8_t& cls = m_classOf[Fold(c)];
+            if (cls == 0) cls = static_cast<uint8_t>(m_classCount++);
+        }
+    };
+    for (const auto& name : m_exactNames) addClasses(name);
+    for (const auto& sub : m_substrings) addClasses(sub);
+    addClasses(m_filter);
+    // Upper-case bytes share their lower-case class, so names are matched without folding a copy
+    for (int c = 0; c < 256; ++c) m_classOf[c] = m_classOf[Fold(static_cast<char>(c))];
+
+    m_nodes.assign(1, Node());
+    m_nodes[0].next.assign(m_classCount, -1);
+    for (const auto& name : m_exactNames) AddPattern(name, MATCH_NONE, true);
+    for (const auto& sub : m_substrings) AddPattern(sub, MATCH_BLACKLIST, false);
+    if (m_hasFilter) AddPattern(m_filter, MATCH_FILTER, false);
+
+    // Breadth-first: missing transitions follow the failure link, flags inherit along it
+    std::queue<int32_t> pending;
+    std::vector<int32_t> fail(m_nodes.size(), 0);
+    for (int cls = 0; cls < m_classCount; ++cls) {
+        int32_t child = m_nodes[0].next[cls];
+        if (child < 0) {
+            m_nodes[0].next[cls] = 0;
+        } else {
+            fail[child] = 0;
+            pending.push(child);
+        }
+    }
+    while (!pending.empty()) {
+        int32_t node = pending.front();
+        pending.pop();
+        m_nodes[node].flags |= m_nodes[fail[node]].flags;
+        for (int cls = 0; cls < m_classCount; ++cls) {
+            int32_t child = m_nodes[node].next[cls];
+            int32_t viaFail = m_nodes[fail[node]].next[cls];
+            if (child < 0) {
+                m_nodes[node].next[cls] = viaFail;
+            } else {
+                fail[child] = viaFail;
+                pending.push(child);
+            }
+        }
+    }
+
+    m_memo.clear();
+    m_stats.compiles++;
+}
+
+void NameMatcher::AddPattern(const std::string& pattern, uint8_t flags, bool exact) {
+    if (pattern.empty()) return;
+    int32_t node = 0;
+    for (char c : pattern) {
+        int cls = m_classOf[static_cast<unsigned char>(c)];
+        if (m_nodes[node].next[cls] < 0) {
+            Node child;
+            child.next.assign(m_classCount, -1);
+            child.depth = m_nodes[node].depth + 1;
+            m_nodes.push_back(std::move(child));
+            m_nodes[node].next[cls] = static_cast<int32_t>(m_nodes.size() - 1);
+        }
+        node = m_nodes[node].next[cls];
+    }
+    m_nodes[node].flags |= flags;
+    if (exact) m_nodes[node].exact = true;
+}
+
+uint8_t NameMatcher::MatchLocked(const std::string& name) const {
+    uint8_t flags = m_hasFilter ? MATCH_NONE : MATCH_FILTER;
+    if (m_nodes.empty()) return flags;
+
+    int32_t node = 0;
+    for (char c : name) {
+        node = m_nodes[node].next[m_classOf[static_cast<unsigned char>(c)]];
+        flags |= m_nodes[node].flags;
+    }
+    // The whole name is a trie path ending on an exact pattern
+    const Node& last = m_nodes[node];
+    if (last.exact && last.depth == static_cast<int32_t>(name.size())) flags |= MATCH_BLACKLIST;
+    return flags;
+}
+
+uint8_t NameMatcher::Match(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return MatchLocked(name);
+}
+
+uint8_t NameMatcher::Classify(WowUnit* unit) {
+    if (!unit) return MATCH_NONE;
+    // Pets and summons can be renamed (hunter pets, mind-controlled players), so they are keyed by GUID
+    uint32_t entry = unit->GetEntry();
+    uint64_t key = (entry != 0 && !unit->IsPet()) ? (ENTRY_KEY_TAG | entry) : unit->GetGUID64();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.lookups++;
+    auto it = m_memo.find(key);
+    if (it != m_memo.end()) {
+        m_stats.memoHits++;
+        return it->second;
+    }
+
+    std::string name = unit->GetName();
+    if (name.empty()) return MATCH_NONE; // Not read yet, don't remember it
+
+    uint8_t flags = MatchLocked(name);
+    if (m_memo.size() >= MAX_MEMO_ENTRIES) m_memo.clear();
+    m_memo.emplace(key, flags);
+    return flags;
+}
+
+NameMatcher::Stats NameMatcher::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.nodes = m_nodes.size();
+    stats.memoEntries = m_memo.size();
+    return stats;
+}
+
+} // namespace Spells
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WowUnit;
+
+namespace Spells {
+
+/**
+ * Case-insensitive unit name matching against the blacklist and the user name filter.
+ * All patterns (exact blacklist names, blacklist substrings, filter) are compiled into one
+ * Aho-Corasick automaton, so a name is classified in a single pass without lowercasing a copy.
+ * Results are memoized per creature entry (per GUID for players and for pets/summons, whose names can
+ * differ from their entry's), so a unit's name is only read
+ * the first time its entry is seen after a (re)compile.
+ *
+ * Thread-safe.
+ */
+class NameMatcher {
+public:
+    enum MatchFlags : uint8_t {
+        MATCH_NONE = 0,
+        MATCH_BLACKLIST = 1 << 0, // Exact blacklist name or contains a blacklisted substring
+        MATCH_FILTER = 1 << 1,    // Contains the name filter (always set while no filter is compiled)
+    };
+
+    struct Stats {
+        uint64_t lookups = 0;
+        uint64_t memoHits = 0;
+        uint64_t compiles = 0;
+        size_t nodes = 0;
+        size_t memoEntries = 0;
+    };
+
+    /**
+     * Rebuild the automaton (drops the memo)
+     * @param exactNames Names blacklisted as a whole
+     * @param substrings Blacklisted if contained in the name
+     * @param filter Name filter, empty for none
+     */
+    void Compile(const std::vector<std::string>& exactNames, const std::vector<std::string>& substrings, const std::string& filter);
+
+    // Recompile with a new name filter if it differs from the current one
+    void SetFilter(const std::string& filter);
+
+    /**
+     * Classify a unit's name (memoized)
+     * @return MatchFlags; MATCH_NONE for a unit without a name yet
+     */
+    uint8_t Classify(WowUnit* unit);
+
+    // Classify a raw name (not memoized)
+    uint8_t Match(const std::string& name) const;
+
+    Stats GetStats() const;
+
+private:
+    static constexpr size_t MAX_MEMO_ENTRIES = 4096;
+
+    struct Node {
+        std::vector<int32_t> next; // Goto/failure transitions, indexed by byte class
+        uint8_t flags = MATCH_NONE;  // Substring matches ending here (including suffixes)
+        bool exact = false;          // An exact name ends here
+        int32_t depth = 0;
+    };
+
+    void CompileLocked(const std::vector<std::string>& exactNames, const std::vector<std::string>& substrings, const std::string& filter);
+    void AddPattern(const std::string& pattern, uint8_t flags, bool exact);
+    uint8_t MatchLocked(const std::string& name) const;
+
+    mutable std::mutex m_mutex;
+    std::array<uint8_t, 256> m_classOf{}; // Lowercased byte -> class, 0 = not in any pattern
+    int m_classCount = 1;
+    std::vector<Node> m_nodes;
+    bool m_hasFilter = false;
+
+    std::vector<std::string> m_exactNames;
+    std::vector<std::string> m_substrings;
+    std::string m_filter;
+
+    std::unordered_map<uint64_t, uint8_t> m_memo; // Entry (tagged), or player/pet GUID -> flags
+    Stats m_stats;
+};
+
+} // namespace Spells
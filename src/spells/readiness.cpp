@@ -0,0 +1,121 @@
+#include "readiness.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Spells {
+
+void ReadinessTimeline::SetSpellCost(int spellId, int powerType, int cost) {
+    SpellSlot& slot = m_slots[spellId];
+    slot.powerType = cost > 0 ? powerType : -1;
+    slot.cost = cost > 0 ? cost : 0;
+}
+
+void ReadinessTimeline::ObservePower(int powerType, int value, Clock::time_point now) {
+    PowerSample& sample = m_power[powerType];
+    if (!sample.hasSample) {
+        sample.lastValue = value;
+        sample.lastTime = now;
+        sample.hasSample = true;
+        return;
+    }
+    if (value == sample.lastValue) {
+        return; // Cached power only changes on ObjectManager updates
+    }
+
+    float dtSec = std::chrono::duration<float>(now - sample.lastTime).count();
+    if (value > sample.lastValue && dtSec > 0.05f) {
+        float rate = static_cast<float>(value - sample.lastValue) / dtSec;
+        sample.regenPerSec = sample.regenPerSec <= 0.0f ? rate : (sample.regenPerSec + 0.2f * (rate - sample.regenPerSec));
+    }
+    sample.lastValue = value;
+    sample.lastTime = now;
+}
+
+ReadinessTimeline::Clock::time_point ReadinessTimeline::ResourceReadyTime(const SpellSlot& slot, Clock::time_point now) const {
+    if (slot.powerType < 0 || slot.cost <= 0) return now;
+
+    auto it = m_power.find(slot.powerType);
+    if (it == m_power.end() || !it->second.hasSample) return now;
+
+    const PowerSample& sample = it->second;
+    int missing = slot.cost - sample.lastValue;
+    if (missing <= 0) return now;
+    // Resources that don't regenerate (rage) can't be predicted - leave it to the idle cap
+    if (sample.regenPerSec <= 0.0f) return now;
+
+    auto waitMs = static_cast<long long>(std::ceil(1000.0f * static_cast<float>(missing) / sample.regenPerSec));
+    return sample.lastTime + std::chrono::milliseconds(waitMs);
+}
+
+void ReadinessTimeline::Schedule(int spellId, Clock::time_point cooldownReadyAt, Clock::time_point now) {
+    SpellSlot& slot = m_slots[spellId];
+    Clock::time_point readyAt = (std::max)(cooldownReadyAt, ResourceReadyTime(slot, now));
+
+    auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(readyAt - slot.readyAt).count();
+    bool moved = std::llabs(delta) > RESCHEDULE_TOLERANCE_MS;
+    slot.readyAt = readyAt;
+
+    if (readyAt <= now) {
+        // Already usable - nothing to wait for
+        if (slot.pending) {
+            slot.pending = false;
+            ++slot.version; // Invalidate the heap entry
+            --m_pendingCount;
+        }
+        return;
+    }
+    if (slot.pending && !moved) {
+        return;
+    }
+
+    if (!slot.pending) ++m_pendingCount;
+    slot.pending = true;
+    ++slot.version;
+    m_heap.push({ readyAt, spellId, slot.version });
+}
+
+void ReadinessTimeline::DropStale(Clock::time_point now) {
+    while (!m_heap.empty()) {
+        const HeapEntry& top = m_heap.top();
+        auto it = m_slots.find(top.spellId);
+        bool stale = (it == m_slots.end() || !it->second.pending || it->second.version != top.version);
+        if (stale) {
+            m_heap.pop();
+            continue;
+        }
+        if (top.readyAt <= now) {
+            // Became ready - stop tracking until it's rescheduled
+            it->second.pending = false;
+            --m_pendingCount;
+            m_heap.pop();
+            continue;
+        }
+        break;
+    }
+}
+
+bool ReadinessTimeline::NextPendingReadyTime(Clock::time_point now, Clock::time_point& outTime) {
+    DropStale(now);
+    if (m_heap.empty()) return false;
+    outTime = m_heap.top().readyAt;
+    return true;
+}
+
+ReadinessTimeline::Clock::time_point ReadinessTimeline::GetReadyTime(int spellId) const {
+    auto it = m_slots.find(spellId);
+    return it != m_slots.end() ? it->second.readyAt : Clock::time_point{};
+}
+
+float ReadinessTimeline::GetRegenPerSecond(int powerType) const {
+    auto it = m_power.find(powerType);
+    return it != m_power.end() ? it->second.regenPerSec : 0.0f;
+}
+
+void ReadinessTimeline::Clear() {
+    m_heap = decltype(m_heap)();
+    m_slots.clear();
+    m_pendingCount = 0;
+    // Learned regen rates are kept - they belong to the character, not the profile
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <unordered_map>
+#include <queue>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+
+namespace Spells {
+
+/**
+ * Readiness timeline for the spells of the active rotation: a min-heap of (ready time, spellId)
+ * combining cooldown/GCD/charge readiness (supplied by CooldownManager) with a resource estimate
+ * based on learned power regeneration. Lets the rotation sleep until the earliest spell becomes
+ * usable instead of re-evaluating every step every tick.
+ *
+ * Not thread-safe on its own - CooldownManager owns it and guards it with its mutex.
+ */
+class ReadinessTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Re-push a spell only when its ready time moved by more than this (avoids heap churn from regen noise)
+    static constexpr int RESCHEDULE_TOLERANCE_MS = 50;
+
+    /**
+     * Set the resource cost of a spell
+     * @param spellId The ID of the spell
+     * @param powerType PowerType index (see types.h), or -1 for no cost
+     * @param cost Resource cost
+     */
+    void SetSpellCost(int spellId, int powerType, int cost);
+
+    /**
+     * Feed the player's current power for a type. Regeneration per second is learned from increases.
+     * @param powerType PowerType index
+     * @param value Current power
+     * @param now Time of the observation
+     */
+    void ObservePower(int powerType, int value, Clock::time_point now);
+
+    /**
+     * (Re)schedule a spell. The resource constraint is added on top of the given time.
+     * @param spellId The ID of the spell
+     * @param cooldownReadyAt When cooldown, GCD and charges allow the spell
+     * @param now Current time
+     */
+    void Schedule(int spellId, Clock::time_point cooldownReadyAt, Clock::time_point now);
+
+    /**
+     * Earliest ready time among spells that are not ready yet. Spells that already became ready
+     * are dropped from the heap until they are rescheduled (e.g. after being cast).
+     * @param now Current time
+     * @param outTime Earliest pending ready time
+     * @return false if no spell is pending
+     */
+    bool NextPendingReadyTime(Clock::time_point now, Clock::time_point& outTime);
+
+    /**
+     * @param spellId The ID of the spell
+     * @return Last scheduled ready time (default time point if unknown)
+     */
+    Clock::time_point GetReadyTime(int spellId) const;
+
+    /**
+     * @param powerType PowerType index
+     * @return Learned regeneration in power per second (0 if unknown)
+     */
+    float GetRegenPerSecond(int powerType) const;
+
+    /**
+     * @return Number of spells that currently have a pending entry in the heap
+     */
+    size_t GetPendingCount() const { return m_pendingCount; }
+
+    void Clear();
+
+private:
+    struct HeapEntry {
+        Clock::time_point readyAt;
+        int spellId;
+        uint32_t version;
+        bool operator>(const HeapEntry& other) const { return readyAt > other.readyAt; }
+    };
+
+    struct SpellSlot {
+        Clock::time_point readyAt{};
+        uint32_t version = 0;
+        bool pending = false; // Has a live entry in the heap
+        int powerType = -1;
+        int cost = 0;
+    };
+
+    struct PowerSample {
+        int lastValue = 0;
+        Clock::time_point lastTime{};
+        bool hasSample = false;
+        float regenPerSec = 0.0f; // EMA of observed increases
+    };
+
+    Clock::time_point ResourceReadyTime(const SpellSlot& slot, Clock::time_point now) const;
+    void DropStale(Clock::time_point now);
+
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> m_heap;
+    std::unordered_map<int, SpellSlot> m_slots;
+    std::unordered_map<int, PowerSample> m_power;
+    size_t m_pendingCount = 0;
+};
+
+}
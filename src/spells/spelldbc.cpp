@@ -0,0 +1,244 @@
+#include "spelldbc.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Spells {
+
+namespace {
+
+// --- Spell.dbc field indices (3.3.5a 12340, 234 fields) ---
+constexpr uint32_t SPELL_FIELD_ATTRIBUTES_EX = 5;
+constexpr uint32_t SPELL_FIELD_CASTING_TIME_INDEX = 28;
+constexpr uint32_t SPELL_FIELD_RECOVERY_TIME = 29;
+constexpr uint32_t SPELL_FIELD_CATEGORY_RECOVERY_TIME = 30;
+constexpr uint32_t SPELL_FIELD_INTERRUPT_FLAGS = 31;
+constexpr uint32_t SPELL_FIELD_CHANNEL_INTERRUPT_FLAGS = 33;
+constexpr uint32_t SPELL_FIELD_POWER_TYPE = 41;
+constexpr uint32_t SPELL_FIELD_MANA_COST = 42;
+constexpr uint32_t SPELL_FIELD_RANGE_INDEX = 46;
+constexpr uint32_t SPELL_FIELD_MANA_COST_PCT = 204;
+constexpr uint32_t SPELL_FIELD_START_RECOVERY_TIME = 206;
+constexpr uint32_t SPELL_MIN_FIELDS = SPELL_FIELD_START_RECOVERY_TIME + 1;
+
+constexpr uint32_t SPELL_ATTR1_CHANNELED_1 = 0x00000004;
+constexpr uint32_t SPELL_ATTR1_CHANNELED_2 = 0x00000040;
+constexpr uint32_t SPELL_INTERRUPT_FLAG_MOVEMENT = 0x00000001;
+constexpr uint32_t CHANNEL_INTERRUPT_FLAG_MOVE = 0x00000008;
+
+// WDBC file header
+#pragma pack(push, 1)
+struct DbcHeader {
+    char magic[4];
+    uint32_t recordCount;
+    uint32_t fieldCount;
+    uint32_t recordSize;
+    uint32_t stringBlockSize;
+};
+#pragma pack(pop)
+
+// Returns the header if the mapped file is a well-formed WDBC file
+const DbcHeader* ValidateDbc(const MappedFile& file, uint32_t minFields) {
+    if (!file.IsOpen() || file.Size() < sizeof(DbcHeader)) return nullptr;
+    const DbcHeader* header = reinterpret_cast<const DbcHeader*>(file.Data());
+    if (std::memcmp(header->magic, "WDBC", 4) != 0) return nullptr;
+    if (header->fieldCount < minFields || header->recordSize < header->fieldCount * 4) return nullptr;
+    size_t needed = sizeof(DbcHeader) + static_cast<size_t>(header->recordCount) * header->recordSize + header->stringBlockSize;
+    if (needed > file.Size()) return nullptr;
+    return header;
+}
+
+const uint32_t* DbcRecord(const MappedFile& file, const DbcHeader* header, uint32_t index) {
+    return reinterpret_cast<const uint32_t*>(file.Data() + sizeof(DbcHeader) + static_cast<size_t>(index) * header->recordSize);
+}
+
+float AsFloat(uint32_t raw) {
+    float value;
+    std::memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+// --- MappedFile ---
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+#else
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+}
+#endif
+
+// --- SpellDbc ---
+
+SpellDbc::LoadResult SpellDbc::Load(const std::string& directory) {
+    // Small lookup tables are copied out; the mappings are released right away
+    MappedFile castTimes;
+    if (castTimes.Open(directory + "/SpellCastTimes.dbc")) {
+        if (const DbcHeader* header = ValidateDbc(castTimes, 2)) {
+            m_castTimes.clear();
+            for (uint32_t i = 0; i < header->recordCount; ++i) {
+                const uint32_t* rec = DbcRecord(castTimes, header, i);
+                m_castTimes[rec[0]] = static_cast<int32_t>(rec[1]);
+            }
+        }
+    }
+
+    MappedFile ranges;
+    if (ranges.Open(directory + "/SpellRange.dbc")) {
+        if (const DbcHeader* header = ValidateDbc(ranges, 5)) {
+            m_ranges.clear();
+            for (uint32_t i = 0; i < header->recordCount; ++i) {
+                const uint32_t* rec = DbcRecord(ranges, header, i);
+                // id, minRangeHostile, minRangeFriend, maxRangeHostile, maxRangeFriend
+                m_ranges[rec[0]] = { AsFloat(rec[1]), AsFloat(rec[3]), AsFloat(rec[4]) };
+            }
+        }
+    }
+
+    m_spellDbc.Close();
+    m_recordCount = m_fieldCount = m_recordSize = 0;
+    if (!m_spellDbc.Open(directory + "/Spell.dbc")) return LoadResult::MISSING;
+    const DbcHeader* header = ValidateDbc(m_spellDbc, SPELL_MIN_FIELDS);
+    if (!header) {
+        m_spellDbc.Close();
+        return LoadResult::INVALID;
+    }
+
+    m_recordCount = header->recordCount;
+    m_fieldCount = header->fieldCount;
+    m_recordSize = header->recordSize;
+    return LoadResult::OK;
+}
+
+size_t SpellDbc::FindRecords(const std::vector<uint32_t>& sortedIds, std::vector<SpellInfo>& out) const {
+    if (!m_spellDbc.IsOpen() || sortedIds.empty()) return 0;
+    const uint8_t* records = m_spellDbc.Data() + sizeof(DbcHeader);
+    size_t found = 0;
+    for (uint32_t i = 0; i < m_recordCount && found < sortedIds.size(); ++i) {
+        const uint32_t* rec = reinterpret_cast<const uint32_t*>(records + static_cast<size_t>(i) * m_recordSize);
+        if (!std::binary_search(sortedIds.begin(), sortedIds.end(), rec[SPELL_FIELD_ID])) continue;
+        SpellInfo info;
+        DecodeSpellRecord(rec, m_fieldCount, info);
+        out.push_back(info);
+        ++found;
+    }
+    return found;
+}
+
+void SpellDbc::DecodeSpellRecord(const uint32_t* fields, uint32_t fieldCount, SpellInfo& info) const {
+    info.id = fields[SPELL_FIELD_ID];
+    info.recoveryTimeMs = fields[SPELL_FIELD_RECOVERY_TIME];
+    info.categoryRecoveryTimeMs = fields[SPELL_FIELD_CATEGORY_RECOVERY_TIME];
+    info.powerType = static_cast<uint8_t>(fields[SPELL_FIELD_POWER_TYPE]);
+    info.manaCost = fields[SPELL_FIELD_MANA_COST];
+    info.flags = 0;
+    if (fieldCount > SPELL_FIELD_START_RECOVERY_TIME) {
+        info.manaCostPercentage = static_cast<uint16_t>(fields[SPELL_FIELD_MANA_COST_PCT]);
+        info.startRecoveryTimeMs = fields[SPELL_FIELD_START_RECOVERY_TIME];
+    }
+
+    uint32_t attributesEx = fields[SPELL_FIELD_ATTRIBUTES_EX];
+    bool isChannel = (attributesEx & (SPELL_ATTR1_CHANNELED_1 | SPELL_ATTR1_CHANNELED_2)) != 0;
+    if (isChannel) info.flags |= SpellInfo::FLAG_CHANNEL;
+
+    auto castIt = m_castTimes.find(fields[SPELL_FIELD_CASTING_TIME_INDEX]);
+    if (castIt != m_castTimes.end()) {
+        info.castTimeMs = castIt->second;
+        info.flags |= SpellInfo::FLAG_HAS_CAST_TIME;
+    }
+
+    auto rangeIt = m_ranges.find(fields[SPELL_FIELD_RANGE_INDEX]);
+    if (rangeIt != m_ranges.end()) {
+        info.minRange = rangeIt->second.minHostile;
+        info.maxRange = rangeIt->second.maxHostile;
+        info.maxRangeFriendly = rangeIt->second.maxFriendly;
+        info.flags |= SpellInfo::FLAG_HAS_RANGE;
+    }
+
+    // Movement: channels check ChannelInterruptFlags, casts check InterruptFlags; instants never break
+    bool moveCastable;
+    if (isChannel) {
+        moveCastable = (fields[SPELL_FIELD_CHANNEL_INTERRUPT_FLAGS] & CHANNEL_INTERRUPT_FLAG_MOVE) == 0;
+    } else {
+        bool instant = info.HasCastTime() && info.castTimeMs <= 0;
+        moveCastable = instant || (fields[SPELL_FIELD_INTERRUPT_FLAGS] & SPELL_INTERRUPT_FLAG_MOVEMENT) == 0;
+    }
+    if (moveCastable) info.flags |= SpellInfo::FLAG_MOVE_CASTABLE;
+}
+
+}
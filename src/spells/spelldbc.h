@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Spells {
+
+// Static spell data resolved from the client's spell records (Spell.dbc layout, 3.3.5a 12340).
+// Kept small so the sorted table stays cache-friendly.
+struct SpellInfo {
+    enum Flags : uint8_t {
+        FLAG_CHANNEL         = 0x01, // AttributesEx channel bits
+        FLAG_MOVE_CASTABLE   = 0x02, // Not interrupted by movement (instant, or no movement interrupt flag)
+        FLAG_HAS_CAST_TIME   = 0x04, // castTimeMs resolved through SpellCastTimes
+        FLAG_HAS_RANGE       = 0x08, // ranges resolved through SpellRange
+    };
+
+    uint32_t id = 0;
+    int32_t castTimeMs = 0;              // Base (unhasted) cast time
+    uint32_t recoveryTimeMs = 0;         // Spell cooldown
+    uint32_t categoryRecoveryTimeMs = 0; // Shared category cooldown
+    uint32_t startRecoveryTimeMs = 0;    // GCD triggered by this spell (0 = off GCD)
+    uint32_t manaCost = 0;               // Flat cost in powerType units
+    float minRange = 0.0f;               // Hostile min range (yards)
+    float maxRange = 0.0f;               // Hostile max range (yards)
+    float maxRangeFriendly = 0.0f;       // Friendly max range (yards)
+    uint16_t manaCostPercentage = 0;     // Percent of base mana (0 if flat cost)
+    uint8_t powerType = 0;               // PowerType index
+    uint8_t flags = 0;
+
+    bool IsChannel() const { return (flags & FLAG_CHANNEL) != 0; }
+    bool IsCastableWhileMoving() const { return (flags & FLAG_MOVE_CASTABLE) != 0; }
+    bool HasCastTime() const { return (flags & FLAG_HAS_CAST_TIME) != 0; }
+    bool HasRange() const { return (flags & FLAG_HAS_RANGE) != 0; }
+};
+
+// Read-only view of a memory-mapped file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_data != nullptr; }
+    const uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+/**
+ * Spell.dbc-layout decoding with no dependency on the running client, so it builds and is tested
+ * on any platform (see tests/). Holds the mapped Spell.dbc plus the SpellCastTimes / SpellRange
+ * lookups its records index into.
+ */
+class SpellDbc {
+public:
+    static constexpr uint32_t SPELL_FIELD_COUNT = 234; // 3.3.5a 12340
+    static constexpr uint32_t SPELL_FIELD_ID = 0;
+
+    enum class LoadResult {
+        OK,
+        MISSING, // No Spell.dbc in the directory
+        INVALID  // Spell.dbc is not a well-formed WDBC file or is too narrow
+    };
+
+    /**
+     * Copy SpellCastTimes.dbc / SpellRange.dbc and map Spell.dbc from a directory.
+     * The lookups are kept even without Spell.dbc; client records decode through them too.
+     * @param directory Folder containing the extracted .dbc files
+     * @return Load result for Spell.dbc
+     */
+    LoadResult Load(const std::string& directory);
+
+    bool IsMapped() const { return m_spellDbc.IsOpen(); }
+    uint32_t GetRecordCount() const { return m_recordCount; }
+    uint32_t GetFieldCount() const { return m_fieldCount; }
+    size_t GetCastTimeCount() const { return m_castTimes.size(); }
+    size_t GetRangeCount() const { return m_ranges.size(); }
+
+    /**
+     * Decode the mapped records whose id is in sortedIds (one linear pass over the id column)
+     * @param sortedIds Wanted spell ids, sorted and unique
+     * @param out Decoded records are appended here
+     * @return Number of records decoded
+     */
+    size_t FindRecords(const std::vector<uint32_t>& sortedIds, std::vector<SpellInfo>& out) const;
+
+    /**
+     * Fill info from one Spell.dbc-layout record (array of 32-bit fields)
+     * @param fields Record fields
+     * @param fieldCount Number of fields in the record (narrow records skip the trailing columns)
+     * @param info Receives the metadata
+     */
+    void DecodeSpellRecord(const uint32_t* fields, uint32_t fieldCount, SpellInfo& info) const;
+
+private:
+    MappedFile m_spellDbc;
+    uint32_t m_recordCount = 0;
+    uint32_t m_fieldCount = 0;
+    uint32_t m_recordSize = 0;
+
+    std::unordered_map<uint32_t, int32_t> m_castTimes; // SpellCastTimes id -> base ms
+    struct RangeEntry { float minHostile; float maxHostile; float maxFriendly; };
+    std::unordered_map<uint32_t, RangeEntry> m_ranges; // SpellRange id -> ranges
+};
+
+}
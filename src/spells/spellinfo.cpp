@@ -0,0 +1,167 @@
+#include "spellinfo.h"
+#include "../types/Rotation.h"
+#include "../utils/memory.h"
+#include "../logs/log.h"
+#include <algorithm>
+
+namespace Spells {
+
+namespace {
+
+// --- Client spell DB (VERIFY THESE FOR YOUR VERSION) ---
+constexpr uintptr_t SPELL_DB_ADDR = 0x00AD49D0;              // WowClientDB<SpellRec>
+constexpr uintptr_t CLIENTDB_GET_LOCALIZED_ROW_ADDR = 0x004CFD20;
+constexpr uintptr_t CLIENTDB_MAX_INDEX_OFFSET = 0x0C;
+constexpr uintptr_t CLIENTDB_MIN_INDEX_OFFSET = 0x10;
+typedef int(__thiscall* ClientDb_GetLocalizedRow_t)(void* pThis, int index, void* outRow);
+
+} // namespace
+
+// --- SpellInfoCache ---
+
+SpellInfoCache& SpellInfoCache::GetInstance() {
+    static SpellInfoCache instance;
+    return instance;
+}
+
+bool SpellInfoCache::LoadDbcDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    SpellDbc::LoadResult result = m_dbc.Load(directory);
+    if (result == SpellDbc::LoadResult::MISSING) {
+        Core::Log::Message("[SpellInfoCache] Spell.dbc not found in " + directory + ". Falling back to the client spell DB.");
+        return false;
+    }
+    if (result == SpellDbc::LoadResult::INVALID) {
+        Core::Log::Message("[SpellInfoCache] Spell.dbc in " + directory + " is not a valid WDBC file. Ignoring it.");
+        return false;
+    }
+    if (m_dbc.GetFieldCount() != SpellDbc::SPELL_FIELD_COUNT) {
+        Core::Log::Message("[SpellInfoCache] WARNING: Spell.dbc has " + std::to_string(m_dbc.GetFieldCount()) +
+                           " fields (expected " + std::to_string(SpellDbc::SPELL_FIELD_COUNT) + "). Field indices may be wrong.");
+    }
+
+    Core::Log::Message("[SpellInfoCache] Mapped Spell.dbc (" + std::to_string(m_dbc.GetRecordCount()) + " records), " +
+                       std::to_string(m_dbc.GetCastTimeCount()) + " cast times, " + std::to_string(m_dbc.GetRangeCount()) + " ranges.");
+    return true;
+}
+
+bool SpellInfoCache::ReadFromClient(uint32_t spellId, SpellInfo& info) const {
+    try {
+        int maxIndex = Memory::Read<int>(SPELL_DB_ADDR + CLIENTDB_MAX_INDEX_OFFSET);
+        int minIndex = Memory::Read<int>(SPELL_DB_ADDR + CLIENTDB_MIN_INDEX_OFFSET);
+        if (static_cast<int>(spellId) < minIndex || static_cast<int>(spellId) > maxIndex) return false;
+
+        // Spell rows are stored compressed; the client decompresses into the caller's buffer
+        uint32_t row[SpellDbc::SPELL_FIELD_COUNT + 16] = { 0 };
+        auto getRow = reinterpret_cast<ClientDb_GetLocalizedRow_t>(CLIENTDB_GET_LOCALIZED_ROW_ADDR);
+        if (!getRow(reinterpret_cast<void*>(SPELL_DB_ADDR), static_cast<int>(spellId), row)) return false;
+        if (row[SpellDbc::SPELL_FIELD_ID] != spellId) return false;
+
+        m_dbc.DecodeSpellRecord(row, SpellDbc::SPELL_FIELD_COUNT, info);
+        return true;
+    } catch (const MemoryAccessError& e) {
+        Core::Log::Message(std::string("[SpellInfoCache] Client spell DB read failed: ") + e.what());
+        return false;
+    }
+}
+
+size_t SpellInfoCache::Resolve(const std::vector<uint32_t>& spellIds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Collect ids that are not in the table yet
+    std::vector<uint32_t> wanted;
+    for (uint32_t id : spellIds) {
+        if (id == 0) continue;
+        auto it = std::lower_bound(m_table.begin(), m_table.end(), id,
+                                   [](const SpellInfo& info, uint32_t value) { return info.id < value; });
+        if (it == m_table.end() || it->id != id) wanted.push_back(id);
+    }
+    std::sort(wanted.begin(), wanted.end());
+    wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+    if (wanted.empty()) return 0;
+
+    std::vector<SpellInfo> resolved;
+    resolved.reserve(wanted.size());
+
+    if (m_dbc.IsMapped()) {
+        // One linear pass over the id column; only matching records are decoded
+        m_dbc.FindRecords(wanted, resolved);
+    } else {
+        for (uint32_t id : wanted) {
+            SpellInfo info;
+            if (ReadFromClient(id, info)) resolved.push_back(info);
+        }
+    }
+
+    if (resolved.size() < wanted.size()) {
+        Core::Log::Message("[SpellInfoCache] Resolved " + std::to_string(resolved.size()) + " of " +
+                           std::to_string(wanted.size()) + " requested spells.");
+    }
+
+    m_table.insert(m_table.end(), resolved.begin(), resolved.end());
+    std::sort(m_table.begin(), m_table.end(), [](const SpellInfo& a, const SpellInfo& b) { return a.id < b.id; });
+    return resolved.size();
+}
+
+bool SpellInfoCache::Get(uint32_t spellId, SpellInfo& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::lower_bound(m_table.begin(), m_table.end(), spellId,
+                               [](const SpellInfo& info, uint32_t value) { return info.id < value; });
+    if (it == m_table.end() || it->id != spellId) return false;
+    out = *it;
+    return true;
+}
+
+size_t SpellInfoCache::ApplyToProfile(Rotation::RotationProfile& profile, bool resolve) {
+    if (resolve) {
+        std::vector<uint32_t> ids;
+        ids.reserve(profile.steps.size());
+        for (const auto& step : profile.steps) ids.push_back(step.spellId);
+        Resolve(ids);
+    }
+
+    size_t updated = 0;
+    for (auto& step : profile.steps) {
+        SpellInfo info;
+        if (!Get(step.spellId, info)) continue;
+
+        step.isChannel = info.IsChannel();
+        step.castableWhileMoving = info.IsCastableWhileMoving();
+        if (info.HasCastTime()) {
+            step.castTime = static_cast<float>(info.castTimeMs) / 1000.0f; // Profiles use seconds
+        }
+        if (info.HasRange()) {
+            step.minRange = info.minRange;
+            // Friendly spells (heals, buffs) use the friendly range column
+            step.maxRange = step.isHeal ? info.maxRangeFriendly : info.maxRange;
+        }
+        if (info.manaCost > 0) {
+            // Rage and runic power are stored x10 in the client, WowUnit::GetPowerByType reports them /10
+            bool scaled = info.powerType == PowerType::POWER_TYPE_RAGE || info.powerType == PowerType::POWER_TYPE_RUNIC_POWER;
+            step.manaCost = static_cast<int>(scaled ? info.manaCost / 10 : info.manaCost);
+            switch (info.powerType) {
+                case PowerType::POWER_TYPE_MANA: step.resourceType = "Mana"; break;
+                case PowerType::POWER_TYPE_RAGE: step.resourceType = "Rage"; break;
+                case PowerType::POWER_TYPE_FOCUS: step.resourceType = "Focus"; break;
+                case PowerType::POWER_TYPE_ENERGY: step.resourceType = "Energy"; break;
+                case PowerType::POWER_TYPE_RUNIC_POWER: step.resourceType = "RunicPower"; break;
+                default: break;
+            }
+        }
+        ++updated;
+    }
+    return updated;
+}
+
+size_t SpellInfoCache::Size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_table.size();
+}
+
+bool SpellInfoCache::HasDbcSource() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dbc.IsMapped();
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include "spelldbc.h"
+
+namespace Rotation { struct RotationProfile; }
+
+namespace Spells {
+
+/**
+ * Spell metadata table for the spells referenced by rotation profiles.
+ * Sources, in order of preference:
+ *   1. Spell.dbc (+ SpellCastTimes.dbc, SpellRange.dbc) memory-mapped from an extracted DBFilesClient folder
+ *   2. The client's in-memory spell DB (row read through ClientDb_GetLocalizedRow - main thread only)
+ * Each spell is resolved once; lookups are a binary search over a sorted vector.
+ */
+class SpellInfoCache {
+public:
+    static SpellInfoCache& GetInstance();
+
+    /**
+     * Map Spell.dbc, SpellCastTimes.dbc and SpellRange.dbc from a directory
+     * @param directory Folder containing the extracted .dbc files
+     * @return true if Spell.dbc was mapped and looks valid
+     */
+    bool LoadDbcDirectory(const std::string& directory);
+
+    /**
+     * Resolve metadata for the given spells (already known ids are skipped).
+     * Without a mapped Spell.dbc the client DB is used, which must happen on the main thread.
+     * @param spellIds Spells to resolve
+     * @return Number of newly resolved spells
+     */
+    size_t Resolve(const std::vector<uint32_t>& spellIds);
+
+    /**
+     * Look up a resolved spell
+     * @param spellId The ID of the spell
+     * @param out Receives the metadata
+     * @return false if the spell was never resolved or does not exist
+     */
+    bool Get(uint32_t spellId, SpellInfo& out) const;
+
+    /**
+     * Resolve every step spell of a profile and overwrite the hand-entered step fields
+     * (cast time, channel, move-castable, cost, ranges) with the client data where it is known.
+     * @param profile Profile to update in place
+     * @param resolve Resolve unknown spells first (see Resolve); false only applies spells already resolved
+     * @return Number of steps that were updated
+     */
+    size_t ApplyToProfile(Rotation::RotationProfile& profile, bool resolve = true);
+
+    /**
+     * @return Number of resolved spells
+     */
+    size_t Size() const;
+
+    /**
+     * @return true if Spell.dbc is mapped (otherwise the client DB is used)
+     */
+    bool HasDbcSource() const;
+
+private:
+    SpellInfoCache() = default;
+
+    bool ReadFromClient(uint32_t spellId, SpellInfo& info) const;
+
+    mutable std::mutex m_mutex;
+    std::vector<SpellInfo> m_table; // Sorted by id
+    SpellDbc m_dbc;                 // Record decoding; Spell.dbc mapping if one was loaded
+};
+
+}
@@ -1,4 +1,11 @@
 #include "targeting.h"
+#include "loscache.h"
+#include "lostrace.h"
+#include "losscheduler.h"
+#include "targetscorer.h"
+#include "namematcher.h"
+#include "healtriage.h"
+#include "motiontracker.h"
 #include "../logs/log.h"
 #include "../utils/memory.h" // For direct memory access
 #include "../types/wowunit.h"
@@ -147,8 +154,8 @@ void InitializeWorldIntersect() {
     initialized = true;
 }
 
-// Implementation of IsInLineOfSight function
-bool IsInLineOfSight(const Vector3& startPos, const Vector3& endPos, bool forceLog) {
+// Line of sight check through the world traces (uncached, see IsInLineOfSight and LosTraceStrategy)
+static bool TraceLineOfSight(const Vector3& startPos, const Vector3& endPos, LosPolicy policy, bool forceLog) {
     // GUI::LOSTab* losTab = GUI::GetLOSTab(); // REMOVED
     uint64_t currentDebugGuid = 0ULL;
     bool isDebugTargetCurrentlySetByTab = false;
@@ -193,163 +200,87 @@ bool IsInLineOfSight(const Vector3& startPos, const Vector3& endPos, bool forceL
     float horizontal_distance = std::sqrtf(
         std::powf(endPos.x - startPos.x, 2) + 
         std::powf(endPos.y - startPos.y, 2));
-        
-    Vector3 start = startPos;
-    Vector3 end = endPos;
-    
-    // Use multiple different trace approaches and combine results
-    
-    // APPROACH 1: Trace with different height offsets
-    const int NUM_HEIGHT_OFFSETS = 5;
-    float offsets[NUM_HEIGHT_OFFSETS] = {0.0f, 0.5f, 1.0f, 1.5f, 2.0f};
+
+    // Fire traces in the strategy's order until the verdict can no longer change
+    LosTraceStrategy& strategy = LosTraceStrategy::GetInstance();
+    const LosTraceStrategy::Order order = strategy.GetOrder();
+    const int budget = strategy.GetBudget(policy);
+    const int required = LosTraceStrategy::RequiredClear(budget, horizontal_distance);
+    const bool earlyExit = strategy.IsEarlyExitEnabled();
+
+    int8_t results[LosTraceStrategy::TRACE_COUNT];
+    std::fill(std::begin(results), std::end(results), static_cast<int8_t>(LosTraceStrategy::TRACE_NOT_RUN));
     int successful_traces = 0;
     int total_traces = 0;
-    
-    for (int i = 0; i < NUM_HEIGHT_OFFSETS; i++) {
-        Vector3 adjusted_start = start;
-        Vector3 adjusted_end = end;
-        
-        // Apply height offset
-        adjusted_start.z += offsets[i];
-        adjusted_end.z += offsets[i];
-        
-        // Use both tracing flags for each height
-        IntersectFlags flags_to_try[2] = {GameGenericLOS, GameObservedPlayerLOS};
-        
-        for (int j = 0; j < 2; j++) {
-            float hitFraction = 1.0f;
-            int param_a6 = 0;
-            int param_a7 = 0;
-            int result = 0;
-            
-            try {
-                total_traces++;
-                result = WorldIntersect(worldframe, &adjusted_start, &adjusted_end, &hitFraction, 
-                                  flags_to_try[j], param_a6, param_a7);
-                
-                // Count trace as successful if:
-                // 1. Result is 0 (clear path), OR
-                // 2. HitFraction is 1.0 or very close to it (reached destination)
-                if (result == 0 || hitFraction >= 0.99f) {
-                    successful_traces++;
-                    
-                    if (shouldLogDetails) {
-                        std::stringstream trace_log;
-                        trace_log << "[LOS_TRACE] Height offset " << offsets[i]
-                                 << " with flags 0x" << std::hex << flags_to_try[j] << std::dec
-                                 << " result: " << result << ", fraction: " << hitFraction
-                                 << " - SUCCESS";
-                        Core::Log::Message(trace_log.str());
-                    }
-                }
-                else if (shouldLogDetails) {
-                    std::stringstream trace_log;
-                    trace_log << "[LOS_TRACE] Height offset " << offsets[i]
-                             << " with flags 0x" << std::hex << flags_to_try[j] << std::dec
-                             << " result: " << result << ", fraction: " << hitFraction
-                             << " - FAILED";
-                    Core::Log::Message(trace_log.str());
-                }
-            }
-            catch (...) {
-                if (shouldLogDetails) {
-                    Core::Log::Message("[LOS_DEBUG] ERROR: Exception in trace");
-                }
-                // Continue with other traces
-            }
-        }
-    }
-    
-    // APPROACH 2: Multi-point ray test - check points along the ray
-    bool midpoint_check_success = true;
-    const int NUM_MIDPOINTS = 5;
-    
-    for (int i = 1; i < NUM_MIDPOINTS; i++) {
-        float fraction = static_cast<float>(i) / NUM_MIDPOINTS;
-        Vector3 midPoint;
-        midPoint.x = start.x + (end.x - start.x) * fraction;
-        midPoint.y = start.y + (end.y - start.y) * fraction;
-        midPoint.z = start.z + (end.z - start.z) * fraction;
-        
-        float midPointFraction = 1.0f;
-        int midPointResult = 0;
+
+    for (int k = 0; k < budget; k++) {
+        const int slot = order[k];
+        const LosTraceStrategy::Trace& trace = LosTraceStrategy::GetTrace(slot);
+
+        Vector3 adjusted_start = startPos;
+        Vector3 adjusted_end;
+        adjusted_end.x = startPos.x + (endPos.x - startPos.x) * trace.fraction;
+        adjusted_end.y = startPos.y + (endPos.y - startPos.y) * trace.fraction;
+        adjusted_end.z = startPos.z + (endPos.z - startPos.z) * trace.fraction;
+        adjusted_start.z += trace.heightOffset;
+        adjusted_end.z += trace.heightOffset;
+
+        float hitFraction = 1.0f;
         int param_a6 = 0;
         int param_a7 = 0;
-        
+        int result = 0;
+        bool clear = false;
+
         try {
             total_traces++;
-            midPointResult = WorldIntersect(worldframe, &start, &midPoint, &midPointFraction, 
-                                     GameGenericLOS, param_a6, param_a7);
-            
-            // Count segment as successful if it reached close to destination
-            if (midPointResult == 0 || midPointFraction >= 0.99f) {
-                successful_traces++;
-                
-                if (shouldLogDetails && (i == NUM_MIDPOINTS-1 || i == 1)) {
-                    std::stringstream trace_log;
-                    trace_log << "[LOS_TRACE] Midpoint " << i << "/" << NUM_MIDPOINTS
-                             << " result: " << midPointResult << ", fraction: " << midPointFraction
-                             << " - SUCCESS";
-                    Core::Log::Message(trace_log.str());
-                }
-            }
-            else {
-                midpoint_check_success = false;
-                
-                if (shouldLogDetails) {
-                    std::stringstream trace_log;
-                    trace_log << "[LOS_TRACE] Midpoint " << i << "/" << NUM_MIDPOINTS
-                             << " result: " << midPointResult << ", fraction: " << midPointFraction
-                             << " - FAILED";
-                    Core::Log::Message(trace_log.str());
-                }
-            }
+            result = WorldIntersect(worldframe, &adjusted_start, &adjusted_end, &hitFraction,
+                                    static_cast<IntersectFlags>(trace.flags), param_a6, param_a7);
+            // Count trace as successful if:
+            // 1. Result is 0 (clear path), OR
+            // 2. HitFraction is 1.0 or very close to it (reached destination)
+            clear = (result == 0 || hitFraction >= 0.99f);
         }
         catch (...) {
             if (shouldLogDetails) {
-                Core::Log::Message("[LOS_DEBUG] ERROR: Exception in midpoint trace");
+                Core::Log::Message("[LOS_DEBUG] ERROR: Exception in trace");
             }
-            midpoint_check_success = false;
+            // Continue with other traces
         }
-    }
-    
-    // DECISION MAKING BASED ON COMBINED TRACE RESULTS
-    
-    // Calculate success ratio of all traces
-    float success_ratio = static_cast<float>(successful_traces) / total_traces;
-    
-    bool has_los = false;
-    
-    // For closer targets (under 20 yards), be more lenient
-    if (horizontal_distance < 20.0f) {
-        // Require 70% success rate for close targets
-        has_los = (success_ratio >= 0.7f);
-        
+
+        results[slot] = clear ? LosTraceStrategy::TRACE_CLEAR : LosTraceStrategy::TRACE_BLOCKED;
+        if (clear) successful_traces++;
+
         if (shouldLogDetails) {
-            std::stringstream decision_log;
-            decision_log << "[LOS_DECISION] Close-range target (<20yd): " 
-                       << successful_traces << "/" << total_traces << " traces successful ("
-                       << (success_ratio * 100.0f) << "%). Decision: "
-                       << (has_los ? "VISIBLE" : "BLOCKED");
-            Core::Log::Message(decision_log.str());
+            std::stringstream trace_log;
+            trace_log << "[LOS_TRACE] Slot " << slot << " height offset " << trace.heightOffset
+                      << " fraction " << trace.fraction
+                      << " with flags 0x" << std::hex << trace.flags << std::dec
+                      << " result: " << result << ", fraction: " << hitFraction
+                      << (clear ? " - SUCCESS" : " - FAILED");
+            Core::Log::Message(trace_log.str());
         }
-    }
-    // For distant targets (over 20 yards), be more strict
-    else {
-        // Require 80% success rate for distant targets
-        has_los = (success_ratio >= 0.8f);
-        
-        if (shouldLogDetails) {
-            std::stringstream decision_log;
-            decision_log << "[LOS_DECISION] Long-range target: " 
-                       << successful_traces << "/" << total_traces << " traces successful ("
-                       << (success_ratio * 100.0f) << "%). Decision: "
-                       << (has_los ? "VISIBLE" : "BLOCKED");
-            Core::Log::Message(decision_log.str());
+
+        if (earlyExit) {
+            int failed_traces = total_traces - successful_traces;
+            if (successful_traces >= required || failed_traces > budget - required) break;
         }
     }
-    
+
+    LosCache::GetInstance().AddWorldTraces(static_cast<uint32_t>(total_traces));
+
+    // DECISION MAKING BASED ON COMBINED TRACE RESULTS
+    bool has_los = successful_traces >= required;
+    strategy.Record(policy, results, total_traces, has_los);
+
     if (shouldLogDetails) {
+        std::stringstream decision_log;
+        decision_log << "[LOS_DECISION] " << (policy == LosPolicy::Fast ? "Fast" : "Full") << " policy, "
+                     << (horizontal_distance < 20.0f ? "close-range target (<20yd): " : "long-range target: ")
+                     << successful_traces << "/" << total_traces << " traces successful, "
+                     << required << "/" << budget << " required. Decision: "
+                     << (has_los ? "VISIBLE" : "BLOCKED");
+        Core::Log::Message(decision_log.str());
+
         std::stringstream ss;
         ss << "[LOS_DEBUG] Final LOS status: " 
            << (has_los ? "VISIBLE" : "BLOCKED")
@@ -360,6 +291,53 @@ bool IsInLineOfSight(const Vector3& startPos, const Vector3& endPos, bool forceL
     return has_los;
 }
 
+// Implementation of IsInLineOfSight function
+bool IsInLineOfSight(const Vector3& startPos, const Vector3& endPos, bool forceLog) {
+    // Logged checks are for debugging the traces themselves, always run them
+    if (forceLog) return TraceLineOfSight(startPos, endPos, LosPolicy::Full, true);
+    return IsInLineOfSight(0, 0, startPos, endPos);
+}
+
+bool IsInLineOfSight(uint64_t casterGuid, uint64_t targetGuid, const Vector3& startPos, const Vector3& endPos, LosPolicy policy) {
+    LosCache& cache = LosCache::GetInstance();
+    bool hasLos = false;
+    if (cache.Lookup(casterGuid, targetGuid, startPos, endPos, policy, hasLos)) {
+        return hasLos;
+    }
+    return TraceAndCacheLineOfSight(casterGuid, targetGuid, startPos, endPos, policy);
+}
+
+bool TraceAndCacheLineOfSight(uint64_t casterGuid, uint64_t targetGuid, const Vector3& startPos, const Vector3& endPos, LosPolicy policy) {
+    // No world frame (loading screen): report blocked without caching it
+    if (!GetWorldFrame()) return false;
+    bool hasLos = TraceLineOfSight(startPos, endPos, policy, false);
+    LosCache::GetInstance().Store(casterGuid, targetGuid, startPos, endPos, policy, hasLos);
+    return hasLos;
+}
+
+bool HasLineOfSight(WowUnit* unit1, WowUnit* unit2, LosPolicy policy, int leadMs) {
+    if (!unit1 || !unit2) return false;
+    if (unit1->GetGUID64() == unit2->GetGUID64()) return true;
+    MotionTracker& motion = MotionTracker::GetInstance();
+    Vector3 start = motion.PredictPosition(unit1, leadMs);
+    Vector3 end = motion.PredictPosition(unit2, leadMs);
+    if (start.IsZero() || end.IsZero()) return false;
+    return IsInLineOfSight(unit1->GetGUID64(), unit2->GetGUID64(), start, end, policy);
+}
+
+bool HasLineOfSightDeferred(WowUnit* unit1, WowUnit* unit2, LosPolicy policy, bool unknownResult) {
+    if (!unit1 || !unit2) return false;
+    if (unit1->GetGUID64() == unit2->GetGUID64()) return true;
+    Vector3 start = unit1->GetPosition();
+    Vector3 end = unit2->GetPosition();
+    if (start.IsZero() || end.IsZero()) return false;
+    bool hasLos = false;
+    if (!LosScheduler::GetInstance().Query(unit1->GetGUID64(), unit2->GetGUID64(), start, end, policy, hasLos)) {
+        return unknownResult;
+    }
+    return hasLos;
+}
+
 void TargetUnit(uint64_t targetGuid) {
     // Remove regular targeting logs to reduce log spam
     // Only log with drastically reduced frequency
@@ -434,8 +412,33 @@ TargetingManager::TargetingManager(ObjectManager& objMgr) : objectManager(objMgr
         "unholy champion",
         "putrid thrall",
         "kerg pebblecutter"
-        // "totem", "whelp", "dragon" will be handled by substring check below
     };
+    // Generic terms, blacklisted anywhere in the name
+    unitSubstringBlacklist = {
+        "totem",
+        "whelp",
+        "dragon"
+    };
+    nameMatcher.Compile(unitNameBlacklist, unitSubstringBlacklist, "");
+
+    // Reaction and blacklist bits are computed once per object update, on the main thread
+    objectManager.SetUnitClassifier([this](WowPlayer& player, WowUnit& unit) { return ClassifyRelation(player, unit); });
+}
+
+TargetingManager::~TargetingManager() {
+    objectManager.SetUnitClassifier(nullptr);
+}
+
+uint16_t TargetingManager::ClassifyRelation(WowPlayer& player, WowUnit& unit) {
+    uint16_t mask = 0;
+    if (IsUnitBlacklisted(&unit)) mask |= UNIT_CLASS_BLACKLISTED;
+    if (IsUnitFriendly(&player, &unit)) mask |= UNIT_CLASS_FRIENDLY;
+    if (unit.GetGUID64() != player.GetGUID64()) {
+        if (IsUnitAttackable(&player, &unit)) mask |= UNIT_CLASS_ATTACKABLE;
+        int reaction = GetCachedReaction(&player, &unit);
+        if (reaction >= 1 && reaction <= 2) mask |= UNIT_CLASS_HOSTILE;
+    }
+    return mask;
 }
 
 bool TargetingManager::IsUnitAttackable(WowUnit* playerUnit, WowUnit* targetUnit) {
@@ -536,38 +539,88 @@ int TargetingManager::GetCachedReaction(WowUnit* player, WowUnit* target) {
         return -1; // Invalid input
     }
     
-    uint64_t targetGuid = target->GetGUID64();
-    auto now = std::chrono::steady_clock::now();
-    
+    uint32_t playerFaction = player->GetFactionId();
+    uint32_t targetFaction = target->GetFactionId();
+    if (playerFaction == 0 || targetFaction == 0) {
+        return player->GetReaction(target); // Descriptor not read yet, nothing to key on
+    }
+
+    // Faction template IDs fit in 24 bits (FactionTemplate.dbc); the low bits hold the PvP flags,
+    // which change the reaction between player-controlled units of otherwise neutral factions
+    uint64_t pvpBits = ((player->GetUnitFlags() & WowUnit::UNIT_FLAG_PVP) ? 1u : 0u) |
+                       ((target->GetUnitFlags() & WowUnit::UNIT_FLAG_PVP) ? 2u : 0u);
+    uint64_t key = (static_cast<uint64_t>(playerFaction & 0xFFFFFF) << 40) |
+                   (static_cast<uint64_t>(targetFaction & 0xFFFFFF) << 16) | pvpBits;
+
     std::lock_guard<std::mutex> lock(cacheMutex);
-    
-    // Try to find in cache first
-    auto it = std::find_if(reactionCache.begin(), reactionCache.end(),
-        [targetGuid](const ReactionCacheEntry& entry) {
-            return entry.targetGuid == targetGuid;
-        }
-    );
-    
-    // If found in cache, return the cached reaction
-    if (it != reactionCache.end()) {
-        return it->reaction;
+
+    // A new faction template for the player (e.g. mind control, faction change) invalidates every pair
+    if (playerFaction != reactionPlayerFaction) {
+        if (!reactionMatrix.empty()) reactionStats.invalidations++;
+        reactionMatrix.clear();
+        reactionPlayerFaction = playerFaction;
     }
-    
-    // Not in cache, get and cache the reaction
+
+    auto it = reactionMatrix.find(key);
+    if (it != reactionMatrix.end()) {
+        reactionStats.hits++;
+        return it->second;
+    }
+
+    // First unit of this faction pair: ask the client once
     int reaction = player->GetReaction(target);
-    
-    // Add to cache if we have space
-    if (reactionCache.size() < static_cast<size_t>(MAX_CACHE_SIZE)) {
-        ReactionCacheEntry entry;
-        entry.targetGuid = targetGuid;
-        entry.reaction = reaction;
-        entry.timestamp = now;
-        reactionCache.push_back(entry);
+    reactionStats.misses++;
+    if (reaction > 0) { // 0 = client call failed, try again next time
+        reactionMatrix.emplace(key, reaction);
     }
-    
     return reaction;
 }
 
+std::shared_ptr<WowUnit> TargetingManager::FindScoredTarget(WowPlayer* player, bool hostile, const TargetWeights& weights,
+                                                           bool useLosCheck, size_t k, const TargetScorer::Filter& filter) {
+    if (!player) return nullptr;
+
+    // Only the top K reach here; answered from the LOS cache/scheduler, never traced on this thread.
+    // Candidates are filtered with the Fast check; the one that passes (the pick) also needs the Full
+    // answer, which stands in for the Fast one once known.
+    TargetScorer::Validator hasLos;
+    if (useLosCheck) {
+        hasLos = [player](WowUnit& unit) {
+            return HasLineOfSightDeferred(player, &unit, LosPolicy::Fast, false) &&
+                   HasLineOfSightDeferred(player, &unit, LosPolicy::Full, true);
+        };
+    }
+
+    // Candidates straight from the classified unit table (enemies: NPCs only, as before)
+    auto table = objectManager.GetUnitTable();
+    if (table->hasRelations) {
+        uint16_t require = hostile ? UNIT_CLASS_ATTACKABLE : UNIT_CLASS_FRIENDLY;
+        uint16_t exclude = UNIT_CLASS_DEAD | UNIT_CLASS_BLACKLISTED;
+        if (hostile) exclude |= UNIT_CLASS_PLAYER | UNIT_CLASS_SELF;
+        std::vector<std::shared_ptr<WowObject>> candidates;
+        table->SelectUnits(require, exclude, candidates);
+        return scorer.SelectBest(*player, candidates, weights, filter, hasLos, k);
+    }
+
+    // No table yet (first update after entering the world)
+    uint64_t playerGuid = player->GetGUID64();
+    auto isCandidate = [&](WowUnit& unit) {
+        if (unit.IsDead() || IsUnitBlacklisted(&unit)) return false;
+        if (filter && !filter(unit)) return false;
+        if (hostile) return unit.GetGUID64() != playerGuid && !unit.IsPlayer() && IsUnitAttackable(player, &unit);
+        return IsUnitFriendly(player, &unit);
+    };
+    auto units = objectManager.GetObjectsByType(WowObjectType::OBJECT_UNIT);
+    return scorer.SelectBest(*player, units, weights, isCandidate, hasLos, k);
+}
+
+ReactionMatrixStats TargetingManager::GetReactionStats() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    ReactionMatrixStats stats = reactionStats;
+    stats.pairs = reactionMatrix.size();
+    return stats;
+}
+
 bool TargetingManager::ShouldHealTarget(WowUnit* target, float healthThreshold) {
     if (!target || target->IsDead()) {
         return false;
@@ -633,33 +686,13 @@ bool TargetingManager::FindHealingTargetForConditions(const std::vector<Rotation
         }
     }
     
-    // Look for other units that need healing
-    uint64_t lowestHealthGuid = 0;
-    float lowestHealth = 101.0f;
-    
-    auto units = objectManager.GetObjectsByType(WowObjectType::OBJECT_UNIT);
-    for (const auto& objPtr : units) {
-        auto unit = std::dynamic_pointer_cast<WowUnit>(objPtr);
-        if (!unit || unit->GetGUID64() == player->GetGUID64() || 
-            !IsUnitFriendly(playerUnit, unit.get()) || unit->IsDead()) {
-            continue;
-        }
-        
-        int maxHealth = unit->GetMaxHealth();
-        float healthPercent = (maxHealth > 0) ? 
-            (static_cast<float>(unit->GetHealth()) / maxHealth * 100.0f) : 0.0f;
-        
-        if (healthPercent < lowestHealthThreshold && healthPercent < lowestHealth) {
-            lowestHealth = healthPercent;
-            lowestHealthGuid = unit->GetGUID64();
-        }
-    }
-    
-    if (lowestHealthGuid != 0) {
-        outTargetGuid = lowestHealthGuid;
+    // Look for other units that need healing (lowest effective health first)
+    std::vector<HealCandidate> lowest;
+    if (FindLowestHealTargets(1, lowestHealthThreshold, 0.0f, lowest) > 0) {
+        outTargetGuid = lowest.front().guid;
         if (shouldLog) {
             Core::Log::Message("[Targeting] Found unit needing healing, health: " + 
-                              std::to_string(lowestHealth) + "%");
+                              std::to_string(lowest.front().healthPercent) + "%");
         }
         return true;
     }
@@ -667,6 +700,34 @@ bool TargetingManager::FindHealingTargetForConditions(const std::vector<Rotation
     return false;
 }
 
+size_t TargetingManager::FindLowestHealTargets(size_t count, float healthPercentBelow, float maxRange,
+                                               std::vector<HealCandidate>& outCandidates) {
+    outCandidates.clear();
+    std::shared_ptr<WowPlayer> player = objectManager.GetLocalPlayer();
+    if (!player) {
+        return 0;
+    }
+
+    // Units are re-sorted only when their health changed; without the unit table, reaction is checked every refresh
+    if (healTriage.IsStale(HEAL_TRIAGE_REFRESH_INTERVAL)) {
+        auto table = objectManager.GetUnitTable();
+        if (table->hasRelations) {
+            std::vector<std::shared_ptr<WowObject>> friendly;
+            table->SelectUnits(UNIT_CLASS_FRIENDLY, 0, friendly);
+            healTriage.Refresh(friendly, player->GetPosition(), HealTriage::Filter());
+        } else {
+            auto units = objectManager.GetObjectsByType(WowObjectType::OBJECT_UNIT);
+            auto players = objectManager.GetObjectsByType(WowObjectType::OBJECT_PLAYER);
+            units.insert(units.end(), players.begin(), players.end());
+            WowUnit* playerUnit = player.get();
+            healTriage.Refresh(units, player->GetPosition(),
+                               [this, playerUnit](WowUnit& unit) { return IsUnitFriendly(playerUnit, &unit); });
+        }
+    }
+
+    return healTriage.Lowest(count, healthPercentBelow / 100.0f, maxRange, player->GetGUID64(), outCandidates);
+}
+
 // Find best target based on target type
 uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr, 
                                           Rotation::TargetType targetType,
@@ -699,6 +760,8 @@ uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr,
             case Rotation::TargetType::SELF_OR_FRIENDLY: entry_log_ss << "SELF_OR_FRIENDLY"; break;
             case Rotation::TargetType::ANY: entry_log_ss << "ANY"; break;
             case Rotation::TargetType::NONE: entry_log_ss << "NONE"; break;
+            case Rotation::TargetType::ENEMY_CLUSTER: entry_log_ss << "ENEMY_CLUSTER"; break;
+            case Rotation::TargetType::GROUND_CLUSTER: entry_log_ss << "GROUND_CLUSTER"; break;
             default: entry_log_ss << "UNKNOWN"; break;
         }
         if (isDebugModeActiveViaTab) {
@@ -712,10 +775,21 @@ uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr,
     // Handle types that don't need unit iteration first
     switch (targetType) {
         case Rotation::TargetType::ENEMY:
+        case Rotation::TargetType::ENEMY_CLUSTER: // Clusters are resolved from snapshots (ClusterIndex); plain enemy pick here
             {
                 if (player) {
                     bool onlyCombat = engine_ptr ? engine_ptr->IsOnlyTargetingCombatUnits() : true;
-                    std::shared_ptr<WowUnit> foundUnit = Rotation::FindBestEnemyTarget(player.get(), objectManager, *this, onlyCombat, isTankingMode);
+                    // Scored pick (tanking: units not on us first); the old finder covers frames without LOS answers yet
+                    TargetWeights weights = TargetWeights::Enemy();
+                    if (isTankingMode) weights.targetingMe = -weights.targetingMe;
+                    TargetScorer::Filter inCombat;
+                    if (onlyCombat) inCombat = [](WowUnit& unit) { return unit.IsInCombat(); };
+                    std::shared_ptr<WowUnit> foundUnit = FindScoredTarget(player.get(), true, weights, true, TargetScorer::DEFAULT_K, inCombat);
+                    if (foundUnit) {
+                        if (shouldLogThisEntry) Core::Log::Message("[TargetingManager::FindBestTarget] ENEMY type: Found unit " + foundUnit->GetName() + " via FindScoredTarget. Returning its GUID.");
+                        return foundUnit->GetGUID64();
+                    }
+                    foundUnit = Rotation::FindBestEnemyTarget(player.get(), objectManager, *this, onlyCombat, isTankingMode);
                     if (foundUnit) {
                         if (shouldLogThisEntry) Core::Log::Message("[TargetingManager::FindBestTarget] ENEMY type: Found unit " + foundUnit->GetName() + " via Rotation::FindBestEnemyTarget. Returning its GUID.");
                         return foundUnit->GetGUID64();
@@ -731,7 +805,18 @@ uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr,
             {
                 if (player) {
                     bool includeSelf = (targetType == Rotation::TargetType::SELF_OR_FRIENDLY);
-                    std::shared_ptr<WowUnit> foundUnit = Rotation::FindBestFriendlyTarget(player, objectManager, *this, includeSelf);
+                    TargetScorer::Filter notSelf;
+                    if (!includeSelf) {
+                        uint64_t playerGuid = player->GetGUID64();
+                        notSelf = [playerGuid](WowUnit& unit) { return unit.GetGUID64() != playerGuid; };
+                    }
+                    std::shared_ptr<WowUnit> foundUnit = FindScoredTarget(player.get(), false, TargetWeights::Friendly(), true,
+                                                                          TargetScorer::DEFAULT_K, notSelf);
+                    if (foundUnit) {
+                        if (shouldLogThisEntry) Core::Log::Message("[TargetingManager::FindBestTarget] FRIENDLY/SELF_OR_FRIENDLY type: Found unit " + foundUnit->GetName() + " via FindScoredTarget. Returning its GUID.");
+                        return foundUnit->GetGUID64();
+                    }
+                    foundUnit = Rotation::FindBestFriendlyTarget(player, objectManager, *this, includeSelf);
                     if (foundUnit) {
                         if (shouldLogThisEntry) Core::Log::Message("[TargetingManager::FindBestTarget] FRIENDLY/SELF_OR_FRIENDLY type: Found unit " + foundUnit->GetName() + " via Rotation::FindBestFriendlyTarget. Returning its GUID.");
                         return foundUnit->GetGUID64();
@@ -749,6 +834,7 @@ uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr,
             if (shouldLogThisEntry) Core::Log::Message("[TargetingManager::FindBestTarget] SELF type: Player is null, returning 0.");
             return 0;
         case Rotation::TargetType::NONE:
+        case Rotation::TargetType::GROUND_CLUSTER: // Ground position comes with the decision, no unit
             if (shouldLogThisEntry) Core::Log::Message("[TargetingManager::FindBestTarget] NONE type: Returning 0.");
             return 0;
         case Rotation::TargetType::ANY:
@@ -770,93 +856,78 @@ uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr,
         return 0;
     }
 
-    uint64_t bestOverallGuid = 0;
-    float closestOverallDistance = 1000.0f;
-    Vector3 playerPos = player->GetPosition(); // Use player's base position for distance
     int validCount = 0;
     int rejectedCount = 0;
 
-    auto units = objectManager.GetObjectsByType(WowObjectType::OBJECT_UNIT);
+    // Recompiles only when the filter text changed
+    nameMatcher.SetFilter(useNameFilter ? nameFilter : std::string());
 
-    for (const auto& objPtr : units) {
-        auto unit = std::dynamic_pointer_cast<WowUnit>(objPtr);
-        if (!unit || unit->GetGUID64() == player->GetGUID64() || unit->IsDead()) {
+    // Friendly, alive, not self and not blacklisted come from the unit table's masks; the name filter and
+    // the healing flags are the only per-unit checks left. The nearest friendly unit within 40 yards wins.
+    auto table = objectManager.GetUnitTable();
+    bool useMasks = table->hasRelations;
+    bool filterActive = useNameFilter && !nameFilter.empty();
+
+    auto isCandidate = [&](WowUnit& unit) {
+        if (!useMasks && (unit.GetGUID64() == player->GetGUID64() || unit.IsDead())) {
             rejectedCount++;
-            continue;
+            return false;
         }
 
-        std::string unitName = unit->GetName();
-        std::string unitNameLower = unitName;
-        std::transform(unitNameLower.begin(), unitNameLower.end(), unitNameLower.begin(),
-                       [](unsigned char c){ return std::tolower(c); });
+        if (!useMasks || filterActive) {
+            uint8_t nameMatch = nameMatcher.Classify(&unit);
+            if (!useMasks && (nameMatch & NameMatcher::MATCH_BLACKLIST)) {
+                if (shouldLogThisEntry) Core::Log::Message("[Targeting] Skipping blacklisted unit: " + unit.GetName());
+                rejectedCount++;
+                return false;
+            }
 
-        if (IsUnitBlacklisted(unit.get())) {
-            if (shouldLogThisEntry) Core::Log::Message("[Targeting] Skipping blacklisted unit: " + unitName);
-            rejectedCount++;
-            continue;
-        }
-        
-        if (useNameFilter && !nameFilter.empty()) {
-            std::string filterLower = nameFilter;
-            std::transform(filterLower.begin(), filterLower.end(), filterLower.begin(),
-                           [](unsigned char c){ return std::tolower(c); });
-            if (unitNameLower.find(filterLower) == std::string::npos) {
-                if (shouldLogThisEntry) Core::Log::Message("[Targeting] Skipping unit '" + unitName + "': Filter '" + nameFilter + "' not found.");
+            if (!(nameMatch & NameMatcher::MATCH_FILTER)) {
+                if (shouldLogThisEntry) Core::Log::Message("[Targeting] Skipping unit '" + unit.GetName() + "': Filter '" + nameFilter + "' not found.");
                 rejectedCount++;
-                continue; 
+                return false;
             }
         }
 
-        // Consider units that are friendly
-        if (player && IsUnitFriendly(player.get(), unit.get())) {
-            // Core::Log::Message("[FBT] Unit " + unit->GetName() + " is friendly.");
-
-            // +++ NEW HEALING BLACKLIST LOGIC +++
-            if (isHealingSpellContext) {
-                uint32_t unitFlags = unit->GetUnitFlags(); // Use existing GetUnitFlags()
-                std::string unitName = unit->GetName();
-                bool isFlagBlacklisted = (unitFlags & 0x8808) == 0x8808;
-                bool isNameException = (unitName == "DonaldTrump");
-
-                if (isFlagBlacklisted && !isNameException) {
-                    // Optional: Log why a unit is skipped for healing
-                    // Core::Log::Message("[FBT-Heal] Skipping blacklisted unit: " + unitName + " (Flags: 0x" + std::hex + unitFlags + std::dec + ")");
-                    continue; // Skip this unit for healing
-                }
-            }
-            // --- END HEALING BLACKLIST LOGIC ---
+        // Consider units that are friendly (no table yet)
+        if (!useMasks && !IsUnitFriendly(player.get(), &unit)) {
+            return false;
+        }
 
-            validCount++;
-            Vector3 targetPos = unit->GetPosition();
-            if (targetPos.IsZero()) { 
-                rejectedCount++; 
-                continue; 
-            }
-            
-            float distance = playerPos.Distance(targetPos);
-            if (distance > 40.0f) { // Max targeting range for ANY type
-                rejectedCount++; 
-                continue; 
-            }
+        // +++ NEW HEALING BLACKLIST LOGIC +++
+        if (isHealingSpellContext) {
+            uint32_t unitFlags = unit.GetUnitFlags(); // Use existing GetUnitFlags()
+            bool isFlagBlacklisted = (unitFlags & 0x8808) == 0x8808;
 
-            if (distance < closestOverallDistance) {
-                closestOverallDistance = distance;
-                bestOverallGuid = unit->GetGUID64();
+            if (isFlagBlacklisted && unit.GetName() != "DonaldTrump") { // Name only read for flagged units
+                return false; // Skip this unit for healing
             }
         }
+        // --- END HEALING BLACKLIST LOGIC ---
+
+        validCount++;
+        return true;
+    };
+
+    std::vector<std::shared_ptr<WowObject>> units;
+    if (useMasks) {
+        table->SelectUnits(UNIT_CLASS_FRIENDLY, UNIT_CLASS_DEAD | UNIT_CLASS_SELF | UNIT_CLASS_BLACKLISTED, units);
+    } else {
+        units = objectManager.GetObjectsByType(WowObjectType::OBJECT_UNIT);
     }
+    std::vector<ScoredTarget> scored;
+    scorer.SelectTopK(*player, units, TargetWeights::Nearest(), isCandidate, 1, scored);
+    uint64_t bestOverallGuid = scored.empty() ? 0 : scored.front().unit->GetGUID64();
+    float closestOverallDistance = scored.empty() ? 0.0f : scored.front().features.distance;
     
     if (shouldLogThisEntry) {
         if (bestOverallGuid != 0) {
-            std::shared_ptr<WowObject> targetObj = objectManager.GetObjectByGUID(bestOverallGuid);
-            if (auto targetUnit = std::dynamic_pointer_cast<WowUnit>(targetObj)) {
-                std::stringstream ss;
-                ss << "[Targeting] Selected target for ANY (No LOS): " << targetUnit->GetName() 
-                   << " (0x" << std::hex << bestOverallGuid << std::dec
-                   << ") at distance " << closestOverallDistance << "yd";
-                ss << " - Candidates: " << validCount << ", Rejected: " << rejectedCount;
-                Core::Log::Message(ss.str());
-            }
+            std::stringstream ss;
+            ss << "[Targeting] Selected target for ANY (No LOS): " << scored.front().unit->GetName() 
+               << " (0x" << std::hex << bestOverallGuid << std::dec
+               << ") at distance " << closestOverallDistance << "yd";
+            ss << " - Candidates: " << validCount << ", Rejected: " << rejectedCount;
+            Core::Log::Message(ss.str());
         } else {
             Core::Log::Message("[Targeting] No suitable ANY target found (No LOS). Candidates: " + std::to_string(validCount) + ", Rejected: " + std::to_string(rejectedCount));
         }
@@ -867,8 +938,10 @@ uint64_t TargetingManager::FindBestTarget(Rotation::RotationEngine* engine_ptr,
 
 void TargetingManager::ClearReactionCache() {
     std::lock_guard<std::mutex> lock(cacheMutex);
-    reactionCache.clear();
-    Core::Log::Message("[Targeting] Reaction cache cleared");
+    if (!reactionMatrix.empty()) reactionStats.invalidations++;
+    reactionMatrix.clear();
+    Core::Log::Message("[Targeting] Reaction matrix cleared");
+    healTriage.Clear(); // Tracked units were picked by reaction
 }
 
 // Definition for IntersectFlagsToString
@@ -906,39 +979,16 @@ bool TargetingManager::IsUnitBlacklisted(WowUnit* unit) const {
     if (!unit) {
         return false;
     }
-    std::string unitName = unit->GetName();
-    if (unitName.empty()) {
-        return false;
-    }
-    std::string unitNameLower = unitName;
-    std::transform(unitNameLower.begin(), unitNameLower.end(), unitNameLower.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
-
-    // Check for exact matches first
-    if (unitNameBlacklist.count(unitNameLower)) {
-        return true;
-    }
-
-    // Check for substring matches for generic terms
-    static const std::vector<std::string> substringBlacklist = {
-        "totem",
-        "whelp",
-        "dragon"
-    };
-
-    for (const auto& substring : substringBlacklist) {
-        if (unitNameLower.find(substring) != std::string::npos) {
-            return true;
-        }
-    }
-
-    return false;
+    // Exact names and substrings in one pass, memoized per creature entry
+    return (nameMatcher.Classify(unit) & NameMatcher::MATCH_BLACKLIST) != 0;
 }
 
 // --- Implementation of New BG Mode methods ---
 
 void TargetingManager::SetBGModeEnabled(bool enabled) {
-    m_bgModeEnabled.store(enabled);
+    if (m_bgModeEnabled.exchange(enabled) != enabled) {
+        ClearReactionCache();
+    }
     Core::Log::Message(std::string("[TargetingManager] BG Mode ") + (enabled ? "Enabled" : "Disabled"));
     if (!enabled) { // If disabling, reset faction to unknown so it's re-checked if re-enabled.
         std::lock_guard<std::mutex> lock(m_factionMutex);
@@ -967,13 +1017,15 @@ void TargetingManager::UpdateLocalPlayerFaction(WowPlayer* player) {
         determinedFaction = FactionInfo::PlayerFaction::HORDE;
     }
 
-    std::lock_guard<std::mutex> lock(m_factionMutex);
+    std::unique_lock<std::mutex> lock(m_factionMutex);
     if (m_localPlayerFaction != determinedFaction) {
         m_localPlayerFaction = determinedFaction;
         std::string factionStr = "UNKNOWN";
         if (m_localPlayerFaction == FactionInfo::PlayerFaction::ALLIANCE) factionStr = "ALLIANCE";
         else if (m_localPlayerFaction == FactionInfo::PlayerFaction::HORDE) factionStr = "HORDE";
         Core::Log::Message("[TargetingManager] Updated local player faction to: " + factionStr);
+        lock.unlock();
+        ClearReactionCache();
     }
 }
 
@@ -5,11 +5,16 @@
 #include <chrono>
 #include <vector>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include "../types/Rotation.h"
 #include "../objectManager/ObjectManager.h"
 #include "../types/types.h"
 #include "../types/FactionInfo.h"
+#include "lostrace.h"
+#include "targetscorer.h"
+#include "namematcher.h"
+#include "healtriage.h"
 #include <atomic>
 
 // Forward declarations
@@ -82,16 +87,18 @@ extern World_Intersect_t WorldIntersect;
 // External GUID pointer for current target
 extern uint64_t* CurrentTargetGUID_ptr;
 
-// Target reaction cache entry
-struct ReactionCacheEntry {
-    uint64_t targetGuid;
-    int reaction;
-    std::chrono::steady_clock::time_point timestamp;
+// Reaction matrix counters
+struct ReactionMatrixStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;          // Pairs read from the client (first sight of a faction pair)
+    uint64_t invalidations = 0;   // Matrix cleared (player faction template or BG mode changed)
+    size_t pairs = 0;
 };
 
 class TargetingManager {
 public:
     TargetingManager(ObjectManager& objMgr);
+    ~TargetingManager();
     
     // Target reaction functions
     bool IsUnitAttackable(WowUnit* playerUnit, WowUnit* targetUnit);
@@ -103,8 +110,14 @@ public:
     void UpdateLocalPlayerFaction(WowPlayer* player);
     FactionInfo::PlayerFaction GetLocalPlayerFaction() const;
     
-    // Get cached reaction (thread-safe)
+    /**
+     * Reaction of player to target from the faction-pair matrix (thread-safe).
+     * Reaction only depends on the two faction templates (and the PvP flags for player-controlled
+     * units), so every unit of a faction shares one entry, filled from WowUnit::GetReaction on first sight.
+     * @return 1=Hostile .. 4=Friendly .. 8=Exalted, or -1/0 if unknown
+     */
     int GetCachedReaction(WowUnit* player, WowUnit* target);
+    ReactionMatrixStats GetReactionStats() const;
     
     // Find best target based on target type (older version, potentially for specific GUID returns)
     uint64_t FindBestTarget(Rotation::RotationEngine* engine_ptr,
@@ -120,8 +133,20 @@ public:
     // Check if a target needs healing based on conditions
     bool FindHealingTargetForConditions(const std::vector<Rotation::Condition>& conditions, 
                                         uint64_t& outTargetGuid);
+
+    /**
+     * Friendly units (players and NPCs, not the local player) most in need of healing, from the heal triage heap
+     * @param count Max results
+     * @param healthPercentBelow Only units whose effective health is under this percentage
+     * @param maxRange Yards from the player, 0 = any
+     * @param outCandidates Results, lowest effective health first
+     * @return Number of results
+     */
+    size_t FindLowestHealTargets(size_t count, float healthPercentBelow, float maxRange,
+                                 std::vector<HealCandidate>& outCandidates);
+    HealTriage& GetHealTriage() { return healTriage; }
                                         
-    // Clear reaction cache
+    // Clear the reaction matrix
     void ClearReactionCache();
 
     // New function to find the best target based on type (enemy, friendly) and other criteria
@@ -136,17 +161,50 @@ public:
 
     bool IsUnitBlacklisted(WowUnit* unit) const;
 
+    /**
+     * Relation bits of a unit for the ObjectManager unit table (registered as its classifier)
+     * @return UNIT_CLASS_HOSTILE / FRIENDLY / ATTACKABLE / BLACKLISTED bits
+     */
+    uint16_t ClassifyRelation(WowPlayer& player, WowUnit& unit);
+    NameMatcher::Stats GetNameMatcherStats() const { return nameMatcher.GetStats(); }
+
+    /**
+     * Best unit by weighted score (see TargetScorer). Expensive checks only run on the top k.
+     * @param player Local player
+     * @param hostile Attackable NPCs if true, friendly units (including the player and other players) otherwise
+     * @param weights Feature weights, e.g. TargetWeights::Enemy() / TargetWeights::Friendly()
+     * @param useLosCheck Require line of sight (cached or last known answer, see LosScheduler): Fast for the
+     *        candidates, Full for the pick
+     * @param k Candidates kept for validation
+     * @param filter Optional extra cheap predicate (e.g. in combat only, not the player)
+     * @return Best valid unit, or nullptr
+     */
+    std::shared_ptr<WowUnit> FindScoredTarget(WowPlayer* player, bool hostile, const TargetWeights& weights,
+                                              bool useLosCheck, size_t k = TargetScorer::DEFAULT_K,
+                                              const TargetScorer::Filter& filter = TargetScorer::Filter());
+
+    TargetScorer& GetScorer() { return scorer; }
+
 private:
     ObjectManager& objectManager;
     
-    // Reaction cache
-    std::vector<ReactionCacheEntry> reactionCache;
-    const int MAX_CACHE_SIZE = 30;
-    const std::chrono::seconds CACHE_TTL{10};
-    std::mutex cacheMutex;
+    // Reaction matrix keyed by faction pair (see ReactionKey)
+    std::unordered_map<uint64_t, int> reactionMatrix;
+    uint32_t reactionPlayerFaction = 0; // Player faction template the matrix was filled for
+    ReactionMatrixStats reactionStats;
+    mutable std::mutex cacheMutex;
+
+    // Unit name blacklist (lowercase), compiled into nameMatcher together with the name filter
+    std::vector<std::string> unitNameBlacklist;
+    std::vector<std::string> unitSubstringBlacklist;
+    mutable NameMatcher nameMatcher;
 
-    // Unit name blacklist
-    std::unordered_set<std::string> unitNameBlacklist;
+    // Weighted candidate scoring (also keeps the health history for time to die)
+    TargetScorer scorer;
+
+    // Friendly units by effective health, re-synced with the object table at most this often
+    static constexpr std::chrono::milliseconds HEAL_TRIAGE_REFRESH_INTERVAL{ 100 };
+    HealTriage healTriage;
 
     // New BG Mode members
     std::atomic<bool> m_bgModeEnabled{false};
@@ -154,9 +212,22 @@ private:
     mutable std::mutex m_factionMutex; // To protect m_localPlayerFaction
 };
 
-// Check line of sight between two points
+// Check line of sight between two points (cached by LosCache unless forceLog)
 bool IsInLineOfSight(const Vector3& startPos, const Vector3& endPos, bool forceLog);
 
+/**
+ * Check line of sight between two units' positions, answered from LosCache while neither unit moved
+ * @param casterGuid GUID of the unit at startPos
+ * @param targetGuid GUID of the unit at endPos
+ * @param policy Fast for filtering candidates, Full for the target that will be cast on
+ * @return true if visible
+ */
+bool IsInLineOfSight(uint64_t casterGuid, uint64_t targetGuid, const Vector3& startPos, const Vector3& endPos,
+                     LosPolicy policy = LosPolicy::Full);
+
+// Trace now and store the result in LosCache, without looking it up first (used by LosScheduler)
+bool TraceAndCacheLineOfSight(uint64_t casterGuid, uint64_t targetGuid, const Vector3& startPos, const Vector3& endPos, LosPolicy policy);
+
 // Target a unit (set current target to GUID)
 void TargetUnit(uint64_t targetGuid);
 
@@ -166,7 +237,17 @@ void TargetUnit(uint64_t targetGuid);
 // Function to convert IntersectFlags to a string for logging
 std::string IntersectFlagsToString(IntersectFlags flags);
 
-// Check line of sight (LOS) between two units
-bool HasLineOfSight(WowUnit* unit1, WowUnit* unit2);
+/**
+ * Check line of sight (LOS) between two units
+ * @param leadMs Check from where both units will be this far ahead (cast time plus latency), 0 = now
+ */
+bool HasLineOfSight(WowUnit* unit1, WowUnit* unit2, LosPolicy policy = LosPolicy::Full, int leadMs = 0);
+
+/**
+ * Line of sight for candidate scans that never traces in the caller: the cached or last known answer,
+ * with a check queued on LosScheduler for the coming frames when there is no current one
+ * @param unknownResult Returned while a unit has no answer yet
+ */
+bool HasLineOfSightDeferred(WowUnit* unit1, WowUnit* unit2, LosPolicy policy = LosPolicy::Fast, bool unknownResult = false);
 
 } 
\ No newline at end of file
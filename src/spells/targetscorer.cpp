@@ -0,0 +1,186 @@
+#include "targetscorer.h"
+#include "auras.h"
+#include "../types/wowunit.h"
+#include "../types/wowplayer.h"
+#include <algorithm>
+
+namespace Spells {
+
+namespace {
+
+// Health samples closer together than this are merged (ObjectManager refreshes units every few hundred ms)
+constexpr auto TTD_MIN_SAMPLE_INTERVAL = std::chrono::milliseconds(250);
+// Weight of the newest damage rate in the smoothed rate
+constexpr float TTD_SMOOTHING = 0.3f;
+// Health histories of units not seen for this long are dropped
+constexpr auto HISTORY_TTL = std::chrono::seconds(10);
+
+// Min-heap on score: the front is the weakest kept candidate
+bool HeapCompare(const ScoredTarget& a, const ScoredTarget& b) {
+    return a.score > b.score;
+}
+
+float Clamp01(float value) {
+    return (std::max)(0.0f, (std::min)(1.0f, value));
+}
+
+} // namespace
+
+TargetWeights TargetWeights::Nearest() {
+    return TargetWeights();
+}
+
+TargetWeights TargetWeights::Enemy() {
+    TargetWeights weights;
+    weights.currentTarget = 3.0f;
+    weights.raidMarker = 2.5f;
+    weights.targetingMe = 1.5f;
+    weights.casting = 1.0f;
+    weights.inCombat = 0.75f;
+    weights.dyingSoon = 0.75f;
+    weights.lowHealth = 0.5f;
+    weights.proximity = 1.0f;
+    return weights;
+}
+
+TargetWeights TargetWeights::Friendly() {
+    TargetWeights weights;
+    weights.lowHealth = 3.0f;
+    weights.dyingSoon = 1.5f;
+    weights.proximity = 0.5f;
+    return weights;
+}
+
+float TargetScorer::Score(const TargetFeatures& features, const TargetWeights& weights) {
+    return weights.proximity * features.proximity +
+           weights.lowHealth * features.lowHealth +
+           weights.targetingMe * features.targetingMe +
+           weights.inCombat * features.inCombat +
+           weights.casting * features.casting +
+           weights.raidMarker * features.raidMarker +
+           weights.dyingSoon * features.dyingSoon +
+           weights.currentTarget * features.currentTarget +
+           features.auras;
+}
+
+float TargetScorer::UpdateTimeToDie(uint64_t guid, int health, Clock::time_point now) {
+    HealthHistory& history = m_health[guid];
+    history.lastSeen = now;
+    if (history.lastSample == Clock::time_point{}) {
+        history.lastHealth = health;
+        history.lastSample = now;
+        return -1.0f;
+    }
+
+    auto elapsed = now - history.lastSample;
+    if (elapsed >= TTD_MIN_SAMPLE_INTERVAL) {
+        float seconds = std::chrono::duration<float>(elapsed).count();
+        float rate = static_cast<float>(history.lastHealth - health) / seconds; // Negative while healed
+        history.damagePerSecond = history.damagePerSecond * (1.0f - TTD_SMOOTHING) + rate * TTD_SMOOTHING;
+        history.lastHealth = health;
+        history.lastSample = now;
+    }
+    if (history.damagePerSecond <= 1.0f) return -1.0f;
+    return static_cast<float>(health) / history.damagePerSecond;
+}
+
+void TargetScorer::SelectTopK(WowPlayer& player, const std::vector<std::shared_ptr<WowObject>>& units, const TargetWeights& weights,
+                              const Filter& filter, size_t k, std::vector<ScoredTarget>& out) {
+    k = (std::max)(static_cast<size_t>(1), (std::min)(k, MAX_K));
+    out.clear();
+    out.reserve(k);
+
+    auto now = Clock::now();
+    uint64_t playerGuid = player.GetGUID64();
+    uint64_t playerTargetGuid = player.GetTargetGUID().ToUint64();
+    Vector3 playerPos = player.GetPosition();
+    float maxRange = weights.maxRange > 0.0f ? weights.maxRange : 1.0f;
+    float ttdHorizon = weights.ttdHorizon > 0.0f ? weights.ttdHorizon : 1.0f;
+    bool wantsMarkers = weights.raidMarker != 0.0f;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.passes++;
+    for (const auto& object : units) {
+        auto unit = std::dynamic_pointer_cast<WowUnit>(object);
+        if (!unit) continue;
+        m_stats.unitsSeen++;
+        if (filter && !filter(*unit)) continue;
+
+        Vector3 position = unit->GetPosition();
+        if (position.IsZero()) continue;
+        float distance = playerPos.Distance(position);
+        if (distance > maxRange) continue;
+        m_stats.candidatesScored++;
+
+        uint64_t guid = unit->GetGUID64();
+        int health = unit->GetHealth();
+        int maxHealth = unit->GetMaxHealth();
+
+        ScoredTarget candidate;
+        TargetFeatures& features = candidate.features;
+        features.distance = distance;
+        features.proximity = Clamp01(1.0f - distance / maxRange);
+        features.lowHealth = maxHealth > 0 ? Clamp01(1.0f - static_cast<float>(health) / static_cast<float>(maxHealth)) : 0.0f;
+        features.targetingMe = unit->GetTargetGUID().ToUint64() == playerGuid ? 1.0f : 0.0f;
+        features.inCombat = unit->IsInCombat() ? 1.0f : 0.0f;
+        features.casting = (unit->IsCasting() || unit->IsChanneling()) ? 1.0f : 0.0f;
+        features.currentTarget = guid == playerTargetGuid ? 1.0f : 0.0f;
+        if (wantsMarkers && m_raidMarkers) features.raidMarker = Clamp01(m_raidMarkers(guid));
+        for (const auto& aura : weights.auras) {
+            if (UnitHasAura(unit.get(), aura.first)) features.auras += aura.second;
+        }
+        features.timeToDie = UpdateTimeToDie(guid, health, now);
+        if (features.timeToDie >= 0.0f) features.dyingSoon = Clamp01(1.0f - features.timeToDie / ttdHorizon);
+
+        candidate.score = Score(features, weights);
+        if (out.size() < k) {
+            candidate.unit = std::move(unit);
+            out.push_back(std::move(candidate));
+            std::push_heap(out.begin(), out.end(), HeapCompare);
+        } else if (candidate.score > out.front().score) {
+            std::pop_heap(out.begin(), out.end(), HeapCompare);
+            candidate.unit = std::move(unit);
+            out.back() = std::move(candidate);
+            std::push_heap(out.begin(), out.end(), HeapCompare);
+        }
+    }
+    std::sort_heap(out.begin(), out.end(), HeapCompare); // Highest score first
+
+    if (now - m_lastPrune > HISTORY_TTL) {
+        m_lastPrune = now;
+        for (auto it = m_health.begin(); it != m_health.end();) {
+            if (now - it->second.lastSeen > HISTORY_TTL) it = m_health.erase(it);
+            else ++it;
+        }
+    }
+}
+
+std::shared_ptr<WowUnit> TargetScorer::SelectBest(WowPlayer& player, const std::vector<std::shared_ptr<WowObject>>& units,
+                                                  const TargetWeights& weights, const Filter& filter, const Validator& validate,
+                                                  size_t k, std::vector<ScoredTarget>* outScored) {
+    std::vector<ScoredTarget> local;
+    std::vector<ScoredTarget>& scored = outScored ? *outScored : local;
+    SelectTopK(player, units, weights, filter, k, scored);
+
+    for (const auto& candidate : scored) {
+        if (!validate) return candidate.unit;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.validations++;
+        }
+        if (validate(*candidate.unit)) return candidate.unit;
+    }
+    return nullptr;
+}
+
+void TargetScorer::SetRaidMarkerProvider(RaidMarkerProvider provider) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_raidMarkers = std::move(provider);
+}
+
+TargetScorer::Stats TargetScorer::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace Spells
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class WowObject;
+class WowUnit;
+class WowPlayer;
+
+namespace Spells {
+
+// Per-candidate inputs of the score, each normalized to 0..1 (auras: sum of the matching weights)
+struct TargetFeatures {
+    float proximity = 0.0f;     // 1 at the player, 0 at maxRange
+    float lowHealth = 0.0f;     // 1 - health fraction
+    float targetingMe = 0.0f;   // Unit is targeting the player (has aggro on us)
+    float inCombat = 0.0f;
+    float casting = 0.0f;       // Casting or channeling (interrupt / kill priority)
+    float raidMarker = 0.0f;    // From the raid marker provider (e.g. skull = 1)
+    float auras = 0.0f;         // Sum of TargetWeights::auras present on the unit
+    float dyingSoon = 0.0f;     // 1 - time to die / ttdHorizon, 0 while unknown
+    float currentTarget = 0.0f; // Already the player's target (keeps the choice stable)
+    float distance = 0.0f;      // Yards (informational)
+    float timeToDie = -1.0f;    // Seconds, -1 = unknown (informational)
+};
+
+// Weight of each feature in the score. Negative weights penalize.
+struct TargetWeights {
+    float proximity = 1.0f;
+    float lowHealth = 0.0f;
+    float targetingMe = 0.0f;
+    float inCombat = 0.0f;
+    float casting = 0.0f;
+    float raidMarker = 0.0f;
+    float dyingSoon = 0.0f;
+    float currentTarget = 0.0f;
+    std::vector<std::pair<uint32_t, float>> auras; // (aura spell ID, weight)
+
+    float maxRange = 40.0f;
+    float ttdHorizon = 30.0f; // Seconds
+
+    // Nearest unit only (the old behaviour)
+    static TargetWeights Nearest();
+    // Current target, skull, units on us, casters, then low health and nearness
+    static TargetWeights Enemy();
+    // Lowest health first, then nearness
+    static TargetWeights Friendly();
+};
+
+struct ScoredTarget {
+    std::shared_ptr<WowUnit> unit;
+    float score = 0.0f;
+    TargetFeatures features;
+};
+
+/**
+ * Weighted target scoring with top-K selection.
+ * One pass over the unit table applies the caller's cheap filter, computes the features of each
+ * remaining unit and keeps the K best scores in a fixed-size min-heap. Expensive checks (line of sight,
+ * spell range) then run on those K only, best first, so their cost no longer grows with the number of
+ * visible units.
+ * Time to die is estimated from each unit's health over successive passes.
+ */
+class TargetScorer {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Filter = std::function<bool(WowUnit& unit)>;
+    using Validator = std::function<bool(WowUnit& unit)>;
+    using RaidMarkerProvider = std::function<float(uint64_t guid)>;
+
+    static constexpr size_t DEFAULT_K = 5;
+    static constexpr size_t MAX_K = 16;
+
+    struct Stats {
+        uint64_t passes = 0;
+        uint64_t unitsSeen = 0;
+        uint64_t candidatesScored = 0; // Passed the filter
+        uint64_t validations = 0;      // Validator calls
+    };
+
+    /**
+     * Score every unit passing the filter and keep the best
+     * @param player Local player
+     * @param units Unit table (e.g. ObjectManager::GetObjectsByType(OBJECT_UNIT))
+     * @param weights Feature weights
+     * @param filter Cheap predicate (dead, reaction, blacklist...); may be empty
+     * @param k Candidates to keep (capped at MAX_K)
+     * @param out Best candidates, highest score first
+     */
+    void SelectTopK(WowPlayer& player, const std::vector<std::shared_ptr<WowObject>>& units, const TargetWeights& weights,
+                    const Filter& filter, size_t k, std::vector<ScoredTarget>& out);
+
+    /**
+     * SelectTopK, then the first of the K that passes the validator
+     * @param validate Expensive check (may be empty)
+     * @param outScored Optional: the scored candidates
+     * @return Best valid unit, or nullptr
+     */
+    std::shared_ptr<WowUnit> SelectBest(WowPlayer& player, const std::vector<std::shared_ptr<WowObject>>& units,
+                                        const TargetWeights& weights, const Filter& filter, const Validator& validate,
+                                        size_t k = DEFAULT_K, std::vector<ScoredTarget>* outScored = nullptr);
+
+    // Raid marker lookup (no marker data is read from the client here)
+    void SetRaidMarkerProvider(RaidMarkerProvider provider);
+
+    static float Score(const TargetFeatures& features, const TargetWeights& weights);
+
+    Stats GetStats() const;
+
+private:
+    struct HealthHistory {
+        int lastHealth = 0;
+        Clock::time_point lastSample;
+        Clock::time_point lastSeen;
+        float damagePerSecond = 0.0f; // Smoothed health lost per second
+    };
+
+    // Time to die in seconds from the health trend, -1 if unknown. Caller holds m_mutex.
+    float UpdateTimeToDie(uint64_t guid, int health, Clock::time_point now);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, HealthHistory> m_health;
+    Clock::time_point m_lastPrune;
+    RaidMarkerProvider m_raidMarkers;
+    Stats m_stats;
+};
+
+} // namespace Spells
@@ -25,6 +25,17 @@ NLOHMANN_JSON_SERIALIZE_ENUM(AuraConditionLogic, {
     {AuraConditionLogic::ALL_OF, "ALL_OF"}
 })
 
+// Unit an aura condition reads, from RotationCreator's "auraTarget" (DEFAULT when the file has none).
+// RotationCreator writes "Player" for every aura condition unless changed, so only PLAYER_* types
+// are redirected by it: any other unit there reads the step target instead of the player.
+enum class AuraUnit : uint8_t {
+    DEFAULT,
+    PLAYER,
+    TARGET,
+    FOCUS,
+    FRIENDLY
+};
+
 // Condition structure for rotation steps
 // Defined *before* RotationStep
 struct Condition {
@@ -58,6 +69,7 @@ struct Condition {
     AuraConditionLogic multiAuraLogic = AuraConditionLogic::ANY_OF; // NEW: Logic for multiAuraIds
     uint64_t casterGuid = 0; // Optional: Check for aura applied by specific caster
     int minStacks = 0;      // Min stacks required (applies to single spellId or multiAuraIds based on logic)
+    AuraUnit auraTarget = AuraUnit::DEFAULT; // See AuraUnit
     // Note: Presence/Absence is determined by Condition::Type (e.g., PLAYER_HAS_AURA vs PLAYER_MISSING_AURA)
 
     // For HEALTH/RESOURCE checks:
@@ -118,7 +130,9 @@ enum class TargetType {
     PET,        // Target is the player's pet (if implemented)
     SELF_OR_FRIENDLY, // ADDED BACK
     ANY,              // ADDED BACK
-    NONE        // No specific target needed for the spell logic (e.g. AoE around self)
+    NONE,       // No specific target needed for the spell logic (e.g. AoE around self)
+    ENEMY_CLUSTER,  // Hostile unit with the most hostiles within aoeRadius (cleave, chain spells)
+    GROUND_CLUSTER  // Ground position covering the most hostiles within aoeRadius
 };
 
 // Now define RotationStep, which uses Condition and TargetType
@@ -146,10 +160,29 @@ struct RotationStep {
     // Cache for calculated priority during a rotation cycle
     mutable int calculatedPriority = 0;
 
-    float castableWhileMoving = false; 
+    bool castableWhileMoving = false; 
+
+    // ENEMY_CLUSTER / GROUND_CLUSTER: the step only passes if the best cluster has aoeMinCount units
+    float aoeRadius = 8.0f;
+    int aoeMinCount = 3;
 };
 
 
+/**
+ * Map a step's resourceType string to a PowerType index
+ * @param resourceType "Mana", "Rage", "Focus", "Energy" or "RunicPower"/"Runic Power"
+ * @return PowerType value, or -1 for "None" and unknown names
+ */
+inline int PowerTypeFromResource(const std::string& resourceType) {
+    if (resourceType == "Mana") return PowerType::POWER_TYPE_MANA;
+    if (resourceType == "Rage") return PowerType::POWER_TYPE_RAGE;
+    if (resourceType == "Focus") return PowerType::POWER_TYPE_FOCUS;
+    if (resourceType == "Energy") return PowerType::POWER_TYPE_ENERGY;
+    if (resourceType == "RunicPower" || resourceType == "Runic Power") return PowerType::POWER_TYPE_RUNIC_POWER;
+    return -1;
+}
+
+
 struct RotationProfile {
     std::string name;
     std::string filePath; 
@@ -47,8 +47,10 @@ namespace Offsets {
     // Power Type: WoWBot uses fallback: descriptorPtr + 0x47. Let's define that.
     constexpr uintptr_t DESCRIPTOR_FIELD_POWTYPE = 0x47;   // Byte offset relative to Descriptor base
     constexpr uintptr_t UNIT_FIELD_FLAGS = 0x3B * 4;       // From WoWBot
-    // ADDED: Faction offset (placeholder, check common 3.3.5 layouts if needed)
-    constexpr uintptr_t UNIT_FIELD_FACTION_TEMPLATE = 0x30 * 4;
+    constexpr uintptr_t UNIT_FIELD_FACTION_TEMPLATE = 0x37 * 4; // Between LEVEL (0x36) and BYTES_0 (0x38)
+    constexpr uintptr_t UNIT_FIELD_CHARMEDBY = 0x0C * 4;   // GUID of the charming unit (mind control, possessed pets)
+    constexpr uintptr_t UNIT_FIELD_SUMMONEDBY = 0x0E * 4;  // GUID of the summoner (pets, guardians)
+    constexpr uintptr_t UNIT_DYNAMIC_FLAGS = 0x8F * 4;     // Tapped, lootable, ...
 
     // VFTable indices (based on WoWBot)
     constexpr int VF_GetName = 54;
@@ -56,7 +58,7 @@ namespace Offsets {
     // Descriptor field offsets (relative to descriptor base)
     constexpr uintptr_t OBJECT_FIELD_GUID = 0x00;     // Low/High GUID at 0x00/0x04
     constexpr uintptr_t OBJECT_FIELD_TYPE = 0x0C * 4; // 4 bytes per field, index * 4 = actual offset
-    constexpr uintptr_t OBJECT_FIELD_ENTRY = 0x01 * 4;// From WoWBot
+    constexpr uintptr_t OBJECT_FIELD_ENTRY = 0x03 * 4;// After GUID (2 fields) and type; creature/gameobject template ID
     constexpr uintptr_t OBJECT_FIELD_SCALE_X = 0x04 * 4; // Scale field offset (0x10)
 
 } // namespace Offsets
@@ -94,6 +94,8 @@ void WowUnit::ResetCache() {
         m_cachedCastingSpellId = 0;
         m_cachedChannelSpellId = 0;
         m_cachedFactionId = 0;
+        m_cachedEntry = 0;
+        m_cachedOwnerGUID = WGUID();
         m_cachedCastingEndTimeMs = 0;
         m_cachedChannelEndTimeMs = 0;
         m_cachedMovementFlags = 0; // RE-ADDED reset
@@ -136,6 +138,8 @@ void WowUnit::UpdateDynamicData() {
         m_cachedCastingSpellId = 0;
         m_cachedChannelSpellId = 0;
         m_cachedFactionId = 0;
+        m_cachedEntry = 0;
+        m_cachedOwnerGUID = WGUID();
         m_cachedCastingEndTimeMs = 0;
         m_cachedChannelEndTimeMs = 0;
         m_cachedMovementFlags = 0; // RE-ADDED reset
@@ -310,9 +314,13 @@ void WowUnit::UpdateDynamicData() {
             m_cachedUnitFlags = Memory::Read<uint32_t>(descriptorPtr + Offsets::UNIT_FIELD_FLAGS);
             // Keep new flags commented out
             // m_cachedUnitFlags2 = Memory::Read<uint32_t>(descriptorPtr + UNIT_FIELD_FLAGS_2);
-            // m_cachedDynamicFlags = Memory::Read<uint32_t>(descriptorPtr + UNIT_DYNAMIC_FLAGS);
+            m_cachedDynamicFlags = Memory::Read<uint32_t>(descriptorPtr + Offsets::UNIT_DYNAMIC_FLAGS);
             // Read Faction using the added offset
             m_cachedFactionId = Memory::Read<uint32_t>(descriptorPtr + Offsets::UNIT_FIELD_FACTION_TEMPLATE);
+            m_cachedEntry = Memory::Read<uint32_t>(descriptorPtr + Offsets::OBJECT_FIELD_ENTRY);
+            uint64_t ownerGuid64 = Memory::Read<uint64_t>(descriptorPtr + Offsets::UNIT_FIELD_SUMMONEDBY);
+            if (ownerGuid64 == 0) ownerGuid64 = Memory::Read<uint64_t>(descriptorPtr + Offsets::UNIT_FIELD_CHARMEDBY);
+            m_cachedOwnerGUID = WGUID(ownerGuid64);
 
              // --- Restore Casting/Channeling Spell ID Reads from Backup --- 
              // (Reading from object base, like backup)
@@ -36,7 +36,9 @@ protected:
     uint32_t m_cachedChannelEndTimeMs = 0;
     WGUID m_cachedTargetGUID;
     uint32_t m_cachedFactionId; // Renamed/Corrected from m_cachedFaction
+    uint32_t m_cachedEntry = 0; // Creature template ID (0 for players)
     uint32_t m_cachedMovementFlags = 0; // RE-ADDED for movement check
+    WGUID m_cachedOwnerGUID; // Summoner, else charmer (invalid if the unit has no owner)
     float m_cachedScale;
     float m_cachedFacing; // Renamed from m_cachedRotation
 
@@ -59,6 +61,9 @@ public:
     // Define constants for unit flags
     static const uint32_t UNIT_FLAG_IN_COMBAT = 0x00080000; // Corrected to standard AffectingCombat flag
     static const uint32_t UNIT_FLAG_FLEEING = 0x00800000; // Corrected to the specific fleeing bit
+    static const uint32_t UNIT_FLAG_PVP = 0x00001000;     // Flagged for PvP
+    static const uint32_t UNIT_DYNFLAG_TAPPED = 0x4;            // Tapped by someone
+    static const uint32_t UNIT_DYNFLAG_TAPPED_BY_PLAYER = 0x8;  // ... by the local player (or their group)
 
     // Constructor matching ObjectManager usage
     WowUnit(uintptr_t baseAddress, WGUID guid);
@@ -87,7 +92,9 @@ public:
     // m_cachedCastingEndTimeMs and m_cachedChannelEndTimeMs are used by IsCasting/IsChanneling, no direct public getters usually needed
     WGUID GetTargetGUID() const { return m_cachedTargetGUID; }
     uint32_t GetFactionId() const { return m_cachedFactionId; }
+    uint32_t GetEntry() const { return m_cachedEntry; }
     uint32_t GetMovementFlags() const { return m_cachedMovementFlags; } // RE-ADDED getter for raw flags
+    WGUID GetOwnerGUID() const { return m_cachedOwnerGUID; }
     
     // Get the scale of the unit (default to 1.0 if not available)
     float GetScale() const { return m_cachedScale; }
@@ -112,6 +119,8 @@ public:
     bool IsDead() const { return m_cachedHealth <= 0; } // Simple check based on cached health
     bool IsInCombat() const; // Definition in .cpp, uses m_cachedUnitFlags & UNIT_FLAG_IN_COMBAT
     bool IsFleeing() const { return HasFlag(UNIT_FLAG_FLEEING); } // Check if unit is fleeing
+    bool IsTappedByOther() const { return (m_cachedDynamicFlags & (UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER)) == UNIT_DYNFLAG_TAPPED; }
+    bool IsPet() const { return m_cachedOwnerGUID.IsValid(); } // Summoned or charmed by another unit
     bool IsFacingUnit(const WowUnit* targetUnit, float coneAngleDegrees) const;
     std::string GetPowerTypeString() const; // Helper to convert type byte to string
     std::string GetPowerTypeString(uint8_t powerType) const; // New overload for specific power type
@@ -0,0 +1,104 @@
+// Decisions per second of the compiled rotation VM (RotationVM::FindFirstCastableStep).
+// Usage: rotation_bench [iterations] [snapshots.json]
+// Without a snapshot file, a 20-step synthetic profile is run against a synthetic snapshot where only the
+// last step passes (every step's checks run). With one (written by Rotation::SaveSnapshots), the synthetic
+// profile is evaluated over the recorded snapshots, round-robin.
+
+#include "rotations/RotationCompiler.h"
+#include "rotations/WorldSnapshot.h"
+#include "types/Rotation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr int STEP_COUNT = 20;
+constexpr uint32_t FIRST_SPELL = 1000;
+constexpr uint32_t MISSING_AURA = 50000; // On nobody
+constexpr uint32_t PRESENT_AURA = 50001; // On the player and the target
+
+Rotation::Condition MakeCondition(Rotation::Condition::Type type, uint32_t spellId, float value = 0.0f) {
+    Rotation::Condition condition;
+    condition.type = type;
+    condition.spellId = spellId;
+    condition.value = value;
+    return condition;
+}
+
+// Each step: a buff check, a debuff check and a health threshold. Steps before the last fail on their
+// final condition so the evaluator cannot short-circuit early.
+Rotation::RotationProfile MakeProfile() {
+    using Type = Rotation::Condition::Type;
+    Rotation::RotationProfile profile;
+    profile.name = "Bench";
+    for (int i = 0; i < STEP_COUNT; ++i) {
+        Rotation::RotationStep step;
+        step.name = "Step " + std::to_string(i);
+        step.spellId = FIRST_SPELL + static_cast<uint32_t>(i);
+        step.resourceType = "Mana";
+        step.manaCost = 100;
+        step.conditions.push_back(MakeCondition(Type::PLAYER_HAS_AURA, PRESENT_AURA));
+        step.conditions.push_back(MakeCondition(Type::TARGET_MISSING_AURA, MISSING_AURA));
+        bool last = i == STEP_COUNT - 1;
+        step.conditions.push_back(MakeCondition(Type::HEALTH_PERCENT_BELOW, 0, last ? 100.0f : 10.0f));
+        profile.steps.push_back(step);
+    }
+    return profile;
+}
+
+Rotation::WorldSnapshot MakeSnapshot() {
+    Rotation::WorldSnapshot world;
+    world.timestampMs = 1;
+    world.player.guid = 1;
+    world.player.healthPercent = 100.0f;
+    world.player.power[PowerType::POWER_TYPE_MANA] = 5000;
+    world.player.maxPower[PowerType::POWER_TYPE_MANA] = 5000;
+    world.player.auras.push_back({ PRESENT_AURA, 1, 1 });
+    world.hasTarget = true;
+    world.target.guid = 2;
+    world.target.isHostile = true;
+    world.target.healthPercent = 60.0f;
+    world.target.auras.push_back({ PRESENT_AURA, 1, 1 });
+    for (int i = 0; i < STEP_COUNT; ++i) {
+        world.spells.push_back({ FIRST_SPELL + static_cast<uint32_t>(i), 0, 1 });
+    }
+    world.SortForLookup();
+    return world;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 1000000;
+    if (iterations <= 0) iterations = 1000000;
+
+    std::vector<Rotation::WorldSnapshot> snapshots;
+    if (argc > 2) {
+        if (!Rotation::LoadSnapshots(argv[2], snapshots) || snapshots.empty()) {
+            std::printf("Could not load snapshots from %s\n", argv[2]);
+            return 1;
+        }
+    } else {
+        snapshots.push_back(MakeSnapshot());
+    }
+
+    auto program = Rotation::RotationCompiler::Compile(MakeProfile());
+    Rotation::RotationVM::ResetStats();
+
+    int lastFound = -1;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        lastFound = Rotation::RotationVM::FindFirstCastableStep(*program, snapshots[static_cast<size_t>(i) % snapshots.size()]);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Rotation::RotationVM::Stats stats = Rotation::RotationVM::GetStats();
+    std::printf("%ld decisions over %zu snapshot(s) in %.3f s: %.0f decisions/s, %.1f ns/decision\n",
+                iterations, snapshots.size(), seconds, iterations / seconds, 1e9 * seconds / iterations);
+    std::printf("%.1f instructions/decision, memo hits %llu / misses %llu, last step found: %d\n",
+                stats.decisions ? static_cast<double>(stats.instructions) / stats.decisions : 0.0,
+                static_cast<unsigned long long>(stats.memoHits), static_cast<unsigned long long>(stats.memoMisses), lastFound);
+    return 0;
+}
@@ -0,0 +1,263 @@
+// Runs a profile through ProfileLoader, RotationWorker and ProfileWatcher on synthetic snapshots:
+// single-target and multi-target decisions, lookahead during the GCD and a hot reload of the file.
+// Also installs a profile into a CooldownManager fed with scripted client reads (resource readiness), and
+// re-sorts a step's conditions from recorded cost samples.
+// Usage: rotation_worker_test <scratch directory>
+
+#include "rotations/ConditionCost.h"
+#include "rotations/DecisionTrace.h"
+#include "rotations/ProfileLoader.h"
+#include "rotations/ProfileWatcher.h"
+#include "rotations/RotationWorker.h"
+#include "spells/cooldowns.h"
+#include "spells/SpellManager.h"
+#include "types/Rotation.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+// Client reads of CooldownManager::Update: every spell is off cooldown, the player's mana is g_mana
+namespace {
+int g_mana = 0;
+}
+
+int SpellManager::GetSpellCooldownMs(int) { return 0; }
+
+namespace Spells {
+void CooldownManager::ReadPlayerState(FrameReads& reads) {
+    reads.hasWorld = true;
+    reads.powers.emplace_back(static_cast<uint8_t>(PowerType::POWER_TYPE_MANA), g_mana);
+}
+}
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(expr)                                                         \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+            ++g_failures;                                                   \
+        }                                                                   \
+    } while (0)
+
+constexpr uint32_t DOT_SPELL = 100;
+constexpr uint32_t FILLER_SPELL = 200;
+constexpr uint32_t COSTLY_SPELL = 300;
+constexpr uint64_t PLAYER_GUID = 1;
+constexpr uint64_t TARGET_GUID = 2;
+constexpr uint64_t OTHER_GUID = 3;
+
+// "DoT" (only on a target without it) and "Filler", in the given order
+void WriteProfile(const std::string& path, bool dotFirst) {
+    std::string dot = R"({"id":100,"name":"DoT","resourceType":"None","conditions":[{"type":"TARGET_MISSING_AURA","spellId":100}]})";
+    std::string filler = R"({"id":200,"name":"Filler","resourceType":"None"})";
+    std::ofstream file(path, std::ios::trunc);
+    file << R"({"name":"WorkerTest","steps":[)" << (dotFirst ? dot + "," + filler : filler + "," + dot) << "]}";
+}
+
+// Current target already has the DoT, a second hostile nearby does not
+std::shared_ptr<Rotation::WorldSnapshot> MakeSnapshot(uint64_t timestampMs, uint32_t gcdMs) {
+    auto world = std::make_shared<Rotation::WorldSnapshot>();
+    world->timestampMs = timestampMs;
+    world->actionableInMs = gcdMs;
+    world->player.guid = PLAYER_GUID;
+    world->player.healthPercent = 100.0f;
+    world->hasTarget = true;
+    world->target.guid = TARGET_GUID;
+    world->target.isHostile = true;
+    world->target.inCombat = true;
+    world->target.healthPercent = 100.0f;
+    world->target.auras.push_back({ DOT_SPELL, PLAYER_GUID, 1 });
+
+    Rotation::UnitSnapshot other;
+    other.guid = OTHER_GUID;
+    other.isHostile = true;
+    other.inCombat = true;
+    other.healthPercent = 50.0f;
+    other.position = Vector3(3.0f, 0.0f, 0.0f);
+    world->nearbyUnits.push_back(world->target);
+    world->nearbyUnits.push_back(other);
+
+    world->spells.push_back({ DOT_SPELL, static_cast<int>(gcdMs), 1 });
+    world->spells.push_back({ FILLER_SPELL, static_cast<int>(gcdMs), 1 });
+    world->SortForLookup();
+    return world;
+}
+
+template <typename Predicate>
+bool WaitFor(Predicate done, int timeoutMs = 2000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+bool NextDecision(Rotation::RotationWorker& worker, Rotation::RotationDecision& out) {
+    return WaitFor([&] { return worker.TakeDecision(out); });
+}
+
+// Code index of the first instruction with this opcode in a step, or UINT32_MAX
+uint32_t FindOp(const Rotation::RotationProgram& program, size_t stepIndex, Rotation::OpCode op) {
+    const Rotation::CompiledStep& step = program.steps[stepIndex];
+    for (uint32_t pc = step.codeOffset; pc < step.codeEnd; pc += Rotation::InstructionLength(program.code.data(), pc)) {
+        if (Rotation::HeaderOp(program.code[pc]) == op) return pc;
+    }
+    return UINT32_MAX;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    fs::path dir = argc > 1 ? fs::path(argv[1]) : fs::temp_directory_path() / "rotation_worker_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string profilePath = (dir / "worker_test.json").string();
+    WriteProfile(profilePath, true);
+
+    Rotation::ProfileLoader& loader = Rotation::ProfileLoader::GetInstance();
+    loader.LoadDirectory(dir.string());
+    auto profile = loader.FindProfile("WorkerTest");
+    CHECK(profile != nullptr);
+    if (!profile) return 1;
+
+    Rotation::RotationWorker worker;
+    worker.SetDecisionRate(Rotation::RotationWorker::MAX_DECISION_HZ);
+    worker.SetLookaheadEnabled(true);
+    worker.Start();
+    auto installed = worker.InstallProfile(*profile);
+    CHECK(worker.GetProgram() == installed);
+    CHECK(Rotation::RotationWorker::OwnsDecisions()); // The engine skips its own evaluation
+
+    // Single target: the target has the DoT, so the filler goes on it
+    Rotation::RotationDecision decision;
+    worker.PublishSnapshot(MakeSnapshot(1000, 0));
+    CHECK(NextDecision(worker, decision));
+    CHECK(decision.spellId == FILLER_SPELL);
+    CHECK(decision.targetGuid == TARGET_GUID);
+    CHECK(!decision.speculative);
+
+    // Multi-target: the DoT goes on the nearby hostile that is missing it
+    worker.SetMultiTargetEnabled(true);
+    worker.PublishSnapshot(MakeSnapshot(2000, 0));
+    CHECK(NextDecision(worker, decision));
+    CHECK(decision.spellId == DOT_SPELL);
+    CHECK(decision.targetGuid == OTHER_GUID);
+
+    // Lookahead: decided during a 1 s GCD for the moment it ends, held back until then
+    worker.PublishSnapshot(MakeSnapshot(3000, 1000));
+    Rotation::RotationDecision due;
+    CHECK(!WaitFor([&] { return worker.PollDecision(3999, due); }, 200));
+    CHECK(worker.PollDecision(4000, due));
+    CHECK(due.speculative);
+    CHECK(due.readyAtMs == 4000);
+    CHECK(due.spellId == DOT_SPELL);
+    CHECK(due.targetGuid == OTHER_GUID);
+    worker.SetMultiTargetEnabled(false);
+
+    // Hot reload: reordering the file on disk swaps the running program
+    Rotation::ProfileWatcher watcher(worker);
+    watcher.SetPollInterval(Rotation::ProfileWatcher::MIN_POLL_MS);
+    watcher.Start(dir.string());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    WriteProfile(profilePath, false);
+    CHECK(WaitFor([&] { return worker.GetProgram() != installed; }, 5000));
+    CHECK(watcher.GetStats().programSwaps == 1);
+    auto swapped = worker.GetProgram();
+    CHECK(swapped && !swapped->steps.empty() && swapped->steps[0].spellId == FILLER_SPELL);
+
+    worker.PublishSnapshot(MakeSnapshot(5000, 0));
+    CHECK(NextDecision(worker, decision));
+    CHECK(decision.spellId == FILLER_SPELL);
+
+    watcher.Stop();
+    worker.Stop();
+    worker.SetProgram(nullptr);
+    CHECK(!Rotation::RotationWorker::OwnsDecisions()); // Engine decides again
+
+    // Readiness: a 500 mana spell at 100 mana, regenerating 1000/s, is ready in about 400 ms.
+    // Installing a profile must leave its costs in the timeline.
+    Rotation::RotationProfile costly;
+    costly.name = "CostTest";
+    Rotation::RotationStep expensive;
+    expensive.name = "Expensive";
+    expensive.spellId = COSTLY_SPELL;
+    expensive.resourceType = "Mana";
+    expensive.manaCost = 500;
+    costly.steps.push_back(expensive);
+
+    Spells::CooldownManager cooldowns;
+    Rotation::RotationWorker costWorker;
+    costWorker.SetCooldownManager(&cooldowns);
+    costWorker.InstallProfile(costly);
+    g_mana = 0;
+    cooldowns.Update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    g_mana = 100;
+    cooldowns.Update();
+    auto readyAt = cooldowns.NextReadyTime();
+    CHECK(readyAt != std::chrono::steady_clock::time_point{});
+    CHECK(readyAt > std::chrono::steady_clock::now());
+
+    // Condition order: the cheap health check compiles first; once samples show it always passes and the
+    // unit count always fails, a re-sort puts the unit count first
+    Rotation::RotationProfile sorted;
+    sorted.name = "SortTest";
+    Rotation::RotationStep guarded;
+    guarded.name = "Guarded";
+    guarded.requiresTarget = false;
+    guarded.resourceType = "None";
+    Rotation::Condition lowHealth;
+    lowHealth.type = Rotation::Condition::Type::HEALTH_PERCENT_BELOW;
+    lowHealth.targetIsPlayer = true;
+    lowHealth.value = 50.0f;
+    Rotation::Condition crowded;
+    crowded.type = Rotation::Condition::Type::MELEE_UNITS_AROUND_PLAYER_GREATER_THAN;
+    crowded.range = 5.0f;
+    crowded.value = 2.0f;
+    guarded.conditions = { lowHealth, crowded };
+    sorted.steps.push_back(guarded);
+
+    Rotation::RotationWorker sortWorker;
+    auto unsorted = sortWorker.InstallProfile(sorted);
+    uint32_t healthPc = FindOp(*unsorted, 0, Rotation::OpCode::HEALTH_BELOW);
+    uint32_t unitsPc = FindOp(*unsorted, 0, Rotation::OpCode::UNITS_NEAR_GT);
+    CHECK(healthPc < unitsPc && unitsPc != UINT32_MAX);
+    CHECK(!sortWorker.ReorderConditions()); // No samples yet: same order
+
+    std::vector<Rotation::ConditionCostModel::Sample> samples;
+    uint64_t healthKey = Rotation::ConditionCostModel::ConditionKey(unsorted->code.data(), healthPc);
+    uint64_t unitsKey = Rotation::ConditionCostModel::ConditionKey(unsorted->code.data(), unitsPc);
+    for (uint64_t i = 0; i < Rotation::RotationWorker::REORDER_SAMPLES / 2; ++i) {
+        samples.push_back({ healthKey, Rotation::OpCode::HEALTH_BELOW, 20, true });
+        samples.push_back({ unitsKey, Rotation::OpCode::UNITS_NEAR_GT, 200, false });
+    }
+    Rotation::ConditionCostModel::GetInstance().Record(samples);
+    CHECK(sortWorker.ReorderConditions());
+    auto resorted = sortWorker.GetProgram();
+    CHECK(resorted != unsorted);
+    CHECK(FindOp(*resorted, 0, Rotation::OpCode::UNITS_NEAR_GT) < FindOp(*resorted, 0, Rotation::OpCode::HEALTH_BELOW));
+    CHECK(!sortWorker.ReorderConditions()); // Already in measured order
+
+    // Trace: a tick decodes only against the program it ran on, not the one it replaced
+    Rotation::DecisionTrace& trace = Rotation::DecisionTrace::GetInstance();
+    trace.SetEnabled(true);
+    Rotation::RotationDecision traced;
+    Rotation::RotationWorker::Decide(*resorted, *MakeSnapshot(6000, 0), false, traced);
+    std::vector<Rotation::TraceTick> ticks;
+    trace.CopyRecent(ticks, 1);
+    std::vector<Rotation::TraceCondition> conditions;
+    CHECK(ticks.size() == 1 && ticks[0].programId == resorted->id && ticks[0].stepCount > 0);
+    CHECK(!ticks.empty() && Rotation::DecisionTrace::DecodeStep(*resorted, ticks[0], 0, conditions));
+    CHECK(!ticks.empty() && !Rotation::DecisionTrace::DecodeStep(*unsorted, ticks[0], 0, conditions));
+    trace.SetEnabled(false);
+
+    if (g_failures == 0) std::printf("rotation_worker_test: all checks passed\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// Decodes synthetic Spell.dbc / SpellCastTimes.dbc / SpellRange.dbc files through Spells::SpellDbc.
+// Usage: spelldbc_test <scratch directory>
+
+#include "spells/spelldbc.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(expr)                                                         \
+    do {                                                                    \
+        if (!(expr)) {                                                      \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+            ++g_failures;                                                   \
+        }                                                                   \
+    } while (0)
+
+uint32_t FloatField(float value) {
+    uint32_t raw;
+    std::memcpy(&raw, &value, sizeof(raw));
+    return raw;
+}
+
+void WriteDbc(const std::string& path, uint32_t fieldCount, std::vector<std::vector<uint32_t>> records) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return;
+    uint32_t header[5];
+    std::memcpy(&header[0], "WDBC", 4);
+    header[1] = static_cast<uint32_t>(records.size());
+    header[2] = fieldCount;
+    header[3] = fieldCount * 4;
+    header[4] = 1; // String block: one empty string
+    std::fwrite(header, sizeof(uint32_t), 5, file);
+    for (auto& record : records) {
+        record.resize(fieldCount, 0);
+        std::fwrite(record.data(), sizeof(uint32_t), fieldCount, file);
+    }
+    char empty = 0;
+    std::fwrite(&empty, 1, 1, file);
+    std::fclose(file);
+}
+
+bool Near(float a, float b) {
+    return std::fabs(a - b) < 0.001f;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    fs::path dir = argc > 1 ? fs::path(argv[1]) : fs::temp_directory_path() / "spelldbc_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    Spells::SpellDbc missing;
+    CHECK(missing.Load(dir.string()) == Spells::SpellDbc::LoadResult::MISSING);
+    CHECK(!missing.IsMapped());
+
+    // id, base ms, per-level, minimum
+    WriteDbc((dir / "SpellCastTimes.dbc").string(), 4, { { 1, 0, 0, 0 }, { 5, 2500, 0, 2500 } });
+    // id, minHostile, minFriendly, maxHostile, maxFriendly
+    WriteDbc((dir / "SpellRange.dbc").string(), 5, { { 1, 0, 0, 0, 0 }, { 4, 0, 0, FloatField(30.0f), FloatField(40.0f) } });
+
+    const uint32_t fields = Spells::SpellDbc::SPELL_FIELD_COUNT;
+    std::vector<uint32_t> fireball(fields, 0), arcaneMissiles(fields, 0), instant(fields, 0);
+    fireball[0] = 133;
+    fireball[28] = 5;        // CastingTimeIndex -> 2500 ms
+    fireball[29] = 0;        // RecoveryTime
+    fireball[31] = 0x1;      // InterruptFlags: movement
+    fireball[41] = 0;        // PowerType: mana
+    fireball[42] = 120;      // ManaCost
+    fireball[46] = 4;        // RangeIndex -> 30/40 yd
+    fireball[206] = 1500;    // StartRecoveryTime (GCD)
+
+    arcaneMissiles[0] = 5143;
+    arcaneMissiles[5] = 0x4; // AttributesEx: channeled
+    arcaneMissiles[28] = 1;  // Instant cast index
+    arcaneMissiles[33] = 0x8; // ChannelInterruptFlags: movement
+    arcaneMissiles[46] = 4;
+
+    instant[0] = 2139;
+    instant[28] = 1;
+    instant[29] = 24000;     // 24 s cooldown
+    instant[31] = 0x1;       // Movement flag does not matter for instants
+    instant[41] = 1;         // Rage
+    instant[42] = 100;
+    WriteDbc((dir / "Spell.dbc").string(), fields, { fireball, arcaneMissiles, instant });
+
+    Spells::SpellDbc dbc;
+    CHECK(dbc.Load(dir.string()) == Spells::SpellDbc::LoadResult::OK);
+    CHECK(dbc.IsMapped());
+    CHECK(dbc.GetRecordCount() == 3);
+    CHECK(dbc.GetFieldCount() == fields);
+    CHECK(dbc.GetCastTimeCount() == 2);
+    CHECK(dbc.GetRangeCount() == 2);
+
+    std::vector<Spells::SpellInfo> found;
+    CHECK(dbc.FindRecords({ 133, 2139, 5143, 99999 }, found) == 3);
+    CHECK(found.size() == 3);
+    const Spells::SpellInfo* byId[3] = { nullptr, nullptr, nullptr };
+    for (const auto& info : found) {
+        if (info.id == 133) byId[0] = &info;
+        if (info.id == 5143) byId[1] = &info;
+        if (info.id == 2139) byId[2] = &info;
+    }
+    CHECK(byId[0] && byId[1] && byId[2]);
+    if (byId[0] && byId[1] && byId[2]) {
+        const Spells::SpellInfo& fb = *byId[0];
+        CHECK(fb.HasCastTime() && fb.castTimeMs == 2500);
+        CHECK(fb.HasRange() && Near(fb.maxRange, 30.0f) && Near(fb.maxRangeFriendly, 40.0f));
+        CHECK(!fb.IsChannel());
+        CHECK(!fb.IsCastableWhileMoving());
+        CHECK(fb.manaCost == 120 && fb.powerType == 0);
+        CHECK(fb.startRecoveryTimeMs == 1500);
+
+        const Spells::SpellInfo& am = *byId[1];
+        CHECK(am.IsChannel());
+        CHECK(!am.IsCastableWhileMoving());
+        CHECK(am.HasCastTime() && am.castTimeMs == 0);
+
+        const Spells::SpellInfo& kick = *byId[2];
+        CHECK(kick.IsCastableWhileMoving());
+        CHECK(kick.recoveryTimeMs == 24000);
+        CHECK(kick.powerType == 1 && kick.manaCost == 100);
+        CHECK(!kick.HasRange());
+    }
+
+    // Truncated Spell.dbc (declared records past the end of the file) is rejected
+    {
+        FILE* file = std::fopen((dir / "Spell.dbc").string().c_str(), "r+b");
+        uint32_t hugeCount = 1000;
+        if (file) {
+            std::fseek(file, 4, SEEK_SET);
+            std::fwrite(&hugeCount, sizeof(hugeCount), 1, file);
+            std::fclose(file);
+        }
+        Spells::SpellDbc truncated;
+        CHECK(truncated.Load(dir.string()) == Spells::SpellDbc::LoadResult::INVALID);
+        CHECK(!truncated.IsMapped());
+    }
+
+    fs::remove_all(dir);
+    if (g_failures == 0) std::printf("spelldbc_test: all checks passed\n");
+    return g_failures == 0 ? 0 : 1;
+}